@@ -36,6 +36,7 @@
 // controller
 uint8_t kb__init          (void);
 uint8_t kb__update_matrix (bool matrix[OPT__KB__ROWS][OPT__KB__COLUMNS]);
+void    kb__sleep         (void);
 
 // LED
 void kb__led__on  (uint8_t led);
@@ -117,6 +118,15 @@ void kb__layout__exec_key (bool pressed, uint8_t row, uint8_t column);
  * - failure: [other]
  */
 
+// === kb__sleep() ===
+/**                                             functions/kb__sleep/description
+ * Put the controller into a low power state until the next interrupt
+ *
+ * Notes:
+ * - Used by `main()` to idle between scans while the host is suspended.  Any
+ *   interrupt (including the timer's millisecond interrupt) must wake it up.
+ */
+
 
 // ----------------------------------------------------------------------------
 // LED ------------------------------------------------------------------------
@@ -10,6 +10,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <avr/sleep.h>
 #include "./controller/mcp23018.h"
 #include "./controller/teensy-2-0.h"
 #include "../../../firmware/lib/layout/eeprom-macro.h"
@@ -37,3 +38,10 @@ uint8_t kb__update_matrix(bool matrix[OPT__KB__ROWS][OPT__KB__COLUMNS]) {
     return 0;  // success
 }
 
+void kb__sleep(void) {
+    // idle mode leaves the timers and USB running, so we'll wake up on the
+    // next timer tick (or USB event)
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_mode();
+}
+
@@ -11,39 +11,6 @@
  */
 
 
-#define  T_q        q
-#define  T_w        w
-#define  T_e        f
-#define  T_r        p
-#define  T_t        g
-#define  T_a        a
-#define  T_s        r
-#define  T_d        s
-#define  T_f        t
-#define  T_g        d
-#define  T_z        z
-#define  T_x        x
-#define  T_c        c
-#define  T_v        v
-#define  T_b        b
-
-#define  T_y        j
-#define  T_u        l
-#define  T_i        u
-#define  T_o        y
-#define  T_p        semicol
-#define  T_h        h
-#define  T_j        n
-#define  T_k        e
-#define  T_l        i
-#define  T_semicol  o
-#define  T_quote    quote
-#define  T_n        k
-#define  T_m        m
-#define  T_comma    comma
-#define  T_period   period
-#define  T_slash    slash
-
-
 #include "./templates/kinesis-mod.c.h"
+#include "./colemak--kinesis-mod.layout.c.h"
 
@@ -23,6 +23,7 @@
 #include "../../../../../firmware/lib/timer.h"
 #include "../../../../../firmware/lib/usb.h"
 #include "../../../../../firmware/lib/usb/usage-page/keyboard.h"
+#include "../../../../../firmware/lib/layout/eeprom-macro.h"
 #include "../../../../../firmware/lib/layout/key-functions.h"
 #include "../../../../../firmware/lib/layout/layer-stack.h"
 #include "../../../../../firmware/keyboard.h"
@@ -40,56 +41,126 @@
 #define  R(name)  keys__release__##name
 
 /**                                                        macros/K/description
- * Expand into a "key" suitable for putting into the layout matrix
+ * Expand `name` into the corresponding action code, suitable for putting into
+ * the layout matrix
  */
-#define  K(name)  { &keys__press__##name, &keys__release__##name }
+#define  K(name)  keys__##name
 
 /**                                                       macros/KF/description
  * Expand `name` into the corresponding "key_functions" function name
  */
 #define  KF(name)  key_functions__##name
 
+// ----------------------------------------------------------------------------
+// action codes
+
+/**                                     macros/(group) action codes/description
+ * Build (and take apart) the 16-bit "action codes" that describe what each
+ * key in the layout does
+ *
+ * Members:
+ * - `_ACTION__KEY(mods, keycode)`: Press `keycode` (which may be `0`) along
+ *   with the given modifiers (an or'ed combination of the `_ACTION__MOD__...`
+ *   flags) on "press", and release them on "release"
+ * - `_ACTION__LAYER(op, id, number)`: Push and/or pop a layer-element (see
+ *   ".../firmware/lib/layout/layer-stack.h"); `op` is one of the
+ *   `_ACTION__LAYER__...` values
+ * - `_ACTION__MACRO(index)`: On "press", play `_macros[index]` (see
+ *   `KEYS__MACRO_TABLE()`)
+ * - `_ACTION__FUNCTION(index)`: Call `_functions[index][0]` on "press", and
+ *   `_functions[index][1]` on "release" (see `KEYS__FUNCTION_TABLE()`)
+ * - `_ACTION__NOP`: Do nothing
+ * - `_ACTION__TRANSP`: Be transparent (see `keys/transp`)
+ *
+ * Format:
+ *
+ *     -----------------------------------------------------------------
+ *      type      bits 14..13  bits 12..0
+ *      --------  -----------  ----------------------------------------
+ *      key       00           mods (5 bits), keycode (8 bits)
+ *      layer     01           op (2 bits), id (5 bits), number (6 bits)
+ *      macro     10           index into `_macros`
+ *      function  11           index into `_functions`
+ *     -----------------------------------------------------------------
+ *
+ * Notes:
+ * - Bit 15 is always `0`, so that action codes fit in an `int` (which is 16
+ *   bits on the AVR), and can be used as enum constants.
+ * - The modifier bits are in the same order (ctrl, shift, alt, gui) as the
+ *   modifier keycodes, so the keycode for bit `i` is `KEYBOARD__LeftControl +
+ *   i` (or `KEYBOARD__RightControl + i`, if `_ACTION__MOD__RIGHT` is set).
+ * - `_ACTION__TRANSP` is a "key" action with keycode `0x01`
+ *   (`KEYBOARD__ErrorRollOver`), which a keyboard should never send as a
+ *   regular key.
+ * - Compared to storing a pair of function pointers for every key, this
+ *   halves the size of each layer, and most keys (everything in
+ *   ".../firmware/lib/layout/keys.h", and all the layer keys) no longer need
+ *   functions of their own.
+ */
+#define  _ACTION__TYPE(code)  ( ((code) >> 13) & 0x3 )
+#define  _ACTION__TYPE__KEY       0
+#define  _ACTION__TYPE__LAYER     1
+#define  _ACTION__TYPE__MACRO     2
+#define  _ACTION__TYPE__FUNCTION  3
+
+#define  _ACTION__MOD__CTRL   (1<<0)
+#define  _ACTION__MOD__SHIFT  (1<<1)
+#define  _ACTION__MOD__ALT    (1<<2)
+#define  _ACTION__MOD__GUI    (1<<3)
+#define  _ACTION__MOD__RIGHT  (1<<4)
+
+#define  _ACTION__LAYER__PUSH_POP  0  // push on "press", pop on "release"
+#define  _ACTION__LAYER__PUSH      1  // push on "press"
+#define  _ACTION__LAYER__POP       2  // pop on "press"
+
+#define  _ACTION__KEY(mods, keycode)                                        \
+    ( (_ACTION__TYPE__KEY << 13) | ((mods) << 8) | (keycode) )
+#define  _ACTION__LAYER(op, id, number)                                     \
+    ( (_ACTION__TYPE__LAYER << 13) | ((op) << 11) | ((id) << 6) | (number) )
+#define  _ACTION__MACRO(index)                                              \
+    ( (_ACTION__TYPE__MACRO << 13) | (index) )
+#define  _ACTION__FUNCTION(index)                                           \
+    ( (_ACTION__TYPE__FUNCTION << 13) | (index) )
+
+#define  _ACTION__NOP     _ACTION__KEY(0, 0x00)
+#define  _ACTION__TRANSP  _ACTION__KEY(0, 0x01)
+
+#define  _ACTION__KEY__MODS(code)       ( ((code) >> 8) & 0x1F )
+#define  _ACTION__KEY__KEYCODE(code)    ( (code) & 0xFF )
+#define  _ACTION__LAYER__OP(code)       ( ((code) >> 11) & 0x3 )
+#define  _ACTION__LAYER__ID(code)       ( ((code) >> 6) & 0x1F )
+#define  _ACTION__LAYER__NUMBER(code)   ( (code) & 0x3F )
+#define  _ACTION__INDEX(code)           ( (code) & 0x1FFF )
+
 // ----------------------------------------------------------------------------
 // special meaning keys (may be used by `exec_key()`)
 
 /**                                                     keys/transp/description
  * transparent
  *
- * This key signals to the firmware (specifically the
- * `kb__layout__exec_key_location()` function) that it should look for what key
- * to "press" or "release" by going down the layer-stack until it finds a
- * non-transparent key at the same position.
- *
- * Notes:
- * - With this scheme, keys may be half transparent; that is, the "press" part
- *   of a key may be transparent while the "release" part isn't, or vice versa.
- *   I expect this to be fairly uncommon though.
+ * This key signals to the firmware (specifically the `kb__layout__exec_key()`
+ * function) that it should look for what key to "press" or "release" by going
+ * down the layer-stack until it finds a non-transparent key at the same
+ * position.
  */
-void KF(transp) (void) {}
-#define  keys__press__transp    KF(transp)
-#define  keys__release__transp  KF(transp)
+enum { keys__transp = _ACTION__TRANSP };
 
 /**                                                        keys/nop/desctiption
  * no operation
  *
  * This key does nothing (and is not transparent).
  */
-void KF(nop) (void) {}
-#define  keys__press__nop    KF(nop)
-#define  keys__release__nop  KF(nop)
+enum { keys__nop = _ACTION__NOP };
 
 // ----------------------------------------------------------------------------
 
 /**                                                    types/_key_t/description
- * The type we will use for our "key"s
+ * The type we will use for keys that need functions of their own (see
+ * `KEYS__FUNCTION_TABLE()`)
  *
  * Notes:
  * - Keys will be of the form
  *   `_key_t key = { &press_function, &release_function };`
- *
- * - The fact that keys are of this type (composed of two
- *   `void (*function)(void)` pointers) is assumed throughout most of these
- *   layout files
  */
 typedef  void (*_key_t[2])(void);
 
@@ -99,8 +170,174 @@ typedef  void (*_key_t[2])(void);
  * Notes:
  * - The first dimension of the matrix (left blank in the typedef since it
  *   varies between layouts) is "layers"
+ * - Each element is an action code (see `(group) action codes`)
+ */
+typedef  const uint16_t _layout_t[][OPT__KB__ROWS][OPT__KB__COLUMNS];
+
+/**                                             types/_combo_keys_t/description
+ * The type we will use for the matrix of which keys belong to which combos
+ *
+ * Notes:
+ * - Each element is a bitmask, with bit `i` set if the key at that position is
+ *   part of combo `i` (see `KEYS__COMBO_TABLE()`)
+ */
+typedef  const uint16_t _combo_keys_t[OPT__KB__ROWS][OPT__KB__COLUMNS];
+
+// ----------------------------------------------------------------------------
+
+/**                                     macros/KEYS__FUNCTION_TABLE/description
+ * Define `_functions`, and an action code for each key in it
+ *
+ * Arguments:
+ * - `list`: The name of a macro that takes a macro `X`, and calls `X(name)`
+ *   once for each key that needs functions of its own.  `P(name)` and
+ *   `R(name)` must already be defined.
+ *
+ * Notes:
+ * - Keys are numbered in the order they appear in `list`, and the action code
+ *   for each (`keys__##name`) is defined as an enum constant, so `K(name)`
+ *   works for these keys the same as it does for all the others.
+ * - `_function__count` is the number of keys in the table.
+ * - A layout with no such keys still has to define the table; see the usage
+ *   below.
+ *
+ * Usage:
+ *
+ *     #define  FUNCTIONS(X)  X(btldr) X(numPush) X(numPop)
+ *     KEYS__FUNCTION_TABLE( FUNCTIONS );
+ *
+ *     // or, with no functions
+ *     #define  FUNCTIONS(X)
+ *     KEYS__FUNCTION_TABLE( FUNCTIONS );
+ */
+#define  KEYS__FUNCTION_TABLE(list)                                         \
+    enum { list(_KEYS__FUNCTION__INDEX) _function__count,                   \
+           list(_KEYS__FUNCTION__CODE) };                                   \
+    static const _key_t _functions[] PROGMEM = { list(_KEYS__FUNCTION__ENTRY) }
+
+#define  _KEYS__FUNCTION__INDEX(name)  _function__##name,
+#define  _KEYS__FUNCTION__CODE(name)                                        \
+    keys__##name = _ACTION__FUNCTION(_function__##name),
+#define  _KEYS__FUNCTION__ENTRY(name)  { &P(name), &R(name) },
+
+/**                                        macros/KEYS__MACRO_TABLE/description
+ * Define `_macros`, and an action code for each macro in it
+ *
+ * Arguments:
+ * - `list`: The name of a macro that takes a macro `X`, and calls
+ *   `X(name, instruction, ...)` once for each macro, where the
+ *   `instruction`s are played (in order) when the key is pressed (see
+ *   `key_functions__macro_play()` in
+ *   ".../firmware/lib/layout/key-functions.h")
+ *
+ * Instructions:
+ * - An action code (e.g. `K(a)`, or an `_ACTION__KEY()`): Tap it
+ * - `KEYS__MACRO__PRESS(action)`, `KEYS__MACRO__RELEASE(action)`: Press (or
+ *   release) an action, without sending a report
+ * - `KEYS__MACRO__SEND`: Send a report
+ * - `KEYS__MACRO__DELAY(milliseconds)`: Wait (up to 4095 milliseconds)
+ * - `KEYS__MACRO__TYPE(string)`: Type a (PROGMEM) string
+ *
+ * Notes:
+ * - As with `KEYS__FUNCTION_TABLE()`, the action code for each macro is
+ *   `keys__##name`, and `_macro__count` is the number of macros.
+ * - Macros are played in the background, so the scan loop isn't held up while
+ *   they play.
+ * - A layout with no macros still has to define the table; see the usage
+ *   below.
+ *
+ * Usage:
+ *
+ *     static const char _hello[] PROGMEM = "Hello, world!";
+ *
+ *     #define  MACROS(X)                                                 \
+ *         X( m_ctrlC, _ACTION__KEY(_ACTION__MOD__CTRL, KEYBOARD__c_C) )  \
+ *         X( m_hi,    _ACTION__KEY(_ACTION__MOD__SHIFT, KEYBOARD__h_H),  \
+ *                     _ACTION__KEY(0, KEYBOARD__i_I) )                   \
+ *         X( m_hello, KEYS__MACRO__TYPE(_hello) )                        \
+ *         X( m_l1,    KEYS__MACRO__PRESS(K(lpu1l1)),                     \
+ *                     KEYS__MACRO__DELAY(500),                           \
+ *                     KEYS__MACRO__PRESS(K(lpo1l1)) )
+ *     KEYS__MACRO_TABLE( MACROS );
+ *
+ *     // or, with no macros
+ *     #define  MACROS(X)
+ *     KEYS__MACRO_TABLE( MACROS );
  */
-typedef  const _key_t _layout_t[][OPT__KB__ROWS][OPT__KB__COLUMNS];
+#define  KEYS__MACRO_TABLE(list)                                            \
+    list(_KEYS__MACRO__DATA)                                                \
+    enum { list(_KEYS__MACRO__INDEX) _macro__count,                         \
+           list(_KEYS__MACRO__CODE) };                                      \
+    static const uint16_t * const _macros[] PROGMEM = {                     \
+        list(_KEYS__MACRO__ENTRY) }
+
+#define  _KEYS__MACRO__DATA(name, ...)                                      \
+    static const uint16_t _macro__##name[] PROGMEM = {                      \
+        __VA_ARGS__, KEY_FUNCTIONS__MACRO__END };
+#define  _KEYS__MACRO__INDEX(name, ...)  _macro_index__##name,
+#define  _KEYS__MACRO__CODE(name, ...)                                      \
+    keys__##name = _ACTION__MACRO(_macro_index__##name),
+#define  _KEYS__MACRO__ENTRY(name, ...)  _macro__##name,
+
+#define  KEYS__MACRO__PRESS(action)    KEY_FUNCTIONS__MACRO__PRESS, (action)
+#define  KEYS__MACRO__RELEASE(action)  KEY_FUNCTIONS__MACRO__RELEASE, (action)
+#define  KEYS__MACRO__SEND             KEY_FUNCTIONS__MACRO__SEND
+#define  KEYS__MACRO__DELAY(ms)        ( KEY_FUNCTIONS__MACRO__DELAY | (ms) )
+#define  KEYS__MACRO__TYPE(string)                                          \
+    KEY_FUNCTIONS__MACRO__TYPE, (uint16_t)(string)
+
+/**                                        macros/KEYS__COMBO_TABLE/description
+ * Define `_combos`, and an index for each combo in it
+ *
+ * Arguments:
+ * - `list`: The name of a macro that takes a macro `X`, and calls
+ *   `X(name, size, action)` once for each combo, where `size` is the number of
+ *   keys in the combo, and `action` is the action code to perform when they
+ *   are all pressed together
+ *
+ * Notes:
+ * - There may be at most 16 combos, of at most 4 keys each.
+ * - Which keys are in which combo is given by `_combo_keys`, which should be
+ *   written using `MATRIX_LAYER()` (with `KEYS__COMBO_KEYS` as the macro to
+ *   call on each position), with `C(name)` for each combo a key is part of.
+ * - A layout with no combos still has to define both; see the usage below.
+ *
+ * Usage:
+ *
+ *     #define  COMBOS(X)                                                 \
+ *         X( wf, 2, K(esc) )                                             \
+ *         X( fp, 2, K(tab) )
+ *     KEYS__COMBO_TABLE( COMBOS );
+ *
+ *     static _combo_keys_t _combo_keys PROGMEM = MATRIX_LAYER(
+ *         KEYS__COMBO_KEYS, 0,
+ *         // ...
+ *         0, 0, C(wf), C(wf)|C(fp), C(fp), 0, 0,
+ *         // ...
+ *     );
+ *
+ *     // or, with no combos
+ *     #define  COMBOS(X)
+ *     KEYS__COMBO_TABLE( COMBOS );
+ *     static _combo_keys_t _combo_keys PROGMEM = {{0}};
+ */
+#define  KEYS__COMBO_TABLE(list)                                            \
+    enum { list(_KEYS__COMBO__INDEX) _combo__count };                       \
+    static const key_functions__combo_t _combos[] PROGMEM = {               \
+        list(_KEYS__COMBO__ENTRY) }
+
+#define  _KEYS__COMBO__INDEX(name, size, action)  _combo__##name,
+#define  _KEYS__COMBO__ENTRY(name, size, action)  { (size), (action) },
+
+/**                                                        macros/C/description
+ * Expand `name` into the bit for that combo (see `KEYS__COMBO_TABLE()`)
+ */
+#define  C(name)  ( 1U << _combo__##name )
+
+/**                                         macros/KEYS__COMBO_KEYS/description
+ * The macro for `MATRIX_LAYER()` to call on each position of `_combo_keys`
+ */
+#define  KEYS__COMBO_KEYS(set)  (set)
 
 // ----------------------------------------------------------------------------
 
@@ -109,6 +346,26 @@ typedef  const _key_t _layout_t[][OPT__KB__ROWS][OPT__KB__COLUMNS];
  */
 static _layout_t _layout PROGMEM;
 
+/**                                            variables/_functions/description
+ * The functions for keys that need them (see `KEYS__FUNCTION_TABLE()`)
+ */
+static const _key_t _functions[] PROGMEM;
+
+/**                                               variables/_macros/description
+ * The macros (see `KEYS__MACRO_TABLE()`)
+ */
+static const uint16_t * const _macros[] PROGMEM;
+
+/**                                               variables/_combos/description
+ * The combos (see `KEYS__COMBO_TABLE()`)
+ */
+static const key_functions__combo_t _combos[] PROGMEM;
+
+/**                                           variables/_combo_keys/description
+ * Which keys belong to which combos (see `KEYS__COMBO_TABLE()`)
+ */
+static _combo_keys_t _combo_keys PROGMEM;
+
 /**                                                variables/_flags/description
  * A collection of flags pertaining to the operation of `...exec_key()`
  *
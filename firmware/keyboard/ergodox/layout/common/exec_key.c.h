@@ -17,66 +17,279 @@
 // ----------------------------------------------------------------------------
 
 
+#include <string.h>
 #include "./definitions.h"
 
 // ----------------------------------------------------------------------------
 
-void kb__layout__exec_key(bool pressed, uint8_t row, uint8_t column) {
+/**                                             variables/_resolved/description
+ * A cache of which layer each key position resolves to, for the current
+ * layer-stack
+ *
+ * Struct members:
+ * - `valid`: Whether the generations (and therefore `layer`) mean anything
+ *   yet
+ * - `generation`: The layer-stack generation (see
+ *   `layer_stack__generation()`) the cache was filled for
+ * - `remap_generation`: The remapping generation (see
+ *   `eeprom_macro__remap_generation()`) the cache was filled for
+ * - `layer`: The first layer, going down the layer-stack, with a
+ *   non-transparent key at each position; `UINT8_MAX` if not looked up yet
+ *
+ * Notes:
+ * - Without this, every key press would read one entry of `_layout` from
+ *   PROGMEM for every layer it's transparent in.  With it, that only happens
+ *   once per position per change to the layer-stack.
+ * - Layers are changed by keys, and keys are pressed one at a time, so
+ *   between two layer changes usually only a few positions get looked up.
+ *   Throwing the whole cache away (rather than working out which entries a
+ *   given push or pop affected) is simpler, and costs about the same.
+ * - Remapping a key changes what `_action()` returns, so the cache is thrown
+ *   away when either generation changes.
+ * - This takes `OPT__KB__ROWS * OPT__KB__COLUMNS` bytes of SRAM.
+ */
+static struct {
+    bool     valid;
+    uint16_t generation;
+    uint16_t remap_generation;
+    uint8_t  layer[OPT__KB__ROWS][OPT__KB__COLUMNS];
+} _resolved;
 
-    // if we press a key, we need to keep track of the layer it was pressed on,
-    // so we can release it on the same layer
-    // - if the release is transparent, search through the layer stack for a
-    //   non-transparent release in the same position, as normal
-    // - don't need to initialize, since we'll only read from positions that
-    //   we've previously set
-    static uint8_t pressed_layer[OPT__KB__ROWS][OPT__KB__COLUMNS];
+/**                                             variables/_position/description
+ * The position of the key currently being executed
+ *
+ * Notes:
+ * - For key functions that need to know where they are (like dual-role keys;
+ *   see `KEYS__DUAL_ROLE()`).
+ */
+static struct {
+    uint8_t row;
+    uint8_t column;
+} _position;
+
+// ----------------------------------------------------------------------------
+
+/**                                               functions/_action/description
+ * Return the action code at the given position in `_layout`, or what the
+ * position has been remapped to (see `eeprom_macro__remap()`)
+ *
+ * Notes:
+ * - Positions that haven't been remapped on any layer (almost all of them)
+ *   cost one extra SRAM read.  Remapped positions cost a few more (see
+ *   `eeprom_macro__remap_read()`), but no PROGMEM read.
+ */
+static uint16_t _action(uint8_t layer, uint8_t row, uint8_t column) {
+    uint16_t action;
+
+    if ( eeprom_macro__remapped[row][column] &&
+         eeprom_macro__remap_read( (eeprom_macro__uid_t) { .layer  = layer,
+                                                           .row    = row,
+                                                           .column = column },
+                                   &action ) )
+        return action;
 
-    void (*function)(void);
-    uint8_t layer;
+    return pgm_read_word( &_layout[layer][row][column] );
+}
+
+/**                                              functions/_resolve/description
+ * Return the first layer, going down the layer-stack, with a non-transparent
+ * key at the given position
+ *
+ * Arguments:
+ * - `row`, `column`: The position
+ * - `action`: A pointer to where to put the action at the position on the
+ *   returned layer (so the caller doesn't have to look it up again)
+ *
+ * Returns:
+ * - success: the layer-number; if every layer is transparent at this
+ *   position, `0` (which the caller will find transparent as well)
+ */
+static uint8_t _resolve(uint8_t row, uint8_t column, uint16_t * action) {
+    uint16_t generation       = layer_stack__generation();
+    uint16_t remap_generation = eeprom_macro__remap_generation();
+
+    if ( !_resolved.valid || _resolved.generation != generation
+                          || _resolved.remap_generation != remap_generation ) {
+        memset(_resolved.layer, UINT8_MAX, sizeof(_resolved.layer));
+        _resolved.valid            = true;
+        _resolved.generation       = generation;
+        _resolved.remap_generation = remap_generation;
+    }
+
+    uint8_t * cached = &_resolved.layer[row][column];
+    if (*cached != UINT8_MAX) {
+        *action = _action(*cached, row, column);
+        return *cached;
+    }
 
-    // - add 1 to the stack size because we spend the first iteration checking
-    //   to see if we need to release on a previously stored layer
     // - add 1 to the stack size in order to peek out of bounds on the last
     //   iteration (if we get that far), so that layer 0 is our default (see
     //   the documentation for ".../firmware/lib/layout/layer-stack.h")
-    for (uint8_t i=0; i < layer_stack__size()+1+1; i++) {  // i = offset+1
-        if (i == 0)
-            if (!pressed)
-                layer = pressed_layer[row][column];
-            else
-                continue;
-        else
-            layer = layer_stack__peek(i-1);
-
-        function = (void (*)(void))
-                   pgm_read_word( &( _layout[ layer             ]
-                                            [ row               ]
-                                            [ column            ]
-                                            [ (pressed) ? 0 : 1 ] ) );
-
-        if (function == &KF(transp))
-            function = NULL;
-
-        if (function) {
-            if (pressed)
-                pressed_layer[row][column] = layer;
+    uint8_t layer = 0;
+    for (uint8_t offset=0; offset < layer_stack__size()+1; offset++) {
+        layer   = layer_stack__peek(offset);
+        *action = _action(layer, row, column);
+        if (*action != _ACTION__TRANSP)
+            break;
+    }
 
-            _flags.tick_keypresses = (pressed) ? true : false;  // set default
+    return *cached = layer;
+}
 
-            (*function)();
+// ----------------------------------------------------------------------------
+
+/**                                                  functions/_key/description
+ * Press or release the modifiers and keycode of a "key" action
+ */
+static void _key(bool pressed, uint16_t action) {
+    uint8_t mods    = _ACTION__KEY__MODS(action);
+    uint8_t keycode = _ACTION__KEY__KEYCODE(action);
+    uint8_t base    = (mods & _ACTION__MOD__RIGHT) ? KEYBOARD__RightControl
+                                                   : KEYBOARD__LeftControl;
+
+    if (!pressed && keycode)
+        KF(release)(keycode);
+
+    for (uint8_t i=0; i<4; i++) {
+        if (mods & (1<<i)) {
+            if (pressed) KF(press)(base+i);
+            else         KF(release)(base+i);
+        }
+    }
+
+    if (pressed && keycode)
+        KF(press)(keycode);
+}
 
-            // TODO: *always* tick keypresses
-            // TODO: instead of this, set a flag for the type of key pressed,
-            // and any functions that execute can check it, and conditionally
-            // reschedule themselves to run later, if they so desire
-            if (_flags.tick_keypresses)
-                timer___tick_keypresses();
+/**                                          functions/_is_modifier/description
+ * Return whether the given action only presses modifiers (or nothing)
+ */
+static bool _is_modifier(uint16_t action) {
+    uint8_t keycode = _ACTION__KEY__KEYCODE(action);
+    return _ACTION__TYPE(action) == _ACTION__TYPE__KEY
+           && ( !keycode || ( keycode >= KEYBOARD__LeftControl &&
+                              keycode <= KEYBOARD__RightGUI ) );
+}
+
+/**                                                 functions/_exec/description
+ * Perform the given (non-transparent) action
+ *
+ * Notes:
+ * - This is the only place action codes are interpreted.
+ */
+static void _exec(bool pressed, uint16_t action) {
+    switch (_ACTION__TYPE(action)) {
+
+        case _ACTION__TYPE__KEY:
+            _key(pressed, action);
+            // modifiers on their own aren't keypresses (so one-shot keys, for
+            // example, wait for the key they're meant to modify)
+            if (_is_modifier(action))
+                _flags.tick_keypresses = false;
+            break;
+
+        case _ACTION__TYPE__LAYER: {
+            uint8_t op = _ACTION__LAYER__OP(action);
+            uint8_t id = _ACTION__LAYER__ID(action);
+            if (pressed && op != _ACTION__LAYER__POP)
+                layer_stack__push(0, id, _ACTION__LAYER__NUMBER(action));
+            else if ( (pressed && op == _ACTION__LAYER__POP) ||
+                      (!pressed && op == _ACTION__LAYER__PUSH_POP) )
+                layer_stack__pop_id(id);
+            _flags.tick_keypresses = false;
+            break;
+        }
+
+        case _ACTION__TYPE__MACRO:
+            if (pressed)
+                KF(macro_play)( (const uint16_t *)
+                                pgm_read_word( &_macros[
+                                                 _ACTION__INDEX(action) ] ),
+                                &_exec );
+            break;
 
-            return;
+        case _ACTION__TYPE__FUNCTION: {
+            void (*function)(void) = (void (*)(void))
+                pgm_read_word( &_functions[ _ACTION__INDEX(action) ]
+                                          [ (pressed) ? 0 : 1      ] );
+            (*function)();
+            break;
         }
     }
+}
+
+// ----------------------------------------------------------------------------
+
+/**                                             functions/_exec_key/description
+ * Execute the key at the given position, once all the filters have passed it
+ * on
+ */
+static void _exec_key(bool pressed, uint8_t row, uint8_t column) {
+
+    // if we press a key, we need to keep track of the layer it was pressed on,
+    // so we can release it on the same layer
+    // - don't need to initialize, since we'll only read from positions that
+    //   we've previously set
+    static uint8_t pressed_layer[OPT__KB__ROWS][OPT__KB__COLUMNS];
+
+    uint16_t action;
+    if (pressed)
+        pressed_layer[row][column] = _resolve(row, column, &action);
+    else
+        action = _action(pressed_layer[row][column], row, column);
+
+    // if there was a transparent key in layer 0, do nothing
+    if (action == _ACTION__TRANSP)
+        return;
+
+    // a tap-dance key being counted is settled by any other key's press
+    if (pressed)
+        KF(tap_dance_interrupt)(row, column);
+
+    // let a leader sequence (if one is being typed) take the key, unless it's
+    // a modifier
+    if ( !_is_modifier(action) &&
+         KF(leader_filter)(pressed, row, column, action) )
+        return;
+
+    _flags.tick_keypresses = (pressed) ? true : false;  // set default
+
+    _position.row    = row;
+    _position.column = column;
+    _exec(pressed, action);
+
+    // TODO: *always* tick keypresses
+    // TODO: instead of this, set a flag for the type of key pressed,
+    // and any functions that execute can check it, and conditionally
+    // reschedule themselves to run later, if they so desire
+    if (_flags.tick_keypresses)
+        timer___tick_keypresses();
+}
+
+/**                                      functions/_dual_role_stage/description
+ * Pass the event through the dual-role filter (see
+ * `key_functions__dual_role_filter()`), then execute it
+ */
+static void _dual_role_stage(bool pressed, uint8_t row, uint8_t column) {
+    if (KF(dual_role_filter)(pressed, row, column, &_exec_key))
+        return;
+
+    _exec_key(pressed, row, column);
+}
+
+// ----------------------------------------------------------------------------
+
+void kb__layout__exec_key(bool pressed, uint8_t row, uint8_t column) {
+
+    // every event goes through the combo filter, then the dual-role filter
+    // - each filter passes the events it held back (and then let go of) on to
+    //   the next stage, not back to this one, so no filter sees an event twice
+    if ( KF(combo_filter)( pressed, row, column,
+                           pgm_read_word(&_combo_keys[row][column]),
+                           _combos, &_exec, &_dual_role_stage ) )
+        return;
 
-    // if we get here, there was a transparent key in layer 0; do nothing
+    _dual_role_stage(pressed, row, column);
 }
 
 
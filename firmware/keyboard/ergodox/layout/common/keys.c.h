@@ -41,29 +41,26 @@
 // ----------------------------------------------------------------------------
 
 /**                                            macros/KEYS__DEFAULT/description
- * Define the functions for a default key (i.e. a normal key that presses and
- * releases a keycode as you'd expect)
+ * Define the action code for a default key (i.e. a normal key that presses
+ * and releases a keycode as you'd expect)
  *
  * Needed by ".../lib/layout/keys.h"
  */
-#define  KEYS__DEFAULT(name, value)             \
-    void P(name) (void) { KF(press)(value); }   \
-    void R(name) (void) { KF(release)(value); }
+#define  KEYS__DEFAULT(name, value)                                 \
+    enum { keys__##name = _ACTION__KEY(0, value) }
 
 /**                                            macros/KEYS__SHIFTED/description
- * Define the functions for a "shifted" key (i.e. a key that sends a "shift"
+ * Define the action code for a "shifted" key (i.e. a key that sends a "shift"
  * along with the keycode)
  *
  * Needed by ".../lib/layout/keys.h"
  */
-#define  KEYS__SHIFTED(name, value)                             \
-    void P(name) (void) { KF(press)(KEYBOARD__LeftShift);       \
-                          KF(press)(value); }                   \
-    void R(name) (void) { KF(release)(value);                   \
-                          KF(release)(KEYBOARD__LeftShift); }
+#define  KEYS__SHIFTED(name, value)                                 \
+    enum { keys__##name = _ACTION__KEY(_ACTION__MOD__SHIFT, value) }
 
 /**                                    macros/KEYS__LAYER__PUSH_POP/description
- * Define the functions for a layer push-pop key (i.e. a layer shift key).
+ * Define the action codes for a layer push-pop key (i.e. a layer shift key),
+ * and the corresponding push (only) and pop (only) keys
  *
  * Naming Convention:
  * - Example: In the name `lpupo1l1`, we have the following:
@@ -82,24 +79,24 @@
  *   push the layer onto the stack, not pop anything out of it.  A key with
  *   only `po` should *only* pop the layer out of the stack.
  *
- * - If the function *only* pops the layer-element, the `layer_number` is not
+ * - If the key *only* pops the layer-element, the `layer_number` is not
  *   important: layers are popped based only on their `layer_id`.
  *
  * Notes:
- * - To save space, if you define a push-pop function, the push (only) and pop
- *   (only) functions may be defined as follows (using the example `lpupo1l1`
- *   from above):
- *
- *       #define  keys__press__lpu1l1    P(lpupo1l1)
- *       #define  keys__release__lpu1l1  KF(nop)
- *       #define  keys__press__lpo1l1    R(lpupo1l1)
- *       #define  keys__release__lpo1l1  KF(nop)
+ * - Using the example from above, this defines `lpupo1l1`, `lpu1l1`, and
+ *   `lpo1l1`.
+ * - `ID` must be less than 32, and `LAYER` less than 64 (see `(group) action
+ *   codes`).
  */
 #define  KEYS__LAYER__PUSH_POP(ID, LAYER)                                   \
-    void P(lpupo##ID##l##LAYER) (void) { layer_stack__push(0, ID, LAYER);   \
-                                         _flags.tick_keypresses = false; }  \
-    void R(lpupo##ID##l##LAYER) (void) { layer_stack__pop_id(ID);           \
-                                         _flags.tick_keypresses = false; }
+    enum {                                                                  \
+        keys__lpupo##ID##l##LAYER                                           \
+            = _ACTION__LAYER(_ACTION__LAYER__PUSH_POP, ID, LAYER),          \
+        keys__lpu##ID##l##LAYER                                             \
+            = _ACTION__LAYER(_ACTION__LAYER__PUSH, ID, LAYER),              \
+        keys__lpo##ID##l##LAYER                                             \
+            = _ACTION__LAYER(_ACTION__LAYER__POP, ID, LAYER),               \
+    }
 
 /**                               macros/(group) layer : number pad/description
  * Define functions for pushing and popping the number pad (namely `numPush`,
@@ -111,7 +108,8 @@
  * - `KEYS__LAYER__NUM_POP`
  *
  * These macros are meant to be used (if necessary) in the layout file, since
- * they need to know the layer on which the number pad has been placed.
+ * they need to know the layer on which the number pad has been placed.  The
+ * keys they define need to be listed in the layout's `KEYS__FUNCTION_TABLE()`.
  */
 #define  KEYS__LAYER__NUM_PU_PO(ID, LAYER)                              \
     void P(numPuPo) (void) { layer_stack__push(0, ID, LAYER);           \
@@ -141,6 +139,136 @@
     void R(numPop) (void) { KF(release)(KEYBOARD__LockingNumLock);      \
                             _flags.tick_keypresses = false; }
 
+/**                                          macros/KEYS__DUAL_ROLE/description
+ * Define the functions for a dual-role key (i.e. a key that performs one
+ * action when tapped, and another when held)
+ *
+ * Arguments:
+ * - `name`: The name of the key
+ * - `tap`, `hold`: The action codes for each role
+ * - `policy`: One of the `KEY_FUNCTIONS__DUAL_ROLE__...` policies (see
+ *   `key_functions__dual_role_policy_t`)
+ *
+ * Notes:
+ * - The key needs to be listed in the layout's `KEYS__FUNCTION_TABLE()`.
+ * - The release is handled by `key_functions__dual_role_filter()` (called
+ *   from `kb__layout__exec_key()`), so the release function does nothing.
+ */
+#define  KEYS__DUAL_ROLE(name, tap, hold, policy)                           \
+    void P(name) (void) { KF(dual_role_press)( _position.row,               \
+                                               _position.column,            \
+                                               tap, hold, policy,           \
+                                               &_exec );                    \
+                          _flags.tick_keypresses = false; }                 \
+    void R(name) (void) {}
+
+/**                                           macros/KEYS__ONE_SHOT/description
+ * Define the functions for a one-shot (or "sticky") key (i.e. a key that, if
+ * tapped, applies to the next key pressed)
+ *
+ * Arguments:
+ * - `name`: The name of the key
+ * - `action`: The action code to perform (a modifier, or a push-pop layer
+ *   action, usually)
+ *
+ * Notes:
+ * - The key needs to be listed in the layout's `KEYS__FUNCTION_TABLE()`.
+ */
+#define  KEYS__ONE_SHOT(name, action)                                       \
+    void P(name) (void) { KF(one_shot_press)(action, &_exec);               \
+                          _flags.tick_keypresses = false; }                 \
+    void R(name) (void) { KF(one_shot_release)(action, &_exec); }
+
+/**                                             macros/KEYS__LEADER/description
+ * Define the functions for a leader key (i.e. a key that starts a sequence of
+ * keys, which together perform an action)
+ *
+ * Arguments:
+ * - `name`: The name of the key
+ * - `root`: The name of the root node of the trie of sequences (see
+ *   `KEYS__LEADER__NODE()`)
+ *
+ * Notes:
+ * - The key needs to be listed in the layout's `KEYS__FUNCTION_TABLE()`.
+ */
+#define  KEYS__LEADER(name, root)                                           \
+    void P(name) (void) { KF(leader_start)(&_leader__##root, &_exec);       \
+                          _flags.tick_keypresses = false; }                 \
+    void R(name) (void) {}
+
+/**                                       macros/KEYS__LEADER__NODE/description
+ * Define a node (named `name`) in a trie of leader sequences
+ *
+ * Arguments:
+ * - `name`: The name of the node
+ * - `action`: The action code to perform if the sequence ends here (`0`, i.e.
+ *   `K(nop)`, if it can't)
+ * - `...`: The edges leaving the node (see `KEYS__LEADER__EDGE()`), if any
+ *
+ * Notes:
+ * - Nodes have to be defined before the nodes that point to them, so the
+ *   root comes last.
+ *
+ * Usage:
+ *
+ *     // leader, g, c  ->  m_ctrlC
+ *     // leader, g, v  ->  m_ctrlV
+ *     // leader, g     ->  m_ctrlZ  (after the timeout)
+ *     KEYS__LEADER__NODE( l_gc, K(m_ctrlC) );
+ *     KEYS__LEADER__NODE( l_gv, K(m_ctrlV) );
+ *     KEYS__LEADER__NODE( l_g,  K(m_ctrlZ), KEYS__LEADER__EDGE(K(c), l_gc),
+ *                                           KEYS__LEADER__EDGE(K(v), l_gv) );
+ *     KEYS__LEADER__NODE( l,    K(nop),     KEYS__LEADER__EDGE(K(g), l_g) );
+ *
+ *     KEYS__LEADER( lead, l );
+ */
+#define  KEYS__LEADER__NODE(name, action, ...)                              \
+    static const key_functions__leader_edge_t                               \
+        _leader_edges__##name[] PROGMEM = { __VA_ARGS__ };                  \
+    static const key_functions__leader_node_t                               \
+        _leader__##name PROGMEM = {                                         \
+            (action),                                                       \
+            sizeof(_leader_edges__##name)                                   \
+                / sizeof(key_functions__leader_edge_t),                     \
+            _leader_edges__##name,                                          \
+        }
+
+/**                                       macros/KEYS__LEADER__EDGE/description
+ * An edge (labeled with `action`, and pointing to the node named `name`) for
+ * use with `KEYS__LEADER__NODE()`
+ */
+#define  KEYS__LEADER__EDGE(action, name)  { (action), &_leader__##name }
+
+/**                                          macros/KEYS__TAP_DANCE/description
+ * Define the functions for a tap-dance key (i.e. a key whose action depends
+ * on how many times it's tapped)
+ *
+ * Arguments:
+ * - `name`: The name of the key
+ * - `hold`: The action code to press if the key is held, or `0` (i.e.
+ *   `K(nop)`) to hold the action for the number of taps so far
+ * - `...`: The action codes for 1 tap, 2 taps, etc.
+ *
+ * Notes:
+ * - The key needs to be listed in the layout's `KEYS__FUNCTION_TABLE()`.
+ *
+ * Usage:
+ *
+ *     // 1 tap = ";", 2 taps = ":", hold = layer 1
+ *     KEYS__TAP_DANCE( tdSemi, _ACTION__LAYER(_ACTION__LAYER__PUSH_POP, 1, 1),
+ *                      K(semicol), K(colon) );
+ */
+#define  KEYS__TAP_DANCE(name, hold, ...)                                   \
+    static const uint16_t _tap_dance__##name[] PROGMEM = { __VA_ARGS__ };   \
+    void P(name) (void) {                                                   \
+        KF(tap_dance_press)( _position.row, _position.column,               \
+                             _tap_dance__##name,                            \
+                             sizeof(_tap_dance__##name) / sizeof(uint16_t), \
+                             hold, &_exec );                                \
+        _flags.tick_keypresses = false; }                                   \
+    void R(name) (void) {                                                   \
+        KF(tap_dance_release)(_position.row, _position.column); }
+
 // ----------------------------------------------------------------------------
 
 /**                                       functions/KF(2_keys_caps)/description
@@ -188,7 +316,8 @@ KEYS__DEFAULT( mute,    KEYBOARD__Mute       );
  * This key always generates a left shift.  If the `shR2kcap` is pressed at
  * the same time, "capslock" will be toggled.
  */
-void P(shL2kcap) (void) { KF(2_keys_capslock)(true, KEYBOARD__LeftShift); }
+void P(shL2kcap) (void) { KF(2_keys_capslock)(true, KEYBOARD__LeftShift);
+                          _flags.tick_keypresses = false; }
 void R(shL2kcap) (void) { KF(2_keys_capslock)(false, KEYBOARD__LeftShift); }
 
 /**                                                   keys/shR2kcap/description
@@ -197,9 +326,43 @@ void R(shL2kcap) (void) { KF(2_keys_capslock)(false, KEYBOARD__LeftShift); }
  * This key always generates a right shift.  If the `shL2kcaps` is pressed at
  * the same time, "capslock" will be toggled.
  */
-void P(shR2kcap) (void) { KF(2_keys_capslock)(true, KEYBOARD__RightShift); }
+void P(shR2kcap) (void) { KF(2_keys_capslock)(true, KEYBOARD__RightShift);
+                          _flags.tick_keypresses = false; }
 void R(shR2kcap) (void) { KF(2_keys_capslock)(false, KEYBOARD__RightShift); }
 
+/**                                                    keys/escCtrl/description
+ * escape when tapped, left control when held
+ */
+KEYS__DUAL_ROLE( escCtrl, keys__esc, keys__ctrlL,
+                 KEY_FUNCTIONS__DUAL_ROLE__PERMISSIVE_HOLD );
+
+/**                                                    keys/spaceL1/description
+ * space when tapped, layer 1 (push-pop, with layer-id 1) when held
+ */
+KEYS__DUAL_ROLE( spaceL1, keys__space,
+                 _ACTION__LAYER(_ACTION__LAYER__PUSH_POP, 1, 1),
+                 KEY_FUNCTIONS__DUAL_ROLE__TAPPING_TERM );
+
+/**                                                     keys/tdSemi/description
+ * semicolon when tapped once, colon when tapped twice, layer 1 (push-pop,
+ * with layer-id 1) when held
+ */
+KEYS__TAP_DANCE( tdSemi, _ACTION__LAYER(_ACTION__LAYER__PUSH_POP, 1, 1),
+                 keys__semicol, keys__colon );
+
+/**                                           keys/(group) one-shot/description
+ * one-shot modifiers, and a one-shot layer 1 (with layer-id 1)
+ *
+ * Members:
+ * - `osShL`, `osCtrlL`, `osAltL`, `osGuiL`
+ * - `osL1`
+ */
+KEYS__ONE_SHOT( osShL,   keys__shiftL );
+KEYS__ONE_SHOT( osCtrlL, keys__ctrlL  );
+KEYS__ONE_SHOT( osAltL,  keys__altL   );
+KEYS__ONE_SHOT( osGuiL,  keys__guiL   );
+KEYS__ONE_SHOT( osL1,    _ACTION__LAYER(_ACTION__LAYER__PUSH_POP, 1, 1) );
+
 /**                                                      keys/btldr/description
  * jump to the bootloader
  *
@@ -210,113 +373,56 @@ void R(shR2kcap) (void) { KF(2_keys_capslock)(false, KEYBOARD__RightShift); }
 void P(btldr) (void) { KF(jump_to_bootloader)(); }
 void R(btldr) (void) {}
 
-/**                                                      keys/special macros/description
+/**                                                    keys/typCncl/description
+ * stop typing
+ *
+ * Cancels a string being typed in the background (see
+ * `key_functions__type_string()`), releasing anything it had pressed.
+ */
+void P(typCncl) (void) { KF(cancel_typing)(); }
+void R(typCncl) (void) {}
+
+/**                                                     keys/uniWin/description
+ * type "unicode sequences" the Windows way
+ *
+ * Selects the method `key_functions__type_string()` uses for characters
+ * without a dedicated keycode (see `key_functions__unicode_method_t`).
+ * Likewise for `uniMac` and `uniLin`.
+ */
+void P(uniWin) (void) {
+    KF(set_unicode_method)(KEY_FUNCTIONS__UNICODE__WINDOWS); }
+void R(uniWin) (void) {}
+
+void P(uniMac) (void) {
+    KF(set_unicode_method)(KEY_FUNCTIONS__UNICODE__MACOS); }
+void R(uniMac) (void) {}
+
+void P(uniLin) (void) {
+    KF(set_unicode_method)(KEY_FUNCTIONS__UNICODE__LINUX); }
+void R(uniLin) (void) {}
+
+/**                                             keys/special macros/description
  * Common windows macros - special
  *
  * Shortcut keys that can be used in place of keys
+ *
+ * Notes:
+ * - These need to be given to the layout's `KEYS__MACRO_TABLE()`.
  */
-void keys__press__m_ctrlB(void) {
-	usb__kb__set_key(true, KEYBOARD__LeftControl);
-	usb__kb__set_key(true, KEYBOARD__b_B);
-	usb__kb__send_report();
-	usb__kb__set_key(false, KEYBOARD__LeftControl);
-	usb__kb__set_key(false, KEYBOARD__b_B);
-}
-void R(m_ctrlB)(void) {}
-
-void keys__press__m_ctrlC(void) {
-	usb__kb__set_key(true, KEYBOARD__LeftControl);
-	usb__kb__set_key(true, KEYBOARD__c_C);
-	usb__kb__send_report();
-	usb__kb__set_key(false, KEYBOARD__LeftControl);
-	usb__kb__set_key(false, KEYBOARD__c_C);
-}
-void R(m_ctrlC)(void) {}
-
-void keys__press__m_ctrlV(void) {
-	usb__kb__set_key(true, KEYBOARD__LeftControl);
-	usb__kb__set_key(true, KEYBOARD__v_V);
-	usb__kb__send_report();
-	usb__kb__set_key(false, KEYBOARD__LeftControl);
-	usb__kb__set_key(false, KEYBOARD__v_V);
-}
-void R(m_ctrlV)(void) {}
-
-void keys__press__m_ctrlX(void) {
-	usb__kb__set_key(true, KEYBOARD__LeftControl);
-	usb__kb__set_key(true, KEYBOARD__x_X);
-	usb__kb__send_report();
-	usb__kb__set_key(false, KEYBOARD__LeftControl);
-	usb__kb__set_key(false, KEYBOARD__x_X);
-}
-void R(m_ctrlX)(void) {}
-
-void keys__press__m_ctrlZ(void) {
-	usb__kb__set_key(true, KEYBOARD__LeftControl);
-	usb__kb__set_key(true, KEYBOARD__z_Z);
-	usb__kb__send_report();
-	usb__kb__set_key(false, KEYBOARD__LeftControl);
-	usb__kb__set_key(false, KEYBOARD__z_Z);
-}
-void R(m_ctrlZ)(void) {}
-
-void keys__press__m_cad(void) {
-    usb__kb__set_key(true, KEYBOARD__LeftAlt);
-	usb__kb__set_key(true, KEYBOARD__LeftControl);
-    usb__kb__set_key(true, KEYBOARD__DeleteForward);
-    usb__kb__send_report();
-    usb__kb__set_key(false, KEYBOARD__LeftAlt);
-	usb__kb__set_key(false, KEYBOARD__LeftControl);
-    usb__kb__set_key(false, KEYBOARD__DeleteForward);
-}
-void R(m_cad)(void) {}
-
-void keys__press__m_caEnd(void) {
-    usb__kb__set_key(true, KEYBOARD__LeftAlt);
-	usb__kb__set_key(true, KEYBOARD__LeftControl);
-    usb__kb__set_key(true, KEYBOARD__End);
-    usb__kb__send_report();
-    usb__kb__set_key(false, KEYBOARD__LeftAlt);
-	usb__kb__set_key(false, KEYBOARD__LeftControl);
-    usb__kb__set_key(false, KEYBOARD__End);
-}
-void R(m_caEnd)(void) {}
-
-void keys__press__m_altF4(void) {
-    usb__kb__set_key(true, KEYBOARD__LeftAlt);
-    usb__kb__set_key(true, KEYBOARD__F4);
-    usb__kb__send_report();
-    usb__kb__set_key(false, KEYBOARD__LeftAlt);
-    usb__kb__set_key(false, KEYBOARD__F4);
-}
-void R(m_altF4)(void) {}
-
-void keys__press__m_winRt(void) {
-    usb__kb__set_key(true, KEYBOARD__LeftGUI);
-    usb__kb__set_key(true, KEYBOARD__RightArrow);
-    usb__kb__send_report();
-    usb__kb__set_key(false, KEYBOARD__LeftGUI);
-    usb__kb__set_key(false, KEYBOARD__RightArrow);
-}
-void R(m_winRt)(void) {}
-
-void keys__press__m_winLt(void) {
-    usb__kb__set_key(true, KEYBOARD__LeftGUI);
-    usb__kb__set_key(true, KEYBOARD__LeftArrow);
-    usb__kb__send_report();
-    usb__kb__set_key(false, KEYBOARD__LeftGUI);
-    usb__kb__set_key(false, KEYBOARD__LeftArrow);
-}
-void R(m_winLt)(void) {}
-
-void keys__press__m_winUp(void) {
-    usb__kb__set_key(true, KEYBOARD__LeftGUI);
-    usb__kb__set_key(true, KEYBOARD__UpArrow);
-    usb__kb__send_report();
-    usb__kb__set_key(false, KEYBOARD__LeftGUI);
-    usb__kb__set_key(false, KEYBOARD__UpArrow);
-}
-void R(m_winUp)(void) {}
+#define  KEYS__MACROS__COMMON(X)                                            \
+    X( m_ctrlB, _ACTION__KEY( _ACTION__MOD__CTRL, KEYBOARD__b_B ) )         \
+    X( m_ctrlC, _ACTION__KEY( _ACTION__MOD__CTRL, KEYBOARD__c_C ) )         \
+    X( m_ctrlV, _ACTION__KEY( _ACTION__MOD__CTRL, KEYBOARD__v_V ) )         \
+    X( m_ctrlX, _ACTION__KEY( _ACTION__MOD__CTRL, KEYBOARD__x_X ) )         \
+    X( m_ctrlZ, _ACTION__KEY( _ACTION__MOD__CTRL, KEYBOARD__z_Z ) )         \
+    X( m_cad,   _ACTION__KEY( _ACTION__MOD__CTRL | _ACTION__MOD__ALT,       \
+                              KEYBOARD__DeleteForward ) )                   \
+    X( m_caEnd, _ACTION__KEY( _ACTION__MOD__CTRL | _ACTION__MOD__ALT,       \
+                              KEYBOARD__End ) )                             \
+    X( m_altF4, _ACTION__KEY( _ACTION__MOD__ALT,  KEYBOARD__F4 ) )          \
+    X( m_winRt, _ACTION__KEY( _ACTION__MOD__GUI,  KEYBOARD__RightArrow ) )  \
+    X( m_winLt, _ACTION__KEY( _ACTION__MOD__GUI,  KEYBOARD__LeftArrow ) )   \
+    X( m_winUp, _ACTION__KEY( _ACTION__MOD__GUI,  KEYBOARD__UpArrow ) )
 
 
 // ----------------------------------------------------------------------------
@@ -326,78 +432,31 @@ void R(m_winUp)(void) {}
 // them if they're inconvenient
 
 KEYS__LAYER__PUSH_POP(0, 0);
-#define  keys__press__lpu0l0    P(lpupo0l0)
-#define  keys__release__lpu0l0  KF(nop)
-#define  keys__press__lpo0l0    R(lpupo0l0)
-#define  keys__release__lpo0l0  KF(nop)
-
 KEYS__LAYER__PUSH_POP(1, 1);
-#define  keys__press__lpu1l1    P(lpupo1l1)
-#define  keys__release__lpu1l1  KF(nop)
-#define  keys__press__lpo1l1    R(lpupo1l1)
-#define  keys__release__lpo1l1  KF(nop)
-
 KEYS__LAYER__PUSH_POP(2, 2);
-#define  keys__press__lpu2l2    P(lpupo2l2)
-#define  keys__release__lpu2l2  KF(nop)
-#define  keys__press__lpo2l2    R(lpupo2l2)
-#define  keys__release__lpo2l2  KF(nop)
-
 KEYS__LAYER__PUSH_POP(3, 3);
-#define  keys__press__lpu3l3    P(lpupo3l3)
-#define  keys__release__lpu3l3  KF(nop)
-#define  keys__press__lpo3l3    R(lpupo3l3)
-#define  keys__release__lpo3l3  KF(nop)
-
 KEYS__LAYER__PUSH_POP(4, 4);
-#define  keys__press__lpu4l4    P(lpupo4l4)
-#define  keys__release__lpu4l4  KF(nop)
-#define  keys__press__lpo4l4    R(lpupo4l4)
-#define  keys__release__lpo4l4  KF(nop)
-
 KEYS__LAYER__PUSH_POP(5, 5);
-#define  keys__press__lpu5l5    P(lpupo5l5)
-#define  keys__release__lpu5l5  KF(nop)
-#define  keys__press__lpo5l5    R(lpupo5l5)
-#define  keys__release__lpo5l5  KF(nop)
-
 KEYS__LAYER__PUSH_POP(6, 6);
-#define  keys__press__lpu6l6    P(lpupo6l6)
-#define  keys__release__lpu6l6  KF(nop)
-#define  keys__press__lpo6l6    R(lpupo6l6)
-#define  keys__release__lpo6l6  KF(nop)
-
 KEYS__LAYER__PUSH_POP(7, 7);
-#define  keys__press__lpu7l7    P(lpupo7l7)
-#define  keys__release__lpu7l7  KF(nop)
-#define  keys__press__lpo7l7    R(lpupo7l7)
-#define  keys__release__lpo7l7  KF(nop)
-
 KEYS__LAYER__PUSH_POP(8, 8);
-#define  keys__press__lpu8l8    P(lpupo8l8)
-#define  keys__release__lpu8l8  KF(nop)
-#define  keys__press__lpo8l8    R(lpupo8l8)
-#define  keys__release__lpo8l8  KF(nop)
-
 KEYS__LAYER__PUSH_POP(9, 9);
-#define  keys__press__lpu9l9    P(lpupo9l9)
-#define  keys__release__lpu9l9  KF(nop)
-#define  keys__press__lpo9l9    R(lpupo9l9)
-#define  keys__release__lpo9l9  KF(nop)
 
 
 // ----------------------------------------------------------------------------
 
-/**                                       functions/KF(ctrlL2l1)/description
+/**                                          functions/KF(ctrlL2l1)/description
  * courtesty to Ben Blazak! http://geekhack.org/index.php?topic=45211.msg1033526#msg1033526
  * Double tapping the ctrl key assigned to this key code will switch to layer 1
  */
 // counts the number of times the ctrl key was hit
 uint8_t ctrl_key__counter = 0;
+// the pending counter reset (if any), so it can be restarted
+timer__event_t ctrl_key__reset = 0;
 
  // this happens 40 cycles ~= 200 milliseconds after ctrl key is released first time
  // resets the counter to prevent activating the layer after a longer period of time
-void KF(ctrlL2l1)(void){
+void KF(ctrlL2l1)(void * context){
 	ctrl_key__counter = 0;
 }
 
@@ -407,7 +466,8 @@ void P(ctrlL2l1)(void){
 	if (ctrl_key__counter == 1) { // ctrl key works on first press
 		KF(press)(KEYBOARD__LeftControl);
 	} else { // on any subsequent press within the scheduled cycles, the layer key is activated
-		P(lpupo1l1)();
+		layer_stack__push(0, 1, 1);
+		_flags.tick_keypresses = false;
 	}
 }
 
@@ -415,11 +475,28 @@ void P(ctrlL2l1)(void){
 void R(ctrlL2l1)(void){
 	if (ctrl_key__counter == 1) { // ctrl was hit just once, so release it
 		KF(release)(KEYBOARD__LeftControl);
-		timer__schedule_cycles(40, &KF(ctrlL2l1)); // start the timer; if ctrl not hit again within these cycles, the counter is reset
+		timer__cancel(ctrl_key__reset); // (an earlier reset would cut this one short)
+		ctrl_key__reset = timer__schedule_cycles(40, &KF(ctrlL2l1), NULL); // start the timer; if ctrl not hit again within these cycles, the counter is reset
 	} else { // ctrl key was hit more than once and was not released; release the layer key and reset the counter
-		R(lpupo1l1)();
+		layer_stack__pop_id(1);
+		_flags.tick_keypresses = false;
 		ctrl_key__counter = 0;
 	}
 }
+
+
+// ----------------------------------------------------------------------------
+
+/**                                  macros/KEYS__FUNCTIONS__COMMON/description
+ * The keys defined in this file that need functions of their own
+ *
+ * Meant to be included in the layout's `KEYS__FUNCTION_TABLE()` list.
+ */
+#define  KEYS__FUNCTIONS__COMMON(X)                                         \
+    X(shL2kcap) X(shR2kcap) X(btldr) X(typCncl)                             \
+    X(uniWin) X(uniMac) X(uniLin) X(ctrlL2l1)                               \
+    X(escCtrl) X(spaceL1)                                                   \
+    X(osShL) X(osCtrlL) X(osAltL) X(osGuiL) X(osL1) X(tdSemi)
+
 // ----------------------------------------------------------------------------
 #endif  // ERGODOX_FIRMWARE__KEYBOARD__ERGODOX__LAYOUT__COMMON__KEYS__C__H
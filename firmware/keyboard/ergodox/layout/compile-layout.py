@@ -0,0 +1,417 @@
+#! /usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+# Released under The MIT License (see "doc/licenses/MIT.md")
+# Project located at <https://github.com/benblazak/ergodox-firmware>
+# -----------------------------------------------------------------------------
+
+##                                                                  description
+# Compile a declarative layout ('<name>.layout') into the `_layout` table
+# included by '<name>.c'
+#
+# Usage:
+#
+#     compile-layout.py <name>.layout <name>.layout.c.h
+#
+# The '.layout' file format:
+# - `#` and `//` start comments, which run to the end of the line.
+# - `layer <number> [: <description>]` starts a layer.  Layers must be numbered
+#   in order, starting from 0.
+# - Everything else in a layer is key names (what goes inside `K()`),
+#   separated by whitespace and (optionally) commas, in the spatial order used
+#   by `MATRIX_LAYER()` in 'common/matrix.h' (left hand, then right hand; the
+#   `M` and `na` arguments are left out).
+# - `include <path>` reads another '.layout' file (relative to this one) in
+#   place.
+# - `define <name> <key>` replaces every later use of `<name>` with `<key>`
+#   (for templates).
+# - `pushes <key> <layer>` declares that `<key>` pushes `<layer>`, for keys
+#   whose definitions this script can't see through (only used when checking
+#   that every layer can be reached).
+#
+# Errors (which stop the build):
+# - A layer with the wrong number of keys
+# - A key name that isn't defined by '<name>.c' (or anything it includes)
+# - Layers that aren't numbered in order
+#
+# Warnings:
+# - Transparent keys on layer 0 (they do nothing, since there's nothing below
+#   layer 0 for them to be transparent to)
+# - Layers that no key on a reachable layer pushes (starting from layer 0)
+#
+# Notes:
+# - Positions in the matrix with no key (the `na` arguments of
+#   `MATRIX_LAYER()`) are filled with `nop`.  Positions that are `nop` or
+#   `transp` on every layer are listed in the cost report, since they take
+#   up space in `_layout` without doing anything.
+# - The SRAM in the cost report is only the arrays with an entry for every
+#   position (`[OPT__KB__ROWS][OPT__KB__COLUMNS]`), declared in the sources
+#   the layout includes or in '.../firmware/lib/layout'.  That's everything
+#   whose size depends on the matrix; fixed size state, and buffers sized by
+#   other options, aren't counted.
+# - Key names and layer pushes are found by scanning the C sources with
+#   regular expressions, not by running the preprocessor; so conditional
+#   compilation is ignored, and keys defined in unusual ways may need a
+#   `pushes` line.
+#
+
+
+import os
+import re
+import sys
+
+# -----------------------------------------------------------------------------
+
+ROWS    = 6
+COLUMNS = 14
+
+FIRMWARE = os.path.normpath( os.path.join( os.path.dirname(__file__),
+                                           '..', '..', '..' ) )
+# the '.../firmware' directory
+
+SIZES = { 'bool': 1, 'char': 1, 'int8_t': 1, 'uint8_t': 1,
+          'int16_t': 2, 'uint16_t': 2, 'int32_t': 4, 'uint32_t': 4 }
+# the size (in bytes, on the AVR) of each type we count SRAM arrays of
+
+_comment_re = re.compile(
+    r'("(?:\\.|[^"\\\n])*"|\'(?:\\.|[^\'\\\n])*\')|/\*.*?\*/|//[^\n]*',
+    re.DOTALL )
+
+
+class LayoutError(Exception):
+    pass
+
+# -----------------------------------------------------------------------------
+# reading C sources
+# -----------------------------------------------------------------------------
+
+def read_sources(path, seen=None):
+    """Return the text of `path` and every file it `#include`s with quotes
+    (comments removed, continued lines joined), skipping missing files"""
+    if seen is None:
+        seen = set()
+    path = os.path.normpath(path)
+    if path in seen or not os.path.isfile(path):
+        return ''
+    seen.add(path)
+
+    with open(path) as f:
+        text = f.read()
+    text = _comment_re.sub(lambda m: m.group(1) or ' ', text)
+    text = text.replace('\\\n', ' ')
+
+    out = [text]
+    for name in re.findall(r'^\s*#\s*include\s*"([^"]+)"', text, re.M):
+        out.append( read_sources( os.path.join(os.path.dirname(path), name),
+                                  seen ) )
+    return '\n'.join(out)
+
+
+def read_position_arrays(paths):
+    """Return `(bytes, name, path)` for each array in SRAM with an entry for
+    every position, declared in one of `paths`"""
+    array_re = re.compile(
+        r'(?:^|(?<=[;{}]))\s*((?:\w+\s+)*?)(%s)\s+(\w+)\s*'
+        r'\[\s*OPT__KB__ROWS\s*\]\s*\[\s*OPT__KB__COLUMNS\s*\]\s*;'
+        % '|'.join(SIZES) )
+    arrays = []
+    for path in sorted(paths):
+        with open(path) as f:
+            text = _comment_re.sub(lambda m: m.group(1) or ' ', f.read())
+        for m in array_re.finditer(text):
+            qualifiers = m.group(1).split()
+            if 'extern' in qualifiers or 'const' in qualifiers:
+                continue
+            arrays.append( ( SIZES[m.group(2)] * ROWS * COLUMNS,
+                             m.group(3),
+                             os.path.relpath(path, FIRMWARE) ) )
+    return arrays
+
+
+def balanced(text, start):
+    """Return the text between the bracket at `text[start]` and its match"""
+    open_, close = text[start], {'(': ')', '{': '}'}[text[start]]
+    depth = 0
+    for i in range(start, len(text)):
+        if text[i] == open_:
+            depth += 1
+        elif text[i] == close:
+            depth -= 1
+            if not depth:
+                return text[start+1:i]
+    return text[start+1:]
+
+
+def read_matrix(text):
+    """Return the name of the `MATRIX_LAYER()` argument for unused positions,
+    the matrix positions (as `(row, column)`) of the other arguments (in
+    order), and the matrix positions that are unused"""
+    m = re.search(r'#\s*define\s+MATRIX_LAYER\s*\(', text)
+    if not m:
+        raise LayoutError('`MATRIX_LAYER()` not found')
+    params = [ p.strip() for p in balanced(text, m.end()-1).split(',') ]
+    body = text[ m.end() + len(balanced(text, m.end()-1)) + 1 : ]
+    body = body[ : body.index('\n#') if '\n#' in body else len(body) ]
+
+    rows = [ re.findall(r'M\(\s*(\w+)\s*\)', row)
+             for row in re.findall(r'\{([^{}]*)\}', body) ]
+    where = {}
+    for r, row in enumerate(rows):
+        for c, name in enumerate(row):
+            where.setdefault(name, []).append( (r, c) )
+
+    if len(rows) != ROWS or any( len(row) != COLUMNS for row in rows ):
+        raise LayoutError('`MATRIX_LAYER()` is not %d x %d' % (ROWS, COLUMNS))
+
+    return params[1], [ where[p][0] for p in params[2:] ], where[params[1]]
+
+
+def read_keys(text):
+    """Return the set of key names defined, and a dict mapping key names to
+    the layers they push"""
+    keys   = set( re.findall(r'\benum\s*\{\s*keys__(\w+)', text) )
+    pushes = {}
+
+    keys |= set( re.findall( r'\bKEYS__(?:DEFAULT|SHIFTED)\(\s*(\w+)\s*,',
+                             text ) )
+
+    for id_, layer in re.findall(
+            r'\bKEYS__LAYER__PUSH_POP\(\s*(\d+)\s*,\s*(\d+)\s*\)', text ):
+        for op in ('lpupo', 'lpu', 'lpo'):
+            keys.add( '%s%sl%s' % (op, id_, layer) )
+        for op in ('lpupo', 'lpu'):
+            pushes.setdefault( '%s%sl%s' % (op, id_, layer), set() ) \
+                  .add( int(layer) )
+
+    # keys listed in the function and macro tables
+    lists = {}
+    for m in re.finditer(r'#\s*define\s+(\w+)\s*\(\s*X\s*\)(.*)', text):
+        lists[m.group(1)] = m.group(2)
+
+    def names(list_, seen):
+        if list_ in seen or list_ not in lists:
+            return set()
+        seen.add(list_)
+        out = set( re.findall(r'\bX\(\s*(\w+)', lists[list_]) )
+        for inner in re.findall(r'\b(\w+)\(\s*X\s*\)', lists[list_]):
+            out |= names(inner, seen)
+        return out
+
+    for list_ in re.findall(
+            r'\bKEYS__(?:FUNCTION|MACRO)_TABLE\(\s*(\w+)\s*\)', text ):
+        keys |= names(list_, set())
+
+    # layer pushes hidden in key definitions
+    for m in re.finditer(
+            r'\bKEYS__LAYER__NUM_(PUSH|PU_PO)\(\s*\w+\s*,\s*(\d+)\s*\)',
+            text ):
+        name = 'numPush' if m.group(1) == 'PUSH' else 'numPuPo'
+        pushes.setdefault(name, set()).add( int(m.group(2)) )
+
+    for m in re.finditer(
+            r'\bKEYS__(?:DUAL_ROLE|ONE_SHOT|TAP_DANCE)\(\s*(\w+)\s*,', text ):
+        args = balanced(text, text.index('(', m.start()))
+        for layer in re.findall(
+                r'_ACTION__LAYER\(\s*_ACTION__LAYER__PUSH(?:_POP)?\s*,'
+                r'\s*\w+\s*,\s*(\d+)\s*\)', args ):
+            pushes.setdefault(m.group(1), set()).add( int(layer) )
+
+    for m in re.finditer(r'\bP\(\s*(\w+)\s*\)\s*\(\s*void\s*\)\s*\{', text):
+        body = balanced(text, m.end()-1)
+        for layer in re.findall(
+                r'\blayer_stack__push\([^,()]*,[^,()]*,\s*(\d+)\s*\)', body ):
+            pushes.setdefault(m.group(1), set()).add( int(layer) )
+
+    return keys, pushes
+
+# -----------------------------------------------------------------------------
+# reading '.layout' files
+# -----------------------------------------------------------------------------
+
+def read_layout(path, state=None):
+    """Return a list of `(number, description, [(key, file, line), ...])` for
+    the layers in `path`, and a dict of declared layer pushes"""
+    if state is None:
+        state = { 'layers': [], 'defines': {}, 'pushes': {}, 'files': [] }
+    if path in state['files']:
+        raise LayoutError('%s: included recursively' % path)
+    state['files'].append(path)
+
+    with open(path) as f:
+        lines = f.readlines()
+
+    for number, line in enumerate(lines, 1):
+        where = '%s:%d' % (path, number)
+        line  = re.sub(r'(#|//).*', '', line).strip()
+        words = line.split()
+        if not words:
+            continue
+
+        if words[0] == 'include' and len(words) == 2:
+            read_layout( os.path.join( os.path.dirname(path),
+                                       words[1].strip('"') ),
+                         state )
+        elif words[0] == 'define' and len(words) == 3:
+            state['defines'][words[1]] = words[2]
+        elif words[0] == 'pushes' and len(words) == 3:
+            state['pushes'].setdefault(words[1], set()).add( int(words[2]) )
+        elif words[0] == 'layer':
+            m = re.match(r'layer\s+(\d+)\s*(?::\s*(.*))?$', line)
+            if not m:
+                raise LayoutError('%s: bad layer header' % where)
+            if int(m.group(1)) != len(state['layers']):
+                raise LayoutError( '%s: expected layer %d'
+                                   % (where, len(state['layers'])) )
+            state['layers'].append( (int(m.group(1)), m.group(2) or '', []) )
+        else:
+            if not state['layers']:
+                raise LayoutError('%s: keys before the first layer' % where)
+            for key in re.split(r'[\s,]+', line):
+                if key:
+                    key = state['defines'].get(key, key)
+                    state['layers'][-1][2].append( (key, path, number) )
+
+    state['files'].pop()
+    return state['layers'], state['pushes']
+
+# -----------------------------------------------------------------------------
+
+def compile_layout(layout_path, output_path):
+    c_path  = re.sub(r'\.layout$', '.c', layout_path)
+    sources = set()
+    text    = read_sources(c_path, sources)
+
+    na, positions, unused = read_matrix(text)
+    keys, pushes = read_keys(text)
+    layers, declared = read_layout(layout_path)
+    for key, layer in declared.items():
+        pushes.setdefault(key, set()).update(layer)
+
+    if not layers:
+        raise LayoutError('%s: no layers' % layout_path)
+
+    # --- errors ---
+
+    errors = []
+    for number, _, entries in layers:
+        if len(entries) != len(positions):
+            where = ( '%s:%d' % entries[-1][1:] if entries
+                      else layout_path )
+            errors.append( '%s: layer %d has %d keys (expected %d)'
+                           % (where, number, len(entries), len(positions)) )
+        for key, path, line in entries:
+            if key not in keys:
+                errors.append( '%s:%d: unknown key `%s`'
+                               % (path, line, key) )
+    if errors:
+        raise LayoutError('\n'.join(errors))
+
+    # --- warnings ---
+
+    warnings = []
+    for key, path, line in layers[0][2]:
+        if key == 'transp':
+            warnings.append( '%s:%d: transparent key on layer 0'
+                             % (path, line) )
+
+    reachable, todo = set(), [0]
+    while todo:
+        layer = todo.pop()
+        if layer in reachable or layer >= len(layers):
+            continue
+        reachable.add(layer)
+        for key, _, _ in layers[layer][2]:
+            todo.extend( pushes.get(key, ()) )
+    for number, _, entries in layers:
+        if number not in reachable:
+            warnings.append( '%s:%d: layer %d is never pushed'
+                             % (entries[0][1:] + (number,)) )
+
+    # --- the table ---
+
+    table = [ [ [ 'nop' ] * COLUMNS for _ in range(ROWS) ]
+              for _ in layers ]
+    for number, _, entries in layers:
+        for (row, column), (key, _, _) in zip(positions, entries):
+            table[number][row][column] = key
+
+    width = max( len(key) for layer in table for row in layer for key in row )
+    out = [ '// generated by "compile-layout.py" from "%s"; do not edit'
+                % os.path.basename(layout_path),
+            '',
+            'static _layout_t _layout = {',
+            '' ]
+    for number, description, _ in layers:
+        out.append( '    // layer %d%s'
+                    % (number, ' : ' + description if description else '') )
+        out.append( '    {' )
+        for row in table[number]:
+            cells = [ ('K(%s),' % key).ljust(width+4) for key in row ]
+            half  = COLUMNS // 2
+            out.append( '        { ' + ' '.join(cells[:half]).rstrip() )
+            out.append( '          ' + ' '.join(cells[half:]).rstrip()
+                        + ' },' )
+        out.append( '    },' )
+        out.append( '' )
+    out.append( '};' )
+
+    with open(output_path, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+    # --- the report ---
+
+    idle = [ position for position in positions
+             if all( table[n][position[0]][position[1]] in ('nop', 'transp')
+                     for n in range(len(layers)) ) ]
+    flash = len(layers) * ROWS * COLUMNS * 2
+
+    report = [ '%s: %d layers' % (os.path.basename(layout_path),
+                                  len(layers)) ]
+    report.append( '    flash: `_layout` = %d x %d x %d x 2 = %d bytes'
+                   % (len(layers), ROWS, COLUMNS, flash) )
+    report.append( '        %d bytes for positions with no key (`%s`)'
+                   % (len(unused) * len(layers) * 2, na) )
+    report.append( '        %d bytes for positions that do nothing on any'
+                   ' layer%s'
+                   % ( len(idle) * len(layers) * 2,
+                       ': ' + ' '.join( 'k%X%X' % p for p in idle )
+                       if idle else '' ) )
+    for number, description, entries in layers:
+        report.append( '        layer %d: %2d keys, %2d transparent'
+                       % ( number,
+                           sum( key not in ('nop', 'transp')
+                                for key, _, _ in entries ),
+                           sum( key == 'transp' for key, _, _ in entries ) ) )
+    for directory, _, names in os.walk(os.path.join(FIRMWARE, 'lib/layout')):
+        sources.update( os.path.join(directory, name) for name in names
+                        if name.endswith('.c') )
+    arrays = read_position_arrays(sources)
+    report.append( '    ram: %d bytes in per-position arrays (a partial'
+                   ' figure; see the notes in "%s")'
+                   % ( sum(size for size, _, _ in arrays),
+                       os.path.basename(__file__) ) )
+    for size, name, path in arrays:
+        report.append( '        %d bytes: `%s` (in "%s")'
+                       % (size, name, path) )
+
+    return warnings, report
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('usage: %s <name>.layout <output>\n' % argv[0])
+        return 2
+    try:
+        warnings, report = compile_layout(argv[1], argv[2])
+    except LayoutError as e:
+        sys.stderr.write('error: %s\n' % str(e).replace('\n', '\nerror: '))
+        return 1
+    for warning in warnings:
+        sys.stderr.write('warning: %s\n' % warning)
+    print('\n'.join(report))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
+
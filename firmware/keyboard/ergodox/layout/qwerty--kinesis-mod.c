@@ -11,39 +11,6 @@
  */
 
 
-#define  T_q        q
-#define  T_w        w
-#define  T_e        e
-#define  T_r        r
-#define  T_t        t
-#define  T_a        a
-#define  T_s        s
-#define  T_d        d
-#define  T_f        f
-#define  T_g        g
-#define  T_z        z
-#define  T_x        x
-#define  T_c        c
-#define  T_v        v
-#define  T_b        b
-
-#define  T_y        y
-#define  T_u        u
-#define  T_i        i
-#define  T_o        o
-#define  T_p        p
-#define  T_h        h
-#define  T_j        j
-#define  T_k        k
-#define  T_l        l
-#define  T_semicol  semicol
-#define  T_quote    quote
-#define  T_n        n
-#define  T_m        m
-#define  T_comma    comma
-#define  T_period   period
-#define  T_slash    slash
-
-
 #include "./templates/kinesis-mod.c.h"
+#include "./qwerty--kinesis-mod.layout.c.h"
 
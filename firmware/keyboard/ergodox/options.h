@@ -25,6 +25,9 @@
 #define  OPT__DEBOUNCE_TIME  5
 // in milliseconds
 
+#define  OPT__SUSPEND_SCAN_INTERVAL  50
+// in milliseconds; how often to scan while the host is suspended
+
 
 // ----------------------------------------------------------------------------
 // firmware/keyboard/controller
@@ -86,12 +89,77 @@
 #define  OPT__USB__VENDOR_ID         0x1d50  // Openmoko, Inc.
 #define  OPT__USB__PRODUCT_ID        0x6028  // ErgoDox Ergonomic Keyboard
 
+#define  OPT__USB__POLLING_INTERVAL  1
+// in milliseconds (full speed frames); 1 is the fastest the host will poll
+
+#define  OPT__USB__REPORT_QUEUE_SIZE  8
+// the number of keyboard reports that can be waiting to be sent; 1..255
+
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
+#define  OPT__EEPROM__WRITE_QUEUE_SIZE  32
+// the number of EEPROM writes (and copies) that can be waiting to be
+// performed; each takes 3 bytes of SRAM; 1..255
+
+#define  OPT__EEPROM__COPY_QUEUE_SIZE  4
+// the number of EEPROM copies that can be waiting to be performed; each takes
+// 2 more bytes of SRAM; 1..255
+
 #define  OPT__EEPROM_MACRO__EEPROM_SIZE  1024
 
+#define  OPT__EEPROM_MACRO__REMAP_SIZE  16
+// one more than the number of (layer, position) pairs that can be remapped at
+// runtime (one is kept free); each takes 5 bytes of EEPROM and 6 bytes of
+// SRAM; 2..254
+
+#define  OPT__EEPROM_MACRO__RECORD_SIZE  128
+// the number of bytes a recorded macro's keystrokes can take, once encoded (a
+// tap usually takes 1); each takes 1 byte of SRAM; 2..248
+
+#define  OPT__EEPROM_MACRO__INDEX_SIZE  32
+// the number of recorded macros that can exist at once; each takes 5 bytes of
+// SRAM; 1..254
+
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define  OPT__KEY_FUNCTIONS__TAPPING_TERM  200
+// in milliseconds; how long a dual-role key must be held to count as "held"
+
+#define  OPT__KEY_FUNCTIONS__COMBO_TERM  50
+// in milliseconds; how long to wait for the rest of a combo
+
+#define  OPT__KEY_FUNCTIONS__ONE_SHOT_TIMEOUT  3000
+// in milliseconds; how long a tapped one-shot key waits for the next key
+// (`0` = forever)
+#define  OPT__KEY_FUNCTIONS__ONE_SHOT_LOCK  1
+// whether tapping a one-shot key twice locks it (`1`) or cancels it (`0`)
+
+#define  OPT__KEY_FUNCTIONS__LEADER_TIMEOUT  1000
+// in milliseconds; how long to wait for the next key of a leader sequence
+
+#define  OPT__KEY_FUNCTIONS__TAP_DANCE_TERM  200
+// in milliseconds; how long to wait for a tap-dance key to be tapped again
+
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define  OPT__LAYER_STACK__SIZE  16
+// the maximum number of elements in the layer-stack ('array' implementation
+// only); 0 to grow and shrink it with `realloc()` instead
+
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+#define  OPT__TIMER__EVENTS  16
+// the number of events that can be scheduled at once (by all the timers
+// together); 1..254
+
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
@@ -31,6 +31,10 @@ KEYBOARD_LAYOUTS := \
 	qwerty--kinesis-mod
 # a list of all available layouts for this keyboard
 
+LAYER_STACK := array
+# the layer-stack implementation to use ('array' or 'bitmask'; see
+# '.../firmware/lib/layout/layer-stack/options.mk')
+
 # -----------------------------------------------------------------------------
 
 $(call include_options_once,lib/eeprom)
@@ -51,3 +55,29 @@ $(CURDIR)/layout/qwerty-kinesis-mod.o: $(wildcard $(CURDIR)/layout/common/*)
 $(CURDIR)/layout/dvorak-kinesis-mod.o: $(wildcard $(CURDIR)/layout/common/*)
 $(CURDIR)/layout/colemak-symbol-mod.o: $(wildcard $(CURDIR)/layout/common/*)
 
+# -----------------------------------------------------------------------------
+
+LAYOUT_COMPILER := $(CURDIR)/layout/compile-layout.py
+# compiles '<layout>.layout' into '<layout>.layout.c.h' (the `_layout` table
+# included by '<layout>.c'), checking it, and printing what it costs
+
+.PHONY: layouts
+layouts: $(KEYBOARD_LAYOUTS:%=$(CURDIR)/layout/%.layout.c.h)
+# compile (and check) every layout, not just the one being built
+
+all: layouts
+
+$(CURDIR)/layout/%.layout.c.h: \
+		$(CURDIR)/layout/%.layout \
+		$(CURDIR)/layout/%.c \
+		$(LAYOUT_COMPILER) \
+		$(wildcard $(CURDIR)/layout/common/*) \
+		$(wildcard $(CURDIR)/layout/templates/*) \
+		$(wildcard $(ROOTDIR)/lib/layout/*/*.c)
+	@echo
+	@echo '--- making $@ ---'
+	python3 $(LAYOUT_COMPILER) $< $@
+
+$(CURDIR)/layout/$(KEYBOARD_LAYOUT).o: \
+		$(CURDIR)/layout/$(KEYBOARD_LAYOUT).layout.c.h
+
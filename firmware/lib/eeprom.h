@@ -19,7 +19,13 @@
  * - Writes generated by calls to `eeprom__write()` and `eeprom__copy()` should
  *   collectively execute in the order in which the calls were performed (i.e.
  *   all writes should be sequential, in the expected order, regardless of the
- *   function which generated them).
+ *   function which generated them).  The exceptions: a write that wouldn't
+ *   change anything (given the writes and copies already scheduled) may be
+ *   dropped; and a write to a location that already has a write scheduled
+ *   (with no copy scheduled since) may replace that write, taking its place
+ *   in the order.  So code that depends on the order of its writes (e.g. to
+ *   set a "valid" flag after the data it covers) should not write the same
+ *   location twice while the first write may still be pending.
  */
 
 
@@ -29,6 +35,7 @@
 // ----------------------------------------------------------------------------
 
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // ----------------------------------------------------------------------------
@@ -39,9 +46,10 @@
 
 // ----------------------------------------------------------------------------
 
-uint8_t eeprom__read  (uint8_t * from);
-uint8_t eeprom__write (uint8_t * to, uint8_t data);
-uint8_t eeprom__copy  (uint8_t * to, uint8_t * from, uint8_t length);
+uint8_t eeprom__read       (uint8_t * from);
+uint8_t eeprom__write      (uint8_t * to, uint8_t data);
+uint8_t eeprom__copy       (uint8_t * to, uint8_t * from, uint8_t length);
+bool    eeprom__is_writing (void);
 
 
 // ----------------------------------------------------------------------------
@@ -76,6 +84,17 @@ uint8_t eeprom__copy  (uint8_t * to, uint8_t * from, uint8_t length);
  *
  * Arguments:
  * - `from: The address of (i.e. a pointer to) the location to read from
+ *
+ * Notes:
+ * - The value returned should be the value the location will have once all
+ *   the writes (and copies) scheduled so far are done.
+ *
+ * Implementation notes:
+ * - EEPROMs generally can't be read while they're being written.  A location
+ *   that some scheduled write (or copy) will change can be answered from the
+ *   schedule, but reading any other location may busy wait until the byte
+ *   being written is done (on the ATMega32U4, up to 3.4 ms).  Code that can't
+ *   afford that should only read while `eeprom__is_writing()` is `false`.
  */
 
 // === eeprom__write() ===
@@ -88,7 +107,7 @@ uint8_t eeprom__copy  (uint8_t * to, uint8_t * from, uint8_t length);
  *
  * Returns:
  * - success: `0`
- * - failure: [other]
+ * - failure: [other] (e.g. if there's no room to schedule the write)
  *
  * Notes:
  * - Writes are scheduled (i.e. buffered) because writing to EEPROMs takes an
@@ -107,8 +126,8 @@ uint8_t eeprom__copy  (uint8_t * to, uint8_t * from, uint8_t length);
  *   operation to complete *much* more quickly in the event that the data has
  *   not changed.
  * - Writing `0xFF` should clear the memory (without writing anything), and
- *   writing to a location currently set to `0xFF` should write without
- *   clearing first.
+ *   writing data that only clears bits (e.g. to a location currently set to
+ *   `0xFF`) should write without clearing first.
  */
 
 // === eeprom__copy() ===
@@ -123,7 +142,7 @@ uint8_t eeprom__copy  (uint8_t * to, uint8_t * from, uint8_t length);
  *
  * Returns:
  * - success: `0`
- * - failure: [other]
+ * - failure: [other] (e.g. if there's no room to schedule the copy)
  *
  *
  * Implementation notes:
@@ -139,3 +158,15 @@ uint8_t eeprom__copy  (uint8_t * to, uint8_t * from, uint8_t length);
  *   (`to`..`to+length-1`) is invalid.
  */
 
+// === eeprom__is_writing() ===
+/**                                    functions/eeprom__is_writing/description
+ * Predicate indicating whether any writes (or copies) are waiting to be
+ * performed, or are being performed
+ *
+ * Notes:
+ * - While this is `false`, `eeprom__read()` won't busy wait.
+ * - This is for code that needs to schedule a group of writes all at once (so
+ *   it can wait for the queue to be empty, and be sure there's room), or that
+ *   needs to be sure its writes won't be merged with ones scheduled earlier
+ *   (see the implementation notes at the top of this file).
+ */
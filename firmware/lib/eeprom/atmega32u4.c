@@ -6,29 +6,61 @@
 
 /**                                                                 description
  * Implements the EEPROM interface defined in "../eeprom.h" for the ATMega32U4
+ *
+ * Queued writes are performed by the "EEPROM ready" interrupt, which is
+ * enabled whenever there's something in the queue: each time a byte finishes
+ * being written, the interrupt starts the next one.  So writes go as fast as
+ * the EEPROM allows, no matter how often the main loop runs.
+ *
+ * The rest of this file only ever touches the queues (or the EEPROM) with
+ * that interrupt disabled; other interrupts are left alone.
+ *
+ * The EEPROM can't be read while a byte is being written, so a read of a byte
+ * that nothing queued changes may have to wait for the byte in progress (but
+ * not for the rest of the queue).  Reads of bytes a queued write will change,
+ * and of the byte in progress, are answered from SRAM.  Code that can't afford
+ * to wait should only read while `eeprom__is_writing()` is `false`.
+ *
+ * The queues are fixed size ring buffers.  Before a write is queued, we work
+ * out what the byte will be once everything already queued is done: if
+ * that's what we're writing, the write is dropped; and if the last thing
+ * queued for the byte is another write, that write is changed instead of a
+ * new one being added.  So a byte that's written over and over (like a
+ * setting being changed) only gets written once, or not at all.
  */
 
 
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdlib.h>
-#include <util/atomic.h>
+#include <avr/interrupt.h>
 #include <avr/io.h>
-#include "../../../firmware/lib/timer.h"
 #include "../eeprom.h"
 
 // ----------------------------------------------------------------------------
 // macros ---------------------------------------------------------------------
 
-/**                                               macros/MIN_UNUSED/description
- * The minimum number of elements to have unused after a resize (in any queue)
+#ifndef OPT__EEPROM__WRITE_QUEUE_SIZE
+    #error "OPT__EEPROM__WRITE_QUEUE_SIZE not defined"
+#endif
+#ifndef OPT__EEPROM__COPY_QUEUE_SIZE
+    #error "OPT__EEPROM__COPY_QUEUE_SIZE not defined"
+#endif
+
+/**                            macros/OPT__EEPROM__WRITE_QUEUE_SIZE/description
+ * The number of writes (and copies) that can be waiting to be performed
+ *
+ * Notes:
+ * - Each takes 3 bytes of SRAM.
+ * - Must be between 1 and 255, inclusive.
  */
-#define  MIN_UNUSED  0
 
-/**                                               macros/MAX_UNUSED/description
- * The maximum number of elements to have unused after a resize (in any queue)
+/**                             macros/OPT__EEPROM__COPY_QUEUE_SIZE/description
+ * The number of copies that can be waiting to be performed
+ *
+ * Notes:
+ * - Each takes 2 bytes of SRAM (in addition to its place in the write queue).
+ * - Must be between 1 and 255, inclusive.
  */
-#define  MAX_UNUSED  4
 
 /**                                            macros/(enum) action/description
  * Valid values for `write_t.action`, determining the type of action to perform
@@ -43,6 +75,12 @@ enum action {
     ACTION_COPY,
 };
 
+/**                                                       macros/AT/description
+ * The element `offset` elements from the front of the given queue
+ */
+#define  AT(queue, size, offset)  \
+    ( (queue).data[ ( (queue).head + (offset) ) % (size) ] )
+
 // ----------------------------------------------------------------------------
 // types ----------------------------------------------------------------------
 
@@ -80,180 +118,43 @@ typedef struct {
 // ----------------------------------------------------------------------------
 // variables ------------------------------------------------------------------
 
-/**                                                variables/status/description
- * Flags for keeping track of the status of these functions (since write
- * operations will be buffered)
- *
- * Members:
- * - `writing`: Indicates that writes are queued and/or being performed
- *     - If this is `true`, `write_queued()` is either running or scheduled to
- *       run, and should not be rescheduled by any function other than itself.
- *     - If this is `false`, no writes are queued or being performed, and
- *       `write_queued()` must be scheduled to run externally before writes
- *       will commence.
- */
-struct {
-    bool writing : 1;
-} status;
-
 /**                                        variables/(group) queues/description
  * Members:
- * - `to_write`: To hold the write queue, and related metadata
- * - `to_copy`: To hold the extra data needed for copies, along with related
- *   metadata
+ * - `to_write`: To hold the write queue
+ * - `to_copy`: To hold the extra data needed for copies
  *
  * Struct members:
- * - `allocated`: The number of positions allocated
- * - `unused_front`: The number of unused positions at the beginning of the
- *   queue
- * - `unused_back`: The number of unused positions at the end of the queue
+ * - `head`: The index of the first element
+ * - `length`: The number of elements
  * - `to_write.data`: A queue of writes (and copies) to perform
  * - `to_copy.data`: A queue of extra information for each `action ==
- *   ACTION_COPY` element in `to_write`
- *
- * Implementation notes:
- * - `unused_front` and `unused_back` each have a range of between -8 and 7,
- *   inclusive.  This means that, with the current scheme, `MAX_UNUSED` must
- *   not be greater than 7.  Note that negative values for either only make
- *   sense temporarily, when adding an element to the queue.
+ *   ACTION_COPY` element in `to_write` (in the same order)
  */
 static struct {
-    uint8_t   allocated;
-    int8_t    unused_front : 4;
-    int8_t    unused_back  : 4;
-    write_t * data;
+    uint8_t head;
+    uint8_t length;
+    write_t data[OPT__EEPROM__WRITE_QUEUE_SIZE];
 } to_write;
 static struct {
-    uint8_t  allocated;
-    int8_t   unused_front : 4;
-    int8_t   unused_back  : 4;
-    copy_t * data;
+    uint8_t head;
+    uint8_t length;
+    copy_t  data[OPT__EEPROM__COPY_QUEUE_SIZE];
 } to_copy;
 
-// ----------------------------------------------------------------------------
-// variable manipulator functions ---------------------------------------------
-
-/**                                        functions/(group) resize/description
- * Resize the appropriate queue, so that the number of unused elements is
- * between `MIN_UNUSED` and `MAX_UNUSED`, inclusive
- *
- * Returns:
- * - success: `0`
- * - failure: [other]
- *
- * Notes:
- * - These functions are separate (though identical in source, before macro
- *   expansion) partly because this allows us to deal with elements of the
- *   queue as discrete blocks of memory.  It might not be hard to make the
- *   function generic, but then we would loose the ability to depend on type
- *   information, and have to operate on each `queue.data` solely as an array
- *   of bytes.  It's a close call, but I feel like the conceptual clarity we
- *   gain with this method outweighs the clarity we would gain by having only a
- *   single function, with no copy+pasted code.
+/**                                               variables/writing/description
+ * The byte being written (if `EEPE` is set), as last passed to `write()`
  *
- * Implementation notes:
- * - We use a signed type for `unused` in case `unused_front + unused_back`
- *   turns out to be negative, as may happen when adding a new element to the
- *   queue.
- * - The only time `realloc()` should fail is if we are trying to grow the
- *   queue.  See [the documentation]
- *   (http://www.nongnu.org/avr-libc/user-manual/malloc.html)
- *   for `malloc()` in avr-libc.
+ * Struct members:
+ * - `to`: The address being written to
+ * - `data`: The data being written
  */
-static uint8_t resize_to_write(void) {
-    #define  queue            to_write
-    #define  queue_type_size  (sizeof(write_t))
-
-    int8_t unused = queue.unused_front + queue.unused_back;
-
-    if (MIN_UNUSED <= queue.unused_back && unused <= MAX_UNUSED)
-        return 0;  // no need to grow, shrink, or shift the queue
-
-    // shift down (if necessary), and update metadata
-    // - start with the first used element, and copy it down to index 0
-    // - copy the second used element down to index 1, and so on until we copy
-    //   the last used element
-    // - if there are no empty elements at the front of the queue, this will do
-    //   nothing
-    if (queue.unused_front != 0) {
-        for (uint8_t i = queue.unused_front; i < queue.allocated - unused; i++)
-            queue.data[i-queue.unused_front] = queue.data[i];
-
-        queue.unused_front = 0;
-        queue.unused_back = unused;
-
-        if (MIN_UNUSED <= unused && unused <= MAX_UNUSED)
-            return 0;  // no need to grow or shrink the queue
-    }
-
-    uint8_t new_allocated;
-    if (UINT8_MAX >= queue.allocated - unused + (MIN_UNUSED+MAX_UNUSED)/2)
-        new_allocated = queue.allocated - unused + (MIN_UNUSED+MAX_UNUSED)/2;
-    else if (UINT8_MAX >= queue.allocated - unused + MIN_UNUSED)
-        new_allocated = UINT8_MAX;
-    else
-        return 1;  // unable to count the required number of elements
-
-    void * new_data = realloc( queue.data, queue_type_size * new_allocated );
-    if (!new_data)
-        return 1;  // error: `realloc()` failed (unable to grow queue)
-
-    queue.unused_back += new_allocated - queue.allocated;
-    queue.allocated = new_allocated;
-    queue.data = new_data;
-
-    return 0;  // success: queue reallocated
-
-    #undef  queue
-    #undef  queue_type_size
-}
-static uint8_t resize_to_copy(void) {
-    #define  queue            to_copy
-    #define  queue_type_size  (sizeof(copy_t))
-
-    int8_t unused = queue.unused_front + queue.unused_back;
-
-    if (MIN_UNUSED <= queue.unused_back && unused <= MAX_UNUSED)
-        return 0;  // no need to grow, shrink, or shift the queue
-
-    // shift down (if necessary), and update metadata
-    // - start with the first used element, and copy it down to index 0
-    // - copy the second used element down to index 1, and so on until we copy
-    //   the last used element
-    // - if there are no empty elements at the front of the queue, this will do
-    //   nothing
-    if (queue.unused_front != 0) {
-        for (uint8_t i = queue.unused_front; i < queue.allocated - unused; i++)
-            queue.data[i-queue.unused_front] = queue.data[i];
-
-        queue.unused_front = 0;
-        queue.unused_back = unused;
-
-        if (MIN_UNUSED <= unused && unused <= MAX_UNUSED)
-            return 0;  // no need to grow or shrink the queue
-    }
-
-    uint8_t new_allocated;
-    if (UINT8_MAX >= queue.allocated - unused + (MIN_UNUSED+MAX_UNUSED)/2)
-        new_allocated = queue.allocated - unused + (MIN_UNUSED+MAX_UNUSED)/2;
-    else if (UINT8_MAX >= queue.allocated - unused + MIN_UNUSED)
-        new_allocated = UINT8_MAX;
-    else
-        return 1;  // unable to count the required number of elements
-
-    void * new_data = realloc( queue.data, queue_type_size * new_allocated );
-    if (!new_data)
-        return 1;  // error: `realloc()` failed (unable to grow queue)
-
-    queue.unused_back += new_allocated - queue.allocated;
-    queue.allocated = new_allocated;
-    queue.data = new_data;
-
-    return 0;  // success: queue reallocated
+static struct {
+    uint16_t to;
+    uint8_t  data;
+} writing;
 
-    #undef  queue
-    #undef  queue_type_size
-}
+// ----------------------------------------------------------------------------
+// variable manipulator functions ---------------------------------------------
 
 /**                                           functions/(group) pop/description
  * Remove the first element from the appropriate queue
@@ -263,40 +164,108 @@ static uint8_t resize_to_copy(void) {
  * - `pop_to_copy`: operates on the `to_copy` queue
  */
 static void pop_to_write(void) {
-    to_write.unused_front++;
-    resize_to_write();
+    to_write.head = (to_write.head + 1) % OPT__EEPROM__WRITE_QUEUE_SIZE;
+    to_write.length--;
 }
 static void pop_to_copy(void) {
-    to_copy.unused_front++;
-    resize_to_copy();
+    to_copy.head = (to_copy.head + 1) % OPT__EEPROM__COPY_QUEUE_SIZE;
+    to_copy.length--;
 }
 
 // ----------------------------------------------------------------------------
 // back end functions ---------------------------------------------------------
 
+/**                                                  functions/read/description
+ * Read and return the data at `from` in the EEPROM memory space
+ *
+ * Implementation notes:
+ * - This function (and most of the comments) were taken more or less straight
+ *   from the data sheet, section 5.3
+ * - If a write is in progress when this function is called, this function will
+ *   busy wait until the write has been completed (up to 3.4 ms if a write has
+ *   just been started), unless `from` is the byte being written.
+ *
+ * Assumptions:
+ * - The address passed as `from` is valid.
+ * - The "EEPROM ready" interrupt is disabled, or we're in it.
+ */
+static uint8_t read(uint16_t from) {
+    if ( (EECR & (1<<EEPE)) && from == writing.to )
+        return writing.data;   // (that's what it will be)
+
+    while (EECR & (1<<EEPE));  // wait for previous write to complete
+    EEAR = from;               // set up address register
+    EECR |= (1<<EERE);         // start EEPROM read (then halt, 4 clock cycles)
+    return EEDR;               // return the value in the data register
+}
+
+/**                                            functions/read_after/description
+ * Return what the data at `from` will be once the first `end` elements of
+ * `to_write` have been performed
+ *
+ * Arguments:
+ * - `from`: The address in EEPROM memory space to read
+ * - `end`: The number of elements of `to_write` to take into account
+ * - `copies`: The number of those elements that are copies
+ *
+ * Notes:
+ * - If nothing queued changes `from`, this reads the EEPROM (and may busy
+ *   wait, as `read()` does); otherwise it doesn't touch the EEPROM at all,
+ *   except maybe to read the source of a copy.
+ * - A byte being copied is whatever the byte it's being copied from was just
+ *   before the copy, so that's what we look up (recursively).  Since copies
+ *   only go one way through memory, the bytes of a copy that have already
+ *   been performed (and removed from the front of the copy element) are
+ *   never sources for the bytes that remain.
+ *
+ * Assumptions:
+ * - The "EEPROM ready" interrupt is disabled.
+ */
+static uint8_t read_after(uint16_t from, uint8_t end, uint8_t copies) {
+    while (end) {
+        write_t * w = &AT(to_write, OPT__EEPROM__WRITE_QUEUE_SIZE, --end);
+
+        if (w->action == ACTION_WRITE) {
+            if (w->to == from)
+                return w->value;
+            continue;
+        }
+
+        copy_t * c = &AT(to_copy, OPT__EEPROM__COPY_QUEUE_SIZE, --copies);
+
+        // - if `w->to < c->from`, the bytes left are `to` .. `to+value-1`;
+        //   otherwise, they're `to-value+1` .. `to`
+        uint16_t distance = (w->to < c->from) ? from - w->to : w->to - from;
+        if (distance < w->value)
+            return read_after(c->from + (from - w->to), end, copies);
+    }
+
+    return read(from);
+}
+
 /**                                                 functions/write/description
- * Write `data` to `address` in EEPROM memory space as soon as possible
+ * Start writing `data` to `to` in EEPROM memory space
  *
  * Arguments:
  * - `to: The address of the location to write to
  * - `data`: The data to write
  *
- * Notes:
- * - This function is static (and `eeprom__write()`, the public function, is
- *   written below) because writes are really slow, and we're going to buffer
- *   them.
- *
  * Implementation notes:
  * - This function (and most of the comments) were taken more or less straight
  *   from the data sheet, section 5.3
- * - If another write is in progress when this function is called, this
- *   function will busy wait until the first write has been completed.  This
- *   may take quite some time (up to 3.4 ms if a write has just been started),
- *   so we must be careful about when this function is called.
  * - This function starts the write to the EEPROM, but returns long before it
- *   has been completed.
+ *   has been completed.  If nothing needs to be written, it returns without
+ *   starting anything (and the interrupt, still enabled, will run again right
+ *   away).
+ * - A "write only" operation can change bits from `1` to `0`, but not back,
+ *   and an "erase only" operation sets all the bits to `1`.  Each takes about
+ *   half as long as doing both (and only does half as much wear), so we only
+ *   do both when we have to.
  *
  * Assumptions:
+ * - We're in the "EEPROM ready" interrupt, so no write is in progress, and
+ *   interrupts are disabled (as they must be between setting `EEMPE` and
+ *   `EEPE`).
  * - The address passed as `to` is valid.
  * - Voltage will never fall below the specified minimum for the clock
  *   frequency being used.
@@ -304,9 +273,7 @@ static void pop_to_copy(void) {
  *   function is called.
  */
 static void write(uint16_t to, uint8_t data) {
-
-    // - if a write is in progress, this will also wait until it's finished
-    uint8_t old_data = eeprom__read( (uint8_t *) to );
+    uint8_t old_data = read(to);
 
     if (data == old_data) {
         // do nothing
@@ -315,8 +282,8 @@ static void write(uint16_t to, uint8_t data) {
         // erase only (1.8 ms)
         EECR &= ~(1<<EEPM1);  // clear
         EECR |=  (1<<EEPM0);  // set
-    } else if (old_data == 0xFF) {
-        // write only (1.8 ms)
+    } else if ((old_data & data) == data) {
+        // write only (1.8 ms) (only clearing bits)
         EECR |=  (1<<EEPM1);  // set
         EECR &= ~(1<<EEPM0);  // clear
     } else {
@@ -328,33 +295,29 @@ static void write(uint16_t to, uint8_t data) {
     EEAR = to;    // set up address register
     EEDR = data;  // set up data register
 
-    // - interrupts must be disabled between these two operations, or else
-    //   "EEPROM Master Programming Enable" may time out (since it's cleared by
-    //   hardware 4 clock cycles after being written to `1` by software)
-    ATOMIC_BLOCK(ATOMIC_FORCEON) {
-        EECR |= (1<<EEMPE);  // set "EEPROM Master Programming Enable" to `1`
-        EECR |= (1<<EEPE);   // start EEPROM write (then halt, 2 clock cycles)
-    }
+    writing.to   = to;
+    writing.data = data;
+
+    // - "EEPROM Master Programming Enable" is cleared by hardware 4 clock
+    //   cycles after being written to `1` by software, so nothing may come
+    //   between these two operations
+    EECR |= (1<<EEMPE);  // set "EEPROM Master Programming Enable" to `1`
+    EECR |= (1<<EEPE);   // start EEPROM write (then halt, 2 clock cycles)
 }
 
 /**                                          functions/write_queued/description
- * Write (or copy) the next byte of data as dictated by our queue(s), and
- * schedule the write of the next byte if necessary
+ * Write (or copy) the next byte of data as dictated by our queue(s), or stop
+ * the interrupt if there's nothing left to do
+ *
+ * Notes:
+ * - Only called from the "EEPROM ready" interrupt.
  */
 static void write_queued(void) {
-    #define  next_write     ( to_write.data[to_write.unused_front] )
-    #define  next_copy      ( to_copy.data[to_copy.unused_front] )
-    #define  length(queue)  ( queue.allocated       \
-                              - queue.unused_front  \
-                              - queue.unused_back )
-
-    // if there's nothing to write
-    // - checking for this here (instead of after writing) will cause this
-    //   function to be called an extra time before it stops rescheduling
-    //   itself; but it also allows us not to make assumptions about the state
-    //   of `to_write` when this function is called
-    if ( length(to_write) == 0 ) {
-        status.writing = 0;
+    #define  next_write  AT(to_write, OPT__EEPROM__WRITE_QUEUE_SIZE, 0)
+    #define  next_copy   AT(to_copy,  OPT__EEPROM__COPY_QUEUE_SIZE,  0)
+
+    if (to_write.length == 0) {
+        EECR &= ~(1<<EERIE);  // nothing to write: stop interrupting
         return;
     }
 
@@ -365,20 +328,18 @@ static void write_queued(void) {
         // prepare for the next
         pop_to_write();
 
-    } else if ( next_write.action == ACTION_COPY && length(to_copy) ) {
+    } else if ( next_write.action == ACTION_COPY && to_copy.length ) {
 
         // if we're done with the current copy
-        // - checking for this here requires an extra iteration between a copy
-        //   being finished and the next operation being started; but it also
-        //   allows us not to make assumptions about the state of `to_copy`
-        //   when this function is called
+        // - the interrupt will run again right away, for whatever's next
         if (next_write.value == 0) {
             pop_to_write();
             pop_to_copy();
+            return;
         }
 
         // copy 1 byte
-        write( next_write.to, eeprom__read( (uint8_t *) next_copy.from ) );
+        write( next_write.to, read(next_copy.from) );
         // prepare for the next
         if (next_write.to < next_copy.from) {
             ++(next_write.to);
@@ -394,19 +355,8 @@ static void write_queued(void) {
         pop_to_write();
     }
 
-    // - `(3.5/OPT__DEBOUNCE_TIME)+1` gives us the number of cycles we need to
-    //   wait until the next write, where `3.5` is the maximum number of
-    //   milliseconds an EEPROM write can take, and `OPT__DEBOUNCE_TIME` is the
-    //   minimum number of milliseconds a scan can take.  Note that if the
-    //   division produces an integer (other than by truncation), the `+1` is
-    //   strictly unnecessary, since no truncation will be performed; but if
-    //   we're that close to needing to wait an extra cycle we may as well wait
-    //   anyway, just to be safe.
-    timer__schedule_cycles( (3.5/OPT__DEBOUNCE_TIME)+1, &write_queued );
-
     #undef  next_write
     #undef  next_copy
-    #undef  length
 }
 
 // ----------------------------------------------------------------------------
@@ -414,72 +364,109 @@ static void write_queued(void) {
 
 /**                                          functions/eeprom__read/description
  * Implementation notes:
- * - This function (and most of the comments) were taken more or less straight
- *   from the data sheet, section 5.3
- * - If a write is in progress when this function is called, this function will
- *   busy wait until the write has been completed.  This may take quite some
- *   time (up to 3.4 ms if a write has just been started), so you should be
- *   careful about when this function is called.
+ * - Reads see queued writes (and copies) as if they'd already been performed.
+ * - If the byte isn't changed by anything queued, and another byte is being
+ *   written when this function is called, this function will busy wait until
+ *   that byte has been written (up to 3.4 ms), but not for the rest of the
+ *   queue: the interrupt is held off while we read.  The hardware doesn't
+ *   allow reads during a write, and keeping a copy of the whole EEPROM in
+ *   SRAM to avoid the wait would cost more than we have.
  *
  * Assumptions:
  * - The address passed as `address` is valid.
  */
 uint8_t eeprom__read(uint8_t * from) {
-  while (EECR & (1<<EEPE));  // wait for previous write to complete
-  EEAR = (uint16_t) from;    // set up address register
-  EECR |= (1<<EERE);         // start EEPROM read (then halt, 4 clock cycles)
-  return EEDR;               // return the value in the data register
+    EECR &= ~(1<<EERIE);  // (so the queue isn't changed under us)
+
+    uint8_t data = read_after( (uint16_t) from,
+                               to_write.length, to_copy.length );
+
+    if (to_write.length)
+        EECR |= (1<<EERIE);
+
+    return data;
 }
 
-// note: this should be the only function adding elements to `to_write`
+// note: this should be the only function adding writes to `to_write`
 uint8_t eeprom__write(uint8_t * address, uint8_t data) {
-    to_write.unused_back--;
-    if (resize_to_write()) {
-        to_write.unused_back++;
-        return 1;  // resize failed
+    uint8_t ret = 0;
+
+    EECR &= ~(1<<EERIE);  // (so the queue isn't changed under us)
+
+    // if the last thing queued for this byte is a write, change that instead
+    // - we can't look past a copy without working out whether it changes
+    //   this byte; it's simpler to just not
+    for (uint8_t i = to_write.length; i > 0; i--) {
+        write_t * w = &AT(to_write, OPT__EEPROM__WRITE_QUEUE_SIZE, i-1);
+        if (w->action != ACTION_WRITE)
+            break;
+        if (w->to == (uint16_t) address) {
+            w->value = data;
+            goto out;
+        }
     }
 
-    uint8_t index = to_write.allocated - to_write.unused_back - 1;
-    to_write.data[index].action = ACTION_WRITE;
-    to_write.data[index].to     = (uint16_t) address;
-    to_write.data[index].value  = data;
+    if ( read_after( (uint16_t) address,
+                     to_write.length, to_copy.length ) == data )
+        goto out;  // nothing to do
 
-    if (!status.writing) {
-        timer__schedule_cycles( 0, &write_queued );
-        status.writing = true;
+    if (to_write.length == OPT__EEPROM__WRITE_QUEUE_SIZE) {
+        ret = 1;  // error: queue full
+        goto out;
     }
 
-    return 0;  // success
+    write_t * w = &AT( to_write, OPT__EEPROM__WRITE_QUEUE_SIZE,
+                       to_write.length );
+    w->action = ACTION_WRITE;
+    w->to     = (uint16_t) address;
+    w->value  = data;
+    to_write.length++;
+
+out:
+    if (to_write.length)
+        EECR |= (1<<EERIE);
+
+    return ret;
 }
 
 // note: this should be the only function adding elements to `to_copy`
 uint8_t eeprom__copy(uint8_t * to, uint8_t * from, uint8_t length) {
-    if (to == from)
+    if (to == from || length == 0)
         return 0;  // nothing to do
 
-    to_write.unused_back--;
-    to_copy.unused_back--;
-    if (resize_to_write() || resize_to_copy()) {
-        to_write.unused_back++; resize_to_write();
-        to_copy.unused_back++;  resize_to_copy();
-        return 1;  // resize failed
-    }
+    uint8_t ret = 0;
 
-    uint8_t index;
+    EECR &= ~(1<<EERIE);  // (so the queues aren't changed under us)
 
-    index = to_write.allocated - to_write.unused_back - 1;
-    to_write.data[index].action = ACTION_COPY;
-    to_write.data[index].to     = (uint16_t) to;
-    to_write.data[index].value  = length;
+    if ( to_write.length == OPT__EEPROM__WRITE_QUEUE_SIZE ||
+         to_copy.length  == OPT__EEPROM__COPY_QUEUE_SIZE ) {
+        ret = 1;  // error: queue full
+    } else {
+        write_t * w = &AT( to_write, OPT__EEPROM__WRITE_QUEUE_SIZE,
+                           to_write.length );
+        w->action = ACTION_COPY;
+        w->to     = (uint16_t) to;
+        w->value  = length;
+        to_write.length++;
+
+        AT(to_copy, OPT__EEPROM__COPY_QUEUE_SIZE, to_copy.length).from
+            = (uint16_t) from;
+        to_copy.length++;
+    }
 
-    index = to_copy.allocated - to_copy.unused_back - 1;
-    to_copy.data[index].from = (uint16_t) from;
+    if (to_write.length)
+        EECR |= (1<<EERIE);
 
-    if (!status.writing) {
-        timer__schedule_cycles( 0, &write_queued );
-        status.writing = true;
-    }
+    return ret;
+}
 
-    return 0;  // success
+bool eeprom__is_writing(void) {
+    return to_write.length || (EECR & (1<<EEPE));
 }
 
+// ----------------------------------------------------------------------------
+// interrupt service routines -------------------------------------------------
+
+ISR(EE_READY_vect) {
+    write_queued();
+}
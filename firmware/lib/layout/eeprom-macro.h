@@ -33,6 +33,11 @@
  *       layers, but wanted to manually map different key combinations to
  *       different macros for a given key, this could be done by repurposing
  *       the `layer` field to mean "key combination id" (or some such thing).
+ *
+ * - The "remap" functions are separate from the macro functions: they let the
+ *   action at a position in the layout be replaced (persistently) at runtime,
+ *   without a rebuild.  For those, `eeprom_macro__uid_t` is always a position
+ *   in the layer matrix (and `pressed` is ignored).
  */
 
 
@@ -56,16 +61,28 @@ typedef struct {
 
 // ----------------------------------------------------------------------------
 
-uint8_t eeprom_macro__init             (void);
-uint8_t eeprom_macro__record_init      (void);
-uint8_t eeprom_macro__record_keystroke ( bool    pressed,
-                                         uint8_t row,
-                                         uint8_t column );
-uint8_t eeprom_macro__record_finalize  (eeprom_macro__uid_t index);
-uint8_t eeprom_macro__exists           (eeprom_macro__uid_t index);
-uint8_t eeprom_macro__play             (eeprom_macro__uid_t index);
-void    eeprom_macro__clear            (eeprom_macro__uid_t index);
-void    eeprom_macro__clear_all        (void);
+uint8_t  eeprom_macro__init             (void);
+uint8_t  eeprom_macro__record_init      (void);
+uint8_t  eeprom_macro__record_keystroke ( bool    pressed,
+                                          uint8_t row,
+                                          uint8_t column );
+uint8_t  eeprom_macro__record_finalize  (eeprom_macro__uid_t index);
+uint8_t  eeprom_macro__exists           (eeprom_macro__uid_t index);
+uint8_t  eeprom_macro__play             (eeprom_macro__uid_t index);
+void     eeprom_macro__clear            (eeprom_macro__uid_t index);
+void     eeprom_macro__clear_all        (void);
+
+uint8_t  eeprom_macro__remap            ( eeprom_macro__uid_t index,
+                                          uint16_t            action );
+bool     eeprom_macro__remap_read       ( eeprom_macro__uid_t index,
+                                          uint16_t *          action );
+void     eeprom_macro__remap_clear      (eeprom_macro__uid_t index);
+void     eeprom_macro__remap_clear_all  (void);
+uint16_t eeprom_macro__remap_generation (void);
+
+// ----------------------------------------------------------------------------
+
+extern uint8_t eeprom_macro__remapped[OPT__KB__ROWS][OPT__KB__COLUMNS];
 
 
 // ----------------------------------------------------------------------------
@@ -109,6 +126,29 @@ void    eeprom_macro__clear_all        (void);
  */
 
 
+// ----------------------------------------------------------------------------
+// variables ------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// === eeprom_macro__remapped ===
+/**                                variables/eeprom_macro__remapped/description
+ * Which layers each position has been remapped on (see
+ * `eeprom_macro__remap()`)
+ *
+ * For any position, bit `layer` of `eeprom_macro__remapped[row][column]` is
+ * set if the position has been remapped on that layer.
+ *
+ * Notes:
+ * - This is read-only, outside the implementing file.
+ * - This is here so that a layout can tell (with a single SRAM read, which is
+ *   no slower than the `pgm_read_word()` it would be doing anyway) that a
+ *   position hasn't been remapped on any layer, which will almost always be
+ *   the case.  Only if it has does the layout need to call
+ *   `eeprom_macro__remap_read()`.
+ * - This takes `OPT__KB__ROWS * OPT__KB__COLUMNS` bytes of SRAM.
+ */
+
+
 // ----------------------------------------------------------------------------
 // functions ------------------------------------------------------------------
 // ----------------------------------------------------------------------------
@@ -126,6 +166,9 @@ void    eeprom_macro__clear_all        (void);
  * Notes:
  * - This function should initialize the EEPROM to the current format if the
  *   version of the data stored is different than what we expect.
+ * - This function loads the remapped keys (see `eeprom_macro__remap()`) into
+ *   SRAM, so they can be looked up quickly; and notes where each macro is,
+ *   for the same reason.
  */
 
 // === eeprom_macro__record_init() ===
@@ -167,11 +210,15 @@ void    eeprom_macro__clear_all        (void);
  *
  * Returns
  * - success: `0`
- * - failure: [other]
+ * - failure: [other] (not enough memory left, or too many macros)
  *
  * Notes:
  * - Before this function is called, the macro (even though parts of it may be
  *   written) should not be readable, or referenced anywhere in the EEPROM
+ * - If a macro with the same UID already exists, it's replaced.
+ * - The macro is written to the EEPROM in the background (making room for it
+ *   first, if necessary), so it may not exist for a while after this function
+ *   returns.  A new macro can't be recorded until it does.
  */
 
 // === eeprom_macro__exists() ===
@@ -184,6 +231,13 @@ void    eeprom_macro__clear_all        (void);
  * Returns:
  * - `1`: if a macro with the given UID exists
  * - `0`: if a macro with the given UID does not exist
+ *
+ * Notes:
+ * - This never reads the EEPROM: where each macro is is kept in SRAM, and
+ *   only the macros at the UID's row and column (rarely more than one) are
+ *   looked at.  So it's cheap enough to call for every key press, even while
+ *   EEPROM writes are waiting (when every EEPROM read has to wait for the
+ *   write in progress to finish).
  */
 
 // === eeprom_macro__play() ===
@@ -194,14 +248,20 @@ void    eeprom_macro__clear_all        (void);
  * - `index`: The UID of the macro to play
  *
  * Returns:
- * - success: `0` (macro successfully played)
- * - failure: [other] (macro does not exist)
+ * - success: `0` (macro started playing)
+ * - failure: [other] (macro does not exist, or another macro is playing)
  *
  * Notes:
  * - Keystrokes will be played back as if the same sequence of keys were being
  *   pressed by the user (regardless of whether the current state of the
  *   keyboard is the same), except as fast as possible (since timing is not
  *   recorded).
+ * - Playback starts after this function returns, and runs in the background:
+ *   each keystroke is passed to `kb__layout__exec_key()`, and the resulting
+ *   report queued (see `usb__kb__queue_report()`), for as long as there's
+ *   room in the queue each scan cycle.  While EEPROM writes are waiting (as
+ *   when a macro was just recorded), playback pauses, rather than wait on the
+ *   EEPROM for each keystroke.
  */
 
 // === eeprom_macro__clear() ===
@@ -221,6 +281,81 @@ void    eeprom_macro__clear_all        (void);
  *   in such a state that none of the functions declared here will be able to
  *   find a macro for any `index`.  This does not necessarily imply that the
  *   EEPROM is in a fully known state.
+ * - Any macro being recorded is discarded.  A macro being played stops after
+ *   the keystroke it's in the middle of: the release of the key it's tapping
+ *   (and of the modifier it's holding, if any) is still played, so no key is
+ *   left pressed.
+ */
+
+// === eeprom_macro__remap() ===
+/**                                   functions/eeprom_macro__remap/description
+ * Map the given position in the layer matrix to `action`, instead of whatever
+ * it maps to in the layout
+ *
+ * Arguments:
+ * - `index`: The position to remap (`pressed` is ignored)
+ * - `action`: The action code to map it to
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (the position can't be remapped, or there's no room)
+ *
+ * Notes:
+ * - Remapping a position that's already been remapped replaces the old
+ *   action.  This is done so that, if the power goes out part way through
+ *   writing the change to the EEPROM, the position maps to its old action,
+ *   its new one, or (at worst) whatever it does in the layout; never to a
+ *   mix of the old and new ones.
+ * - Only layers `0` through `7` can be remapped.
+ * - The change is made in SRAM right away, and written to the EEPROM in the
+ *   background, so it'll still be there after the keyboard is unplugged.
+ * - Anything caching lookups in the layout (like which layer each position
+ *   resolves to) should be invalidated after calling this.
+ */
+
+// === eeprom_macro__remap_read() ===
+/**                              functions/eeprom_macro__remap_read/description
+ * Get the action the given position has been remapped to, if it has been
+ *
+ * Arguments:
+ * - `index`: The position to look up (`pressed` is ignored)
+ * - `action`: A pointer to where to put the action code
+ *
+ * Returns:
+ * - `true`: if the position has been remapped (`*action` is set)
+ * - `false`: if the position has not been remapped (`*action` is untouched)
+ *
+ * Notes:
+ * - This reads only from SRAM, and only looks at the remappings for the given
+ *   row and column (of which there are rarely more than one), so it costs
+ *   about as much as a `pgm_read_word()`.
+ */
+
+// === eeprom_macro__remap_clear() ===
+/**                             functions/eeprom_macro__remap_clear/description
+ * Undo the remapping of the given position (if there is one), so that it maps
+ * to whatever it does in the layout again
+ *
+ * Arguments:
+ * - `index`: The position to clear (`pressed` is ignored)
  */
 
+// === eeprom_macro__remap_clear_all() ===
+/**                         functions/eeprom_macro__remap_clear_all/description
+ * Undo all remappings
+ */
 
+// === eeprom_macro__remap_generation() ===
+/**                        functions/eeprom_macro__remap_generation/description
+ * Return a number that changes every time the remappings do
+ *
+ * Returns:
+ * - success: the number of changes made by `eeprom_macro__remap()`,
+ *   `eeprom_macro__remap_clear()`, and `eeprom_macro__remap_clear_all()` so
+ *   far (modulo 2^16)
+ *
+ * Notes:
+ * - Meant for code that caches what positions map to (like the layout's
+ *   `kb__layout__exec_key()`): if the generation hasn't changed since the
+ *   cache was filled, neither have the remappings.
+ */
@@ -51,13 +51,34 @@
  *   (detected) eeprom-macro corruption hopefully more of an annoyance than
  *   anything else, I decided the effort (and extra EEMEM usage) wasn't worth
  *   it.
+ *
+ * - Writing to the EEPROM is slow, and only so many writes can be waiting at
+ *   once (see ".../firmware/lib/eeprom.h"), so almost everything that changes
+ *   the stored macros happens in the background.  A macro is recorded into
+ *   SRAM, then written (by `_write_step()`, which runs once per scan cycle
+ *   until it's done) a few bytes at a time; and if there isn't room for it
+ *   at the end of `macros.data`, the macros after any deleted ones are moved
+ *   down first (by `compress()`, one macro at a time, with `eeprom__copy()`).
+ *   Playback likewise runs once per scan cycle, for as long as there's room
+ *   in the USB report queue.
+ *
+ * - Where each macro is in the EEPROM is kept in SRAM (`_index`, reached
+ *   through `_table` by row and column), so looking up a macro (or finding
+ *   that a key has none, which is almost every key) never has to touch the
+ *   EEPROM.  This matters most while writes are waiting: every
+ *   `eeprom__read()` has to wait for the write in progress to finish first.
  */
 
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <avr/eeprom.h>
 #include "../../../../firmware/keyboard.h"
 #include "../../../../firmware/lib/eeprom.h"
+#include "../../../../firmware/lib/timer.h"
+#include "../../../../firmware/lib/usb.h"
 #include "../eeprom-macro.h"
 
 // ----------------------------------------------------------------------------
@@ -70,6 +91,69 @@
     #error "OPT__EEPROM_MACRO__EEPROM_SIZE must be <= 1024"
 #endif
 
+#ifndef OPT__EEPROM_MACRO__REMAP_SIZE
+    #error "OPT__EEPROM_MACRO__REMAP_SIZE not defined"
+#endif
+
+/**                            macros/OPT__EEPROM_MACRO__REMAP_SIZE/description
+ * The number of (layer, position) pairs that can be remapped (see
+ * `eeprom_macro__remap()`)
+ *
+ * Notes:
+ * - Each takes 5 bytes of EEPROM (out of `OPT__EEPROM_MACRO__EEPROM_SIZE`)
+ *   and 6 bytes of SRAM (see `_remap` and `_remap_next`).
+ * - One element is always kept unused (see `eeprom_macro__remap()`), so one
+ *   fewer pair than this can actually be remapped.
+ * - Must be between 2 and 254, inclusive (since 255 is `UINT8_MAX`, which
+ *   `_remap_find()` returns for "not found").
+ */
+#if OPT__EEPROM_MACRO__REMAP_SIZE < 2 || OPT__EEPROM_MACRO__REMAP_SIZE > 254
+    #error "OPT__EEPROM_MACRO__REMAP_SIZE out of range"
+#endif
+
+/**                                               macros/LENGTH_MAX/description
+ * The most bytes of `action`s a macro can have
+ *
+ * Notes:
+ * - A macro (with its header) must fit in a single `eeprom__copy()` (255
+ *   bytes), so that `compress()` can move it in one step.
+ */
+#define  LENGTH_MAX  248
+
+#ifndef OPT__EEPROM_MACRO__RECORD_SIZE
+    #error "OPT__EEPROM_MACRO__RECORD_SIZE not defined"
+#endif
+
+/**                           macros/OPT__EEPROM_MACRO__RECORD_SIZE/description
+ * The number of bytes a macro's keystrokes can take, once encoded (see
+ * `action`)
+ *
+ * Notes:
+ * - Each takes 1 byte of SRAM (for recording).
+ * - A tap (a press and release of the same key) usually takes 1 byte, so
+ *   this is about the number of taps a macro can have.
+ * - Must be between 2 and `LENGTH_MAX`, inclusive.
+ */
+#if OPT__EEPROM_MACRO__RECORD_SIZE < 2 \
+        || OPT__EEPROM_MACRO__RECORD_SIZE > LENGTH_MAX
+    #error "OPT__EEPROM_MACRO__RECORD_SIZE out of range"
+#endif
+
+#ifndef OPT__EEPROM_MACRO__INDEX_SIZE
+    #error "OPT__EEPROM_MACRO__INDEX_SIZE not defined"
+#endif
+
+/**                            macros/OPT__EEPROM_MACRO__INDEX_SIZE/description
+ * The number of macros that can exist at once
+ *
+ * Notes:
+ * - Each takes 5 bytes of SRAM (see `_index`).
+ * - Must be between 1 and 254, inclusive (since 255 is `NONE`).
+ */
+#if OPT__EEPROM_MACRO__INDEX_SIZE < 1 || OPT__EEPROM_MACRO__INDEX_SIZE > 254
+    #error "OPT__EEPROM_MACRO__INDEX_SIZE out of range"
+#endif
+
 // ----------------------------------------------------------------------------
 
 /**                                                  macros/VERSION/description
@@ -78,10 +162,72 @@
  * History:
  * - 0x00: Reserved: EEPROM in inconsistent state
  * - 0x01: First version
+ * - 0x02: Added `remap`
+ * - 0x03: Moved `table.rows` and `table.columns` into `meta`, and `table`
+ *   into SRAM; started using `macros`
+ * - 0x04: Changed `action` to a variable length encoding (`header.length`
+ *   is now in bytes)
  * - ... : (not yet assigned)
  * - 0xFF: Reserved: EEPROM not yet initialized
  */
-#define  VERSION  0x01
+#define  VERSION  0x04
+
+/**                                            macros/MACROS_LENGTH/description
+ * The number of elements in `eeprom.macros.data`
+ */
+#define  MACROS_LENGTH  ( sizeof(eeprom.macros.data) / sizeof(uint32_t) )
+
+/**                                                     macros/NONE/description
+ * The offset (into `macros.data`) of "no macro"
+ */
+#define  NONE  UINT8_MAX
+
+/**                                             macros/(group) type/description
+ * Valid values for `header.type`
+ *
+ * Members:
+ * - `TYPE_DELETED`
+ * - `TYPE_VALID`
+ * - `TYPE_END`: (the erased value) there are no macros from here on
+ */
+#define  TYPE_DELETED  0x00
+#define  TYPE_VALID    0x01
+#define  TYPE_END      0xFF
+
+/**                                           macros/(group) action/description
+ * The kinds of `action`, as given by the high bits of their first byte
+ *
+ * Members:
+ * - `ACTION_TAP`
+ * - `ACTION_REPEAT`
+ * - `ACTION_WRAP`
+ * - `ACTION_PRESS`
+ * - `ACTION_RELEASE`
+ */
+#define  ACTION_TAP      0x00
+#define  ACTION_REPEAT   0x80
+#define  ACTION_WRAP     0xA0
+#define  ACTION_PRESS    0xC0
+#define  ACTION_RELEASE  0xE0
+
+/**                                              macros/ACTION_KIND/description
+ * The kind of `action` that starts with the byte `first`
+ */
+#define  ACTION_KIND(first)  ( ((first) & 0x80) ? (first) & 0xE0 : ACTION_TAP )
+
+/**                                             macros/ACTION_COUNT/description
+ * The count (the low 5 bits) of the `ACTION_REPEAT` or `ACTION_WRAP` starting
+ * with the byte `first`
+ */
+#define  ACTION_COUNT(first)  ( (first) & 0x1F )
+
+/**                                                macros/POSITIONS/description
+ * The number of key positions (each of which an `action` stores in 7 bits)
+ */
+#define  POSITIONS  (OPT__KB__ROWS * OPT__KB__COLUMNS)
+#if POSITIONS > 128
+    #error "eeprom-macro can't store more than 128 key positions"
+#endif
 
 // ----------------------------------------------------------------------------
 
@@ -95,26 +241,77 @@
  *     - `0x01`: valid macro
  *     - ...   : (not yet assigned)
  *     - `0xFF`: macro does not exist
- * - `length`: the number of `action`s that follow
- * - `uid`: a Unique IDentifier for the macro
+ * - `length`: the number of bytes (of `action`s) that follow
+ * - `uid`: a Unique IDentifier for the macro (an `eeprom_macro__uid_t`, as
+ *   packed by `_bits()`)
  */
 typedef struct {
-    uint8_t             type;
-    uint8_t             length;
-    eeprom_macro__uid_t uid;
-} header;
+    uint8_t  type;
+    uint8_t  length;
+    uint16_t uid;
+} __attribute__((packed, aligned(1))) header;
 
 /**                                                    types/action/description
- * To describe the "press" or "release" of a key when recording or playing back
- * a macro
+ * To describe the keystrokes (presses and releases of keys) of a macro
+ *
+ * A macro's keystrokes are stored as a sequence of `action`s, each one or
+ * more bytes long.  The high bits of the first byte say which kind it is:
+ *
+ * - `0ppppppp`: (`ACTION_TAP`) press and release the key at position `p`
+ * - `100nnnnn p`: (`ACTION_REPEAT`) tap `p`, `n+2` times
+ * - `101nnnnn m p`: (`ACTION_WRAP`) press `m`, tap `p` `n+1` times, then
+ *   release `m` (as for a key typed with a modifier held)
+ * - `110----- p`: (`ACTION_PRESS`) press `p`
+ * - `111----- p`: (`ACTION_RELEASE`) release `p`
+ *
+ * where a key's position is `row * OPT__KB__COLUMNS + column`.
+ *
+ * Notes:
+ * - `action`s are built up as keystrokes are recorded (see `_encode()`),
+ *   and read one at a time, front to back, as they're played (see
+ *   `_decode()`).
+ * - Most keystrokes in a typical macro are parts of taps, so most keys take 1
+ *   byte to store (where each keystroke took 2 bytes before).
+ */
+typedef uint8_t action;
+
+/**                                                     types/entry/description
+ * To describe where a macro is in the EEPROM (see `_index`)
+ *
+ * Struct members:
+ * - `uid`: The macro's UID (as packed by `_bits()`)
+ * - `offset`: The offset (into `macros.data`) of the macro; or `NONE`, if
+ *   the entry is unused
+ * - `length`: The number of bytes of `action`s in the macro
+ * - `next`: The index (into `_index`) of the entry for the next macro at the
+ *   same row and column, or `NONE`
+ */
+typedef struct {
+    uint16_t uid;
+    uint8_t  offset;
+    uint8_t  length;
+    uint8_t  next;
+} entry;
+
+/**                                                     types/remap/description
+ * To describe a key that's been remapped
+ *
+ * Struct members:
+ * - `layer`, `row`, `column`: The position in the layer matrix
+ * - `action`: The action code the position maps to; or, if bit 15 is set
+ *   (which it never is for a real action code), nothing: the element is
+ *   unused
  *
  * Notes:
- * - Only the `pressed`, `row`, and `column` fields are relevant, since these
- *   are what will be passed to `kb__layout__exec_key()` when playing back the
- *   macro.  `layer` will be ignored.  We reuse the `...uid_t` type for
- *   convenience and consistency.
+ * - An erased element (all `1`s) is unused, so a fresh EEPROM has no remapped
+ *   keys.
  */
-typedef eeprom_macro__uid_t action;
+typedef struct {
+    uint8_t  layer;
+    uint8_t  row;
+    uint8_t  column;
+    uint16_t action;
+} __attribute__((packed, aligned(1))) remap;
 
 // ----------------------------------------------------------------------------
 
@@ -125,24 +322,20 @@ typedef eeprom_macro__uid_t action;
  * - `meta`: For keeping track of layout metadata
  *     - `version`: The version of this layout (`[8]` for fault tolerance and
  *       write balancing)
- * - `table`: To help in quickly returning if the UID we're searching for does
- *   not exist
- *     - `rows`: The number of rows this table has
- *     - `columns`: The number of columns this table has
- *     - `data`:
- *         - For any `eeprom_macro__uid_t uid`
- *             - If `uid.layer > 7`, this table doesn't tell whether a macro
- *               exists for the UID or not
- *             - Otherwise, `! (bool)( (eeprom.table.data[uid.row][uid.column]
- *               >> uid.layer) & 0x1 )` indicates whether a macro exists with
- *               the given UID (`true`) or not (`false`)
- *             - Note that the expression above will return `true` if
- *               `uid.layer > 7`
+ *     - `rows`: The number of rows the keyboard had when the macros were
+ *       recorded
+ *     - `columns`: The number of columns the keyboard had when the macros were
+ *       recorded
+ * - `remap`: To hold the keys that have been remapped
+ *     - `data`: A collection of `remap`s, in no particular order
  * - `macros`: To hold a block of memory for storing macros
  *     - `length`: The number of elements in `macros.data` (which is *not* the
  *       same as the number of macros it can contain)
  *     - `data`: A collection of "macro"s, where a "macro" is a `header`
- *       followed by zero or more `action`s
+ *       followed by zero or more bytes of `action`s (padded to a whole
+ *       element), and
+ *       the collection ends at the first `header` with `type == TYPE_END`
+ *       (or at the end of `data`)
  *
  *
  * Notes:
@@ -152,10 +345,11 @@ typedef eeprom_macro__uid_t action;
  *   when compiling with `avr-gcc`, but it's important to emphasize that we
  *   depend on it.
  *
- * - We keep track of `table.rows`, `table.columns`, and `macros.length`, in
- *   addition to `header.version`, because they all effect the precise layout
- *   of the persistent data; if any of them is different, special handling is
- *   required at the least, and usually the stored data will be unusable.
+ * - We keep track of `meta.rows`, `meta.columns`, and `macros.length`, in
+ *   addition to `meta.version`, because they all effect the precise layout
+ *   (or meaning) of the persistent data; if any of them is different, special
+ *   handling is required at the least, and usually the stored data will be
+ *   unusable.
  *
  *
  * Implementation notes:
@@ -167,70 +361,1017 @@ typedef eeprom_macro__uid_t action;
 struct eeprom {
     struct meta {
         uint8_t version[8];
-    } meta;
-
-    struct table {
         uint8_t rows;
         uint8_t columns;
-        uint8_t data[OPT__KB__ROWS][OPT__KB__COLUMNS];
-    } table;
+    } meta;
+
+    struct remap {
+        remap data[OPT__EEPROM_MACRO__REMAP_SIZE];
+    } remap;
 
     struct macros {
         uint8_t length;
         uint32_t data[ ( OPT__EEPROM_MACRO__EEPROM_SIZE
                          - 1  // for `length`
                          - sizeof(struct meta)
-                         - sizeof(struct table) )
+                         - sizeof(struct remap) )
                        / sizeof(uint32_t) ];
     } macros;
 
 } __attribute__((packed, aligned(1))) eeprom EEMEM;
 
+/**                                                variables/_remap/description
+ * A copy of `eeprom.remap.data`, loaded by `eeprom_macro__init()`
+ *
+ * Notes:
+ * - Index `i` here is always the same as index `i` in the EEPROM, so keeping
+ *   the two in sync only ever means writing the element that changed.
+ */
+static remap _remap[OPT__EEPROM_MACRO__REMAP_SIZE];
+
+/**                                           variables/_remap_next/description
+ * The index (into `_remap`) of the next used element for the same position
+ * as each used element, or `UINT8_MAX`
+ */
+static uint8_t _remap_next[OPT__EEPROM_MACRO__REMAP_SIZE];
+
+/**                                          variables/_remap_table/description
+ * The index (into `_remap`) of the first used element for each row and
+ * column, or `UINT8_MAX`
+ *
+ * Notes:
+ * - The elements for a given row and column are linked (by `_remap_next`),
+ *   as `_table` links macros; so looking up a remapped key only means looking
+ *   at the elements for its position (one per layer it's remapped on), not
+ *   all of them.
+ * - This takes `OPT__KB__ROWS * OPT__KB__COLUMNS` bytes of SRAM.
+ */
+static uint8_t _remap_table[OPT__KB__ROWS][OPT__KB__COLUMNS];
+
+/**                                variables/eeprom_macro__remapped/description
+ * Implementation notes:
+ * - Kept in sync with `_remap` (along with `_remap_table`) by `_remap_link()`
+ *   and `_remap_unlink()`.
+ */
+uint8_t eeprom_macro__remapped[OPT__KB__ROWS][OPT__KB__COLUMNS];
+
+/**                                     variables/_remap_generation/description
+ * Incremented every time `_remap` is modified (see
+ * `eeprom_macro__remap_generation()`)
+ */
+static uint16_t _remap_generation;
+
+/**                                                variables/_table/description
+ * The index (into `_index`) of the entry for the first macro at each row and
+ * column, or `NONE`
+ *
+ * Notes:
+ * - The entries for the macros at a given row and column are linked (by
+ *   `entry.next`), so finding a macro only means looking at those; and
+ *   there's rarely more than one.
+ */
+static uint8_t _table[OPT__KB__ROWS][OPT__KB__COLUMNS];
+
+/**                                                variables/_index/description
+ * Where each macro is in the EEPROM (see `entry`), in no particular order
+ *
+ * Notes:
+ * - Built by `eeprom_macro__init()`, from the macros in the EEPROM, and kept
+ *   up to date by everything that adds, deletes, or moves a macro.
+ */
+static entry _index[OPT__EEPROM_MACRO__INDEX_SIZE];
+
+/**                                                variables/_space/description
+ * To keep track of where things are in `macros.data`
+ *
+ * Struct members:
+ * - `end`: The offset of the first element after the last macro (where the
+ *   `TYPE_END` header is, unless `end == macros.length`)
+ * - `deleted`: The number of elements taken up by deleted macros (which
+ *   `compress()` can get back)
+ */
+static struct {
+    uint8_t end;
+    uint8_t deleted;
+} _space;
+
+/**                                               variables/_record/description
+ * The state of the macro being recorded (or written)
+ *
+ * Struct members:
+ * - `recording`: Whether keystrokes are being recorded
+ * - `writing`: Whether the macro in `data` is being written to the EEPROM
+ * - `length`: The number of bytes in `data`
+ * - `last`: The offsets (into `data`) of the last 3 `action`s, most recent
+ *   first, or `NONE` (if there aren't that many, or we've lost track)
+ * - `uid`: The UID of the macro being written
+ * - `written`: The number of bytes (in the order `_write_byte()` writes them)
+ *   written so far
+ * - `event`: The scheduled run of `_write_step()` (while `writing`)
+ * - `data`: The keystrokes recorded (as `action`s)
+ */
+static struct {
+    bool                recording;
+    bool                writing;
+    uint8_t             length;
+    uint8_t             last[3];
+    eeprom_macro__uid_t uid;
+    uint8_t             written;
+    timer__event_t      event;
+    action              data[OPT__EEPROM_MACRO__RECORD_SIZE];
+} _record;
+
+/**                                                 variables/_play/description
+ * The state of the macro being played
+ *
+ * Struct members:
+ * - `playing`: Whether a macro is being played
+ * - `offset`: The offset (into `macros.data`) of the macro
+ * - `length`: The number of bytes of `action`s in the macro
+ * - `next`: The index of the next byte to read
+ * - `key`: The position of the key being tapped (by the current `action`)
+ * - `modifier`: The position of the key to release once the taps are done
+ * - `taps`: The number of taps (of `key`) left
+ * - `half`: Whether the press of the current tap has been played (so the
+ *   release is next)
+ * - `wrapped`: Whether `modifier` is pressed (and should be released)
+ * - `event`: The scheduled run of `_play_step()` (while `playing`)
+ */
+static struct {
+    bool           playing;
+    uint8_t        offset;
+    uint8_t        length;
+    uint8_t        next;
+    uint8_t        key;
+    uint8_t        modifier;
+    uint8_t        taps;
+    bool           half;
+    bool           wrapped;
+    timer__event_t event;
+} _play;
+
 // ----------------------------------------------------------------------------
 
+/**                                              functions/_address/description
+ * Return the address (in EEPROM memory space) of element `offset` of
+ * `macros.data`
+ */
+static uint8_t * _address(uint8_t offset) {
+    return (uint8_t *) &eeprom.macros.data[offset];
+}
+
+/**                                                 functions/_size/description
+ * Return the number of elements (of `macros.data`) taken up by a macro with
+ * `length` bytes of `action`s
+ */
+static uint8_t _size(uint8_t length) {
+    return 1 + (length+3) / 4;
+}
+
+/**                                            functions/_available/description
+ * Return the number of elements (of `macros.data`) there'd be room for, at
+ * the end, once `macros.data` was compressed
+ */
+static uint8_t _available(void) {
+    return MACROS_LENGTH - _space.end + _space.deleted;
+}
+
+/**                                                 functions/_bits/description
+ * Return `uid`, packed into 16 bits (the way it's stored in the EEPROM)
+ *
+ * Notes:
+ * - We pack the fields by hand, instead of storing the bit-field directly,
+ *   since its layout (and even its size) is up to the compiler.
+ */
+static uint16_t _bits(eeprom_macro__uid_t uid) {
+    return (uint16_t) uid.pressed << 15 | (uint16_t) uid.layer << 10
+         | (uint16_t) uid.row     <<  5 | (uint16_t) uid.column;
+}
+
+/**                                                  functions/_uid/description
+ * Return the `eeprom_macro__uid_t` packed into `bits` (by `_bits()`)
+ */
+static eeprom_macro__uid_t _uid(uint16_t bits) {
+    return (eeprom_macro__uid_t) { .pressed = bits >> 15,
+                                   .layer   = bits >> 10 & 0x1F,
+                                   .row     = bits >>  5 & 0x1F,
+                                   .column  = bits       & 0x1F };
+}
+
+/**                                                 functions/_read/description
+ * Return the 2 bytes at `from` (in EEPROM memory space)
+ */
+static uint16_t _read(uint8_t * from) {
+    return eeprom__read(from) | eeprom__read(from+1) << 8;
+}
+
+/**                                                 functions/_find/description
+ * Return the index (into `_index`) of the entry for the macro with UID `uid`,
+ * or `NONE`
+ *
+ * Notes:
+ * - Only looks at the entries for macros at the same row and column, and
+ *   never at the EEPROM.
+ */
+static uint8_t _find(eeprom_macro__uid_t uid) {
+    if ( uid.layer  > 7                 ||
+         uid.row    >= OPT__KB__ROWS    ||
+         uid.column >= OPT__KB__COLUMNS )
+        return NONE;
+
+    uint16_t bits = _bits(uid);
+    uint8_t i = _table[uid.row][uid.column];
+    while (i != NONE && _index[i].uid != bits)
+        i = _index[i].next;
+
+    return i;
+}
+
+/**                                                 functions/_free/description
+ * Return the index of an unused entry in `_index`, or `NONE`
+ */
+static uint8_t _free(void) {
+    for (uint8_t i=0; i<OPT__EEPROM_MACRO__INDEX_SIZE; i++)
+        if (_index[i].offset == NONE)
+            return i;
+
+    return NONE;
+}
+
+/**                                                  functions/_add/description
+ * Add an entry to `_index` for the macro at `offset`, with UID `uid` and
+ * `length` bytes of `action`s
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (`_index` is full)
+ */
+static uint8_t _add(eeprom_macro__uid_t uid, uint8_t offset, uint8_t length) {
+    uint8_t i = _free();
+    if (i == NONE)
+        return 1;  // error: no room
+
+    _index[i] = (entry) { .uid    = _bits(uid),
+                          .offset = offset,
+                          .length = length,
+                          .next   = _table[uid.row][uid.column] };
+    _table[uid.row][uid.column] = i;
+    return 0;
+}
+
+/**                                               functions/_delete/description
+ * Delete the macro with entry `i` (in `_index`)
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (the EEPROM write couldn't be queued)
+ */
+static uint8_t _delete(uint8_t i) {
+    if (eeprom__write(_address(_index[i].offset), TYPE_DELETED))
+        return 1;  // error: write failed
+
+    _space.deleted += _size(_index[i].length);
+
+    eeprom_macro__uid_t uid = _uid(_index[i].uid);
+    uint8_t * link = &_table[uid.row][uid.column];
+    while (*link != i)
+        link = &_index[*link].next;
+    *link = _index[i].next;
+
+    _index[i].offset = NONE;
+    return 0;
+}
+
+/**                                               functions/_forget/description
+ * Empty `_table` and `_index` (without touching the EEPROM)
+ */
+static void _forget(void) {
+    memset(_table, NONE, sizeof(_table));
+    for (uint8_t i=0; i<OPT__EEPROM_MACRO__INDEX_SIZE; i++)
+        _index[i].offset = NONE;
+}
+
 /**                                              functions/compress/description
- * Compress `macros.data`
+ * Take one step towards compressing `macros.data`
  *
- * Shift all macros towards index `0`, overwriting the areas previously
- * occupied by deleted macros.
+ * Shift the first macro after the first deleted one towards index `0`,
+ * overwriting the area previously occupied by deleted macros (or, if there
+ * are only deleted macros after the first, forget about them).
+ *
+ * Notes:
+ * - Between steps, `macros.data` is in a consistent state: the gap left by
+ *   the moved macro is marked as deleted (with as many headers as it takes,
+ *   since a header can't describe more than 64 elements), and the moved
+ *   macro's entry in `_index` points to where it's going.
+ *
+ * Assumptions:
+ * - There are no writes waiting to be performed (so there's room for the
+ *   copy, and the few writes after it).
+ * - No macro is being played (since it might be moved).
  */
 static void compress(void) {
+    uint8_t to = 0;
+    while (to < _space.end && eeprom__read(_address(to)) != TYPE_DELETED)
+        to += _size(eeprom__read(_address(to)+1));
+
+    uint8_t gap = 0;
+    while ( to+gap < _space.end &&
+            eeprom__read(_address(to+gap)) == TYPE_DELETED )
+        gap += _size(eeprom__read(_address(to+gap)+1));
+
+    if (to+gap >= _space.end) {
+        // only deleted macros from here on
+        if (to < _space.end)
+            eeprom__write(_address(to), TYPE_END);
+        _space.end = to;
+        _space.deleted = 0;
+        return;
+    }
+
+    uint8_t size = _size(eeprom__read(_address(to+gap)+1));
+    eeprom__copy(_address(to), _address(to+gap), size * sizeof(uint32_t));
+
+    for (uint8_t i=0; i<OPT__EEPROM_MACRO__INDEX_SIZE; i++)
+        if (_index[i].offset == to+gap)
+            _index[i].offset = to;
+
+    for (uint8_t at = to+size; gap;) {
+        uint8_t part = (gap > 64) ? 64 : gap;
+        eeprom__write(_address(at),   TYPE_DELETED);
+        eeprom__write(_address(at)+1, (part-1) * 4);  // so `_size()` is `part`
+        at  += part;
+        gap -= part;
+    }
+}
+
+/**                                           functions/_write_byte/description
+ * Write the `n`th byte of the macro in `_record` to the EEPROM
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (the EEPROM write couldn't be queued)
+ *
+ * Notes:
+ * - The bytes are written in this order: the `header` (except for `type`),
+ *   the `action`s, the `TYPE_END` header after the macro (if there's room
+ *   for one), and `type`.  So the macro isn't valid (or counted) until the
+ *   rest of it is there.
+ * - There are `sizeof(header) + length + 1` bytes in all.
+ */
+static uint8_t _write_byte(uint8_t n) {
+    uint8_t * base   = _address(_space.end);
+    uint8_t   length = _record.length;
+
+    if (n == 0)
+        return eeprom__write(base+1, length);
+    if (n <= 2)
+        return eeprom__write(base+1+n, _bits(_record.uid) >> (n-1)*8);
+
+    n -= 3;
+    if (n < length)
+        return eeprom__write(base + sizeof(header) + n, _record.data[n]);
+
+    n -= length;
+    if (n == 0) {
+        uint8_t after = _space.end + _size(length);
+        if (after < MACROS_LENGTH)
+            return eeprom__write(_address(after), TYPE_END);
+        return 0;
+    }
+
+    return eeprom__write(base, TYPE_VALID);
+}
+
+/**                                           functions/_write_step/description
+ * Make room for the macro in `_record`, or write as much of it as we can, and
+ * reschedule (if there's more to do)
+ *
+ * Notes:
+ * - We don't start writing until there are no other writes waiting, so none
+ *   of ours are merged with (and reordered around) an earlier one to the
+ *   same address (like a `TYPE_END` header that `compress()` just wrote).
+ */
+static void _write_step(void * context) {
+    if (!_record.writing)
+        return;
+
+    uint8_t size  = _size(_record.length);
+    uint8_t bytes = sizeof(header) + _record.length + 1;
+
+    if (MACROS_LENGTH - _space.end < size) {
+        if (!eeprom__is_writing() && !_play.playing)
+            compress();
+    } else if (_record.written || !eeprom__is_writing()) {
+        while ( _record.written < bytes &&
+                !_write_byte(_record.written) )
+            _record.written++;
+
+        if (_record.written == bytes) {
+            // - (`eeprom_macro__record_finalize()` made sure there was room)
+            _add(_record.uid, _space.end, _record.length);
+            _space.end += size;
+            _record.writing = false;
+            return;
+        }
+    }
+
+    _record.event = timer__schedule_cycles(1, &_write_step, NULL);
+    if (!_record.event)
+        _record.writing = false;  // (shouldn't happen)
+}
+
+/**                                                 functions/_kind/description
+ * Return the kind of the `i`th most recent `action` in `_record.data` (see
+ * `_record.last`), or `NONE`
+ */
+static uint8_t _kind(uint8_t i) {
+    if (_record.last[i] == NONE)
+        return NONE;
+    return ACTION_KIND(_record.data[_record.last[i]]);
+}
+
+/**                                                  functions/_key/description
+ * Return the position of the key pressed, released, or tapped by the `i`th
+ * most recent `action` in `_record.data`
+ *
+ * Assumptions:
+ * - `_kind(i) != NONE`
+ */
+static uint8_t _key(uint8_t i) {
+    uint8_t offset = _record.last[i];
+    switch (_kind(i)) {
+        case ACTION_TAP:  return _record.data[offset];
+        case ACTION_WRAP: return _record.data[offset+2];
+        default:          return _record.data[offset+1];
+    }
+}
+
+/**                                                 functions/_push/description
+ * Start a new `action` (with first byte `first`) at the end of `_record.data`
+ *
+ * Notes:
+ * - The rest of the `action`'s bytes (if any) should be appended right after.
+ */
+static void _push(action first) {
+    _record.last[2] = _record.last[1];
+    _record.last[1] = _record.last[0];
+    _record.last[0] = _record.length;
+    _record.data[_record.length++] = first;
+}
+
+/**                                                  functions/_pop/description
+ * Remove the most recent `action` from the end of `_record.data`
+ */
+static void _pop(void) {
+    _record.length  = _record.last[0];
+    _record.last[0] = _record.last[1];
+    _record.last[1] = _record.last[2];
+    _record.last[2] = NONE;
+}
+
+/**                                               functions/_encode/description
+ * Add a keystroke to the end of `_record.data`
+ *
+ * Arguments:
+ * - `pressed`: Whether the key was pressed (or released)
+ * - `key`: The position of the key
+ *
+ * Notes:
+ * - Keystrokes are added as `ACTION_PRESS` and `ACTION_RELEASE`, but when a
+ *   release completes a pattern with the `action`s just before it, those are
+ *   rewritten as one shorter `action`:
+ *     - a press of `key`: the two become a tap (which, after a tap or repeat
+ *       of `key`, becomes (or extends) a repeat)
+ *     - a tap (or repeat) of some key, after a press of `key`: the three
+ *       become a wrap
+ * - This never takes more than 2 more bytes of `_record.data`.
+ */
+static void _encode(bool pressed, uint8_t key) {
+    action * data = _record.data;
+
+    if (pressed) {
+        _push(ACTION_PRESS);
+        data[_record.length++] = key;
+        return;
+    }
+
+    if (_kind(0) == ACTION_PRESS && _key(0) == key) {
+        _pop();
+        if (_kind(0) == ACTION_TAP && _key(0) == key) {
+            data[_record.last[0]] = ACTION_REPEAT;  // (2 taps)
+            data[_record.length++] = key;
+        } else if ( _kind(0) == ACTION_REPEAT && _key(0) == key &&
+                    ACTION_COUNT(data[_record.last[0]]) < 0x1F ) {
+            data[_record.last[0]]++;
+        } else {
+            _push(key);
+        }
+        return;
+    }
+
+    if ( _kind(1) == ACTION_PRESS && _key(1) == key &&
+         ( _kind(0) == ACTION_TAP ||
+           ( _kind(0) == ACTION_REPEAT &&
+             ACTION_COUNT(data[_record.last[0]]) < 0x1F ) ) ) {
+        uint8_t count = (_kind(0) == ACTION_TAP)
+                        ? 0 : ACTION_COUNT(data[_record.last[0]]) + 1;
+        uint8_t tapped = _key(0);
+        _pop();
+        _pop();
+        _push(ACTION_WRAP | count);
+        data[_record.length++] = key;
+        data[_record.length++] = tapped;
+        return;
+    }
+
+    _push(ACTION_RELEASE);
+    data[_record.length++] = key;
+}
+
+/**                                            functions/_play_read/description
+ * Return the next byte of the macro being played
+ */
+static uint8_t _play_read(void) {
+    return eeprom__read( _address(_play.offset) + sizeof(header)
+                         + _play.next++ );
+}
+
+/**                                               functions/_decode/description
+ * Get the next keystroke of the macro being played
+ *
+ * Arguments:
+ * - `pressed`: A pointer to where to put whether the key is pressed (or
+ *   released)
+ * - `key`: A pointer to where to put the position of the key
+ *
+ * Returns:
+ * - `true`: if there was another keystroke
+ * - `false`: if the macro is done
+ *
+ * Notes:
+ * - Each byte is read once, in order, and each keystroke takes only a few
+ *   steps to work out, however the `action` it's part of was encoded.
+ */
+static bool _decode(bool * pressed, uint8_t * key) {
+    if (!_play.taps) {
+        if (_play.wrapped) {
+            _play.wrapped = false;
+            *pressed = false;
+            *key     = _play.modifier;
+            return true;
+        }
+
+        if (_play.next >= _play.length)
+            return false;
+
+        uint8_t first = _play_read();
+        switch (ACTION_KIND(first)) {
+            case ACTION_TAP:
+                _play.key  = first;
+                _play.taps = 1;
+                break;
+
+            case ACTION_REPEAT:
+                _play.key  = _play_read();
+                _play.taps = ACTION_COUNT(first) + 2;
+                break;
+
+            case ACTION_WRAP:
+                _play.modifier = _play_read();
+                _play.key      = _play_read();
+                _play.taps     = ACTION_COUNT(first) + 1;
+                _play.wrapped  = true;
+                *pressed = true;
+                *key     = _play.modifier;
+                return true;
+
+            default:  // ACTION_PRESS, ACTION_RELEASE
+                *pressed = (ACTION_KIND(first) == ACTION_PRESS);
+                *key     = _play_read();
+                return true;
+        }
+    }
+
+    *pressed = !_play.half;
+    *key     = _play.key;
+    if (_play.half)
+        _play.taps--;
+    _play.half = !_play.half;
+    return true;
+}
+
+/**                                            functions/_play_step/description
+ * Play as many keystrokes as there's room for in the report queue, then
+ * reschedule (if there's more to do)
+ *
+ * Notes:
+ * - Nothing is played while EEPROM writes are waiting or in progress:
+ *   `eeprom__read()` would have to wait for each byte being written to finish
+ *   (up to 3.4 ms), so we wait a scan cycle instead.
+ */
+static void _play_step(void * context) {
+    while ( _play.playing && !usb__kb__queue_full()
+                          && !eeprom__is_writing() ) {
+        bool    pressed;
+        uint8_t key;
+        if (!_decode(&pressed, &key)) {
+            _play.playing = false;
+            break;
+        }
+
+        if (key >= POSITIONS)
+            continue;  // (shouldn't happen)
+
+        kb__layout__exec_key( pressed, key / OPT__KB__COLUMNS,
+                                       key % OPT__KB__COLUMNS );
+        usb__kb__queue_report();
+    }
+
+    if (!_play.playing)
+        return;
+
+    _play.event = timer__schedule_cycles(1, &_play_step, NULL);
+    if (!_play.event)
+        _play.playing = false;  // (shouldn't happen)
+}
+
+/**                                                functions/_reset/description
+ * Forget all macros, and (re)write the metadata describing `macros`
+ */
+static void _reset(void) {
+    eeprom__write(&eeprom.meta.rows, OPT__KB__ROWS);
+    eeprom__write(&eeprom.meta.columns, OPT__KB__COLUMNS);
+    eeprom__write(&eeprom.macros.length, MACROS_LENGTH);
+    eeprom__write(_address(0), TYPE_END);
+
+    _space.end = 0;
+    _space.deleted = 0;
+}
+
+/**                                           functions/_remap_find/description
+ * Return the index into `_remap` of the element for the given position, or
+ * `UINT8_MAX`
+ *
+ * Assumptions:
+ * - `row` and `column` are valid.
+ */
+static uint8_t _remap_find(uint8_t layer, uint8_t row, uint8_t column) {
+    uint8_t i = _remap_table[row][column];
+    while (i != UINT8_MAX && _remap[i].layer != layer)
+        i = _remap_next[i];
+    return i;
+}
+
+/**                                           functions/_remap_link/description
+ * Add (used) element `i` of `_remap` to the lookups for its position
+ */
+static void _remap_link(uint8_t i) {
+    remap * element = &_remap[i];
+
+    _remap_next[i] = _remap_table[element->row][element->column];
+    _remap_table[element->row][element->column] = i;
+
+    eeprom_macro__remapped[element->row][element->column]
+        |= (1<<element->layer);
+}
+
+/**                                         functions/_remap_unlink/description
+ * Remove (used) element `i` of `_remap` from the lookups for its position
+ */
+static void _remap_unlink(uint8_t i) {
+    remap * element = &_remap[i];
+
+    uint8_t * link = &_remap_table[element->row][element->column];
+    while (*link != i)
+        link = &_remap_next[*link];
+    *link = _remap_next[i];
+
+    eeprom_macro__remapped[element->row][element->column]
+        &= ~(1<<element->layer);
+}
+
+/**                                            functions/_remap_set/description
+ * Set element `i` of `_remap` to `value`, and update the lookups to match
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (the EEPROM writes couldn't be queued)
+ *
+ * Notes:
+ * - Only the EEPROM bytes that matter are written: to mark an element unused,
+ *   we write the high byte of `action`; and to use it, we write that byte
+ *   last, so the element isn't valid until everything else is there.
+ *
+ * Assumptions:
+ * - Element `i` is unused, or `value` is.  (Writing over a used element
+ *   would leave a valid mix of the old and new values, if the power went out
+ *   part way through; and invalidating it first wouldn't help, since the
+ *   EEPROM library may merge the two writes of the high byte into one.)
+ */
+static uint8_t _remap_set(uint8_t i, remap value) {
+    remap * old = &_remap[i];
+    uint8_t * to = (uint8_t *) &eeprom.remap.data[i];
+    uint8_t * from = (uint8_t *) &value;
+
+    if (value.action & 0x8000) {
+        if (eeprom__write(to+sizeof(remap)-1, 0xFF))
+            return 1;  // error: write failed
+    } else {
+        for (uint8_t b=0; b<sizeof(remap); b++)
+            if (eeprom__write(to+b, from[b]))
+                return 1;  // error: write failed
+    }
+
+    if (!(old->action & 0x8000))
+        _remap_unlink(i);
+
+    *old = value;
+    if (!(value.action & 0x8000))
+        _remap_link(i);
+
+    _remap_generation++;
+    return 0;
 }
 
 // ----------------------------------------------------------------------------
 
 uint8_t eeprom_macro__init(void) {
+    _forget();
+
+    memset(_remap_table, UINT8_MAX, sizeof(_remap_table));
+
+    if (eeprom__read(&eeprom.meta.version[0]) != VERSION) {
+        // - whatever's in `remap` (if anything) isn't in the format we expect
+        for (uint8_t i=0; i<OPT__EEPROM_MACRO__REMAP_SIZE; i++)
+            eeprom__write( (uint8_t *) &eeprom.remap.data[i]
+                           + sizeof(remap)-1, 0xFF );
+        _reset();
+        eeprom__write(&eeprom.meta.version[0], VERSION);
+        for (uint8_t i=0; i<OPT__EEPROM_MACRO__REMAP_SIZE; i++)
+            _remap[i].action = 0xFFFF;
+        return 0;
+    }
+
+    for (uint8_t i=0; i<OPT__EEPROM_MACRO__REMAP_SIZE; i++) {
+        uint8_t * from = (uint8_t *) &eeprom.remap.data[i];
+        uint8_t * to   = (uint8_t *) &_remap[i];
+        for (uint8_t b=0; b<sizeof(remap); b++)
+            to[b] = eeprom__read(from+b);
+
+        if (_remap[i].action & 0x8000)
+            continue;
+        if ( _remap[i].layer  > 7             ||
+             _remap[i].row    >= OPT__KB__ROWS ||
+             _remap[i].column >= OPT__KB__COLUMNS ) {
+            _remap[i].action = 0xFFFF;  // (shouldn't happen)
+            continue;
+        }
+        if (_remap_find(_remap[i].layer, _remap[i].row, _remap[i].column)
+                != UINT8_MAX) {
+            _remap[i].action = 0xFFFF;  // (shouldn't happen: a duplicate)
+            continue;
+        }
+        _remap_link(i);
+    }
+
+    uint8_t length = MACROS_LENGTH;
+
+    if ( eeprom__read(&eeprom.meta.rows)      != OPT__KB__ROWS    ||
+         eeprom__read(&eeprom.meta.columns)   != OPT__KB__COLUMNS ||
+         eeprom__read(&eeprom.macros.length)  != length ) {
+        // - the macros (if any) were recorded for a different keyboard (or a
+        //   different build)
+        _reset();
+        return 0;
+    }
+
+    // find the macros, and fill in `_table`, `_index`, and `_space`
+    uint8_t offset = 0;
+    while (offset < length) {
+        uint8_t type  = eeprom__read(_address(offset));
+        uint8_t bytes = eeprom__read(_address(offset)+1);
+        uint8_t size  = _size(bytes);
+
+        if ( (type != TYPE_VALID && type != TYPE_DELETED) ||
+             offset + size > length ||
+             (type == TYPE_VALID && size > _size(LENGTH_MAX)) )
+            break;  // the end (or something we can't make sense of)
+
+        if (type == TYPE_DELETED) {
+            _space.deleted += size;
+        } else {
+            eeprom_macro__uid_t uid = _uid(_read(_address(offset)+2));
+            if ( uid.layer  > 7                 ||
+                 uid.row    >= OPT__KB__ROWS    ||
+                 uid.column >= OPT__KB__COLUMNS ||
+                 _find(uid) != NONE )
+                break;  // (shouldn't happen)
+            if (_add(uid, offset, bytes))
+                break;  // no room (`OPT__EEPROM_MACRO__INDEX_SIZE` shrank)
+        }
+
+        offset += size;
+    }
+    _space.end = offset;
+
+    // - if we stopped early, make sure whatever's there is ignored from now on
+    if (offset < length && eeprom__read(_address(offset)) != TYPE_END)
+        eeprom__write(_address(offset), TYPE_END);
+
     return 0;
 }
 
 uint8_t eeprom_macro__record_init(void) {
+    _record.recording = false;
+
+    if (_record.writing || _available() < _size(0))
+        return 1;  // error: not enough memory left to record
+
+    _record.recording = true;
+    _record.length    = 0;
+    _record.last[0]   = NONE;
+    _record.last[1]   = NONE;
+    _record.last[2]   = NONE;
     return 0;
 }
 
 uint8_t eeprom_macro__record_keystroke( bool    pressed,
                                         uint8_t row,
                                         uint8_t column ) {
+    if (!_record.recording)
+        return 1;  // error: not recording
+
+    if (row >= OPT__KB__ROWS || column >= OPT__KB__COLUMNS)
+        return 1;  // error: invalid position
+
+    // - `_encode()` takes at most 2 bytes
+    if ( _record.length + 2 > OPT__EEPROM_MACRO__RECORD_SIZE ||
+         _available() < _size(_record.length+2) )
+        return 1;  // error: not enough memory left to record
+
+    _encode(pressed, row * OPT__KB__COLUMNS + column);
     return 0;
 }
 
 uint8_t eeprom_macro__record_finalize(eeprom_macro__uid_t index) {
+    if (!_record.recording)
+        return 1;  // error: not recording
+    _record.recording = false;
+
+    if ( index.layer  > 7                 ||
+         index.row    >= OPT__KB__ROWS    ||
+         index.column >= OPT__KB__COLUMNS )
+        return 1;  // error: can't record a macro for this UID
+
+    uint8_t old = _find(index);
+    uint8_t available = _available();
+    if (old != NONE)
+        available += _size(_index[old].length);
+
+    if (available < _size(_record.length))
+        return 1;  // error: not enough memory left
+    if (old == NONE && _free() == NONE)
+        return 1;  // error: too many macros
+
+    if (old != NONE && _delete(old))
+        return 1;  // error: couldn't delete the old macro
+
+    _record.writing = true;
+    _record.uid     = index;
+    _record.written = 0;
+    _write_step(NULL);
+
     return 0;
 }
 
 uint8_t eeprom_macro__exists(eeprom_macro__uid_t index) {
-    // TODO
-    return 0;
-
-
+    return _find(index) != NONE;
 }
 
 uint8_t eeprom_macro__play(eeprom_macro__uid_t index) {
+    if (_play.playing)
+        return 1;  // error: another macro is playing
+
+    uint8_t i = _find(index);
+    if (i == NONE)
+        return 1;  // error: macro does not exist
+
+    _play.offset  = _index[i].offset;
+    _play.length  = _index[i].length;
+    _play.next    = 0;
+    _play.taps    = 0;
+    _play.half    = false;
+    _play.wrapped = false;
+
+    // - we're probably being called from `kb__layout__exec_key()`, so don't
+    //   play anything until it's returned
+    _play.event = timer__schedule_cycles(1, &_play_step, NULL);
+    if (!_play.event)
+        return 1;  // error: couldn't schedule playback
+
+    _play.playing = true;
     return 0;
 }
 
 void eeprom_macro__clear(eeprom_macro__uid_t index) {
+    if (_record.writing && _bits(_record.uid) == _bits(index)) {
+        _record.writing = false;
+        timer__cancel(_record.event);
+    }
+
+    uint8_t i = _find(index);
+    if (i != NONE)
+        _delete(i);
 }
 
 void eeprom_macro__clear_all(void) {
+    if (eeprom__write(_address(0), TYPE_END))
+        return;  // error: write failed
+
+    _space.end     = 0;
+    _space.deleted = 0;
+    _forget();
+
+    if (_record.writing)
+        timer__cancel(_record.event);
+
+    _record.recording = false;
+    _record.writing   = false;
+
+    // - don't stop a macro that's playing outright: that would leave the key
+    //   it's tapping (and the modifier it's holding, if any) pressed.  Cut it
+    //   off after the current `action` instead, so `_play_step()` plays only
+    //   the releases still owed, and then stops (without reading the EEPROM).
+    if (_play.playing) {
+        _play.taps   = _play.half;
+        _play.length = _play.next;
+    }
+}
+
+uint8_t eeprom_macro__remap(eeprom_macro__uid_t index, uint16_t action) {
+    if ( index.layer  > 7                 ||
+         index.row    >= OPT__KB__ROWS    ||
+         index.column >= OPT__KB__COLUMNS ||
+         (action & 0x8000) )
+        return 1;  // error: can't remap this position (or to this action)
+
+    uint8_t old = _remap_find(index.layer, index.row, index.column);
+    if (old != UINT8_MAX && _remap[old].action == action)
+        return 0;  // nothing to do
+
+    // - the old element (if any) is cleared first, and then the new action
+    //   goes in an unused one; so if the power goes out part way through,
+    //   the position maps to its old action, or to nothing, or to its new
+    //   action, but never to a mix of them
+    // - for this, we keep one element unused, for changing a position that's
+    //   already remapped
+    uint8_t i      = UINT8_MAX;
+    uint8_t unused = 0;
+    for (uint8_t j=0; j<OPT__EEPROM_MACRO__REMAP_SIZE; j++) {
+        if (_remap[j].action & 0x8000) {
+            if (i == UINT8_MAX)
+                i = j;
+            unused++;
+        }
+    }
+    if ( i == UINT8_MAX || (old == UINT8_MAX && unused < 2) )
+        return 1;  // error: no room
+
+    if ( old != UINT8_MAX && _remap_set(old, (remap) { .action = 0xFFFF }) )
+        return 1;  // error: write failed
+
+    return _remap_set( i, (remap) { .layer  = index.layer,
+                                    .row    = index.row,
+                                    .column = index.column,
+                                    .action = action } );
 }
 
+bool eeprom_macro__remap_read(eeprom_macro__uid_t index, uint16_t * action) {
+    if ( index.layer > 7 ||
+         !(eeprom_macro__remapped[index.row][index.column]
+             & (1<<index.layer)) )
+        return false;
+
+    *action = _remap[ _remap_find(index.layer, index.row, index.column) ]
+              .action;
+    return true;
+}
+
+void eeprom_macro__remap_clear(eeprom_macro__uid_t index) {
+    if (index.row >= OPT__KB__ROWS || index.column >= OPT__KB__COLUMNS)
+        return;
+
+    uint8_t i = _remap_find(index.layer, index.row, index.column);
+    if (i != UINT8_MAX)
+        _remap_set(i, (remap) { .action = 0xFFFF });
+}
+
+void eeprom_macro__remap_clear_all(void) {
+    for (uint8_t i=0; i<OPT__EEPROM_MACRO__REMAP_SIZE; i++)
+        if (!(_remap[i].action & 0x8000))
+            _remap_set(i, (remap) { .action = 0xFFFF });
+}
+
+uint16_t eeprom_macro__remap_generation(void) {
+    return _remap_generation;
+}
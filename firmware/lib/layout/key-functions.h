@@ -16,10 +16,56 @@
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // ----------------------------------------------------------------------------
 
+typedef enum {
+    KEY_FUNCTIONS__SRAM,
+    KEY_FUNCTIONS__PROGMEM,
+    KEY_FUNCTIONS__EEPROM,
+} key_functions__memory_t;
+
+typedef enum {
+    KEY_FUNCTIONS__UNICODE__WINDOWS,
+    KEY_FUNCTIONS__UNICODE__MACOS,
+    KEY_FUNCTIONS__UNICODE__LINUX,
+} key_functions__unicode_method_t;
+
+typedef enum {
+    KEY_FUNCTIONS__DUAL_ROLE__TAPPING_TERM,
+    KEY_FUNCTIONS__DUAL_ROLE__PERMISSIVE_HOLD,
+    KEY_FUNCTIONS__DUAL_ROLE__HOLD_ON_OTHER_KEY_PRESS,
+} key_functions__dual_role_policy_t;
+
+typedef struct {
+    uint8_t  size;
+    uint16_t action;
+} key_functions__combo_t;
+
+typedef struct key_functions__leader_node key_functions__leader_node_t;
+
+typedef struct {
+    uint16_t                             action;
+    const key_functions__leader_node_t * next;
+} key_functions__leader_edge_t;
+
+struct key_functions__leader_node {
+    uint16_t                             action;
+    uint8_t                              count;
+    const key_functions__leader_edge_t * edges;
+};
+
+#define  KEY_FUNCTIONS__MACRO__END      0x0000
+#define  KEY_FUNCTIONS__MACRO__PRESS    0x8000
+#define  KEY_FUNCTIONS__MACRO__RELEASE  0x9000
+#define  KEY_FUNCTIONS__MACRO__SEND     0xA000
+#define  KEY_FUNCTIONS__MACRO__DELAY    0xB000
+#define  KEY_FUNCTIONS__MACRO__TYPE     0xC000
+
+// ----------------------------------------------------------------------------
+
 // basic
 void key_functions__press   (uint8_t keycode);
 void key_functions__release (uint8_t keycode);
@@ -31,7 +77,76 @@ void key_functions__jump_to_bootloader (void);
 // special
 void key_functions__toggle_capslock (void);
 void key_functions__type_byte_hex   (uint8_t byte);
-void key_functions__type_string     (const char * string);
+
+// typing
+uint8_t key_functions__type_string      (const char * string);
+uint8_t key_functions__type_string_from ( key_functions__memory_t memory,
+                                          const char *            string );
+bool    key_functions__is_typing        (void);
+void    key_functions__cancel_typing    (void);
+// -------
+void key_functions__set_unicode_method (key_functions__unicode_method_t m);
+key_functions__unicode_method_t key_functions__get_unicode_method (void);
+
+// dual-role
+uint8_t key_functions__dual_role_press
+                    ( uint8_t                           row,
+                      uint8_t                           column,
+                      uint16_t                          tap,
+                      uint16_t                          hold,
+                      key_functions__dual_role_policy_t policy,
+                      void (*exec)(bool pressed, uint16_t action) );
+bool    key_functions__dual_role_filter
+                    ( bool    pressed,
+                      uint8_t row,
+                      uint8_t column,
+                      void (*next)( bool pressed,
+                                    uint8_t row, uint8_t column ) );
+
+// one-shot
+void key_functions__one_shot_press   ( uint16_t action,
+                                       void (*exec)(bool pressed,
+                                                    uint16_t action) );
+void key_functions__one_shot_release ( uint16_t action,
+                                       void (*exec)(bool pressed,
+                                                    uint16_t action) );
+
+// leader
+void key_functions__leader_start
+                    ( const key_functions__leader_node_t * root,
+                      void (*exec)(bool pressed, uint16_t action) );
+bool key_functions__leader_filter( bool     pressed,
+                                   uint8_t  row,
+                                   uint8_t  column,
+                                   uint16_t action );
+
+// tap-dance
+void key_functions__tap_dance_press
+                    ( uint8_t          row,
+                      uint8_t          column,
+                      const uint16_t * actions,
+                      uint8_t          size,
+                      uint16_t         hold,
+                      void (*exec)(bool pressed, uint16_t action) );
+void key_functions__tap_dance_release   (uint8_t row, uint8_t column);
+void key_functions__tap_dance_interrupt (uint8_t row, uint8_t column);
+
+// macro
+uint8_t key_functions__macro_play       ( const uint16_t * macro,
+                                          void (*exec)(bool pressed,
+                                                       uint16_t action) );
+bool    key_functions__macro_is_playing (void);
+
+// combo
+bool key_functions__combo_filter
+                    ( bool                           pressed,
+                      uint8_t                        row,
+                      uint8_t                        column,
+                      uint16_t                       set,
+                      const key_functions__combo_t * combos,
+                      void (*exec)(bool pressed, uint16_t action),
+                      void (*next)( bool pressed,
+                                    uint8_t row, uint8_t column ) );
 
 
 // ----------------------------------------------------------------------------
@@ -44,6 +159,111 @@ void key_functions__type_string     (const char * string);
 // === documentation ==========================================================
 // ============================================================================
 
+// ----------------------------------------------------------------------------
+// types ----------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// === key_functions__memory_t ===
+/**                                   types/key_functions__memory_t/description
+ * The memory space a pointer points into
+ *
+ * Members:
+ * - `KEY_FUNCTIONS__SRAM`
+ * - `KEY_FUNCTIONS__PROGMEM`
+ * - `KEY_FUNCTIONS__EEPROM`
+ */
+
+// === key_functions__unicode_method_t ===
+/**                           types/key_functions__unicode_method_t/description
+ * The ways of typing an arbitrary unicode character (a "unicode sequence")
+ *
+ * Members:
+ * - `KEY_FUNCTIONS__UNICODE__WINDOWS`: Hold "alt", type "+" (on the keypad),
+ *   type the code point in hex, release "alt".
+ *     - Make sure the registry key
+ *       `HKEY_CURRENT_USER\Control Panel\Input Method\EnableHexNumpad` has a
+ *       string value of `1`.  If it does not, fix it, then reboot (or log
+ *       off/on, in Windows 7+).
+ *     - Code points above U+FFFF are typed with 5 or 6 digits, which only some
+ *       applications accept.
+ * - `KEY_FUNCTIONS__UNICODE__MACOS`: Hold "option", type the code point in
+ *   hex (as a UTF-16 surrogate pair, for code points above U+FFFF), release
+ *   "option".
+ *     - Open "System Preferences", navigate to "Language & Text" (or
+ *       "Keyboard"), select the "Input Sources" tab, and add "Unicode Hex
+ *       Input".  Make sure this input method is active whenever you use this
+ *       method.  Note that this will render all the normal "option" special
+ *       characters unavailable.
+ * - `KEY_FUNCTIONS__UNICODE__LINUX`: Type "ctrl+shift+u", type the code point
+ *   in hex, type "space".
+ *     - This is the IBus (and GTK) method, which most desktop environments
+ *       support out of the box.
+ *
+ * See [this Wikipedia article]
+ * (http://en.wikipedia.org/wiki/Unicode_input#Hexadecimal_code_input) for
+ * more information.
+ */
+
+// === key_functions__dual_role_policy_t ===
+/**                         types/key_functions__dual_role_policy_t/description
+ * How a dual-role key decides between its "tap" and "hold" roles, while it's
+ * pressed and undecided
+ *
+ * Members:
+ * - `KEY_FUNCTIONS__DUAL_ROLE__TAPPING_TERM`: Only time matters.  Released
+ *   within `OPT__KEY_FUNCTIONS__TAPPING_TERM` milliseconds is a "tap"; still
+ *   held after that is a "hold".  Other key events are held back until the
+ *   dual-role key is decided, and then replayed in order (so they happen
+ *   after the "tap", or with the "hold" active).
+ * - `KEY_FUNCTIONS__DUAL_ROLE__PERMISSIVE_HOLD`: As above, except that if
+ *   another key is pressed *and released* while the dual-role key is held, the
+ *   dual-role key is a "hold" right away.
+ * - `KEY_FUNCTIONS__DUAL_ROLE__HOLD_ON_OTHER_KEY_PRESS`: As with
+ *   `...TAPPING_TERM`, except that pressing any other key immediately makes
+ *   the dual-role key a "hold" (before the other key is executed).
+ *
+ * Notes:
+ * - Other keys are only ever delayed while a dual-role key using
+ *   `...TAPPING_TERM` or `...PERMISSIVE_HOLD` is undecided.  Otherwise
+ *   (including while one using `...HOLD_ON_OTHER_KEY_PRESS` is undecided),
+ *   keys are executed right away.
+ */
+
+// === key_functions__combo_t ===
+/**                                    types/key_functions__combo_t/description
+ * An entry in a (PROGMEM) table of combos (sets of keys that do something
+ * different when pressed together)
+ *
+ * Struct members:
+ * - `size`: The number of keys in the combo
+ * - `action`: The action to perform when they're all pressed
+ *
+ * Notes:
+ * - Which keys belong to which combo is given per key, not per combo: each
+ *   key position has a "set" (a bitmask with bit `i` set if the key is part
+ *   of combo `i`; see `key_functions__combo_filter()`).  So a table can have
+ *   at most 16 combos.
+ */
+
+
+// === key_functions__leader_node_t ===
+/**                              types/key_functions__leader_node_t/description
+ * A node in a (PROGMEM) trie of leader key sequences
+ *
+ * Struct members:
+ * - `action`: The action to perform if the sequence ends at this node, or `0`
+ *   if it can't
+ * - `count`: The number of edges leaving this node
+ * - `edges`: A pointer to the (PROGMEM) array of edges leaving this node
+ *
+ * Notes:
+ * - Each edge (`key_functions__leader_edge_t`) is labeled with the action
+ *   code of a key (so, e.g., the edge for "g" is labeled with the action code
+ *   of the key that types "g"), and points to the node for the sequence with
+ *   that key added.
+ * - The root node is the sequence with no keys in it (after the leader key).
+ */
+
 // ----------------------------------------------------------------------------
 // functions ------------------------------------------------------------------
 // ----------------------------------------------------------------------------
@@ -105,6 +325,9 @@ void key_functions__type_string     (const char * string);
  * - `byte`: The byte to send a representation of
  */
 
+// ----------------------------------------------------------------------------
+// typing ---------------------------------------------------------------------
+
 // === key_functions__type_string() ===
 /**                            functions/key_functions__type_string/description
  * Type the keycode (or "unicode sequence") for each character in `string`
@@ -112,13 +335,26 @@ void key_functions__type_string     (const char * string);
  * Arguments:
  * - `string`: A pointer to a valid UTF-8 string in PROGMEM
  *
+ * Returns:
+ * - success: `0` (the string will be typed)
+ * - failure: [other] (another string is still being typed)
+ *
  *
  * Notes:
  *
- * - A "unicode sequence" is holding down "alt", typing "+", typing the 4
- *   character hexadecimal unicode code for the specified character, then
- *   releasing "alt".  This is done for every character in `string` for which a
- *   dedicated USB keycode has not been specified.
+ * - This function returns immediately: the string is typed in the background,
+ *   at most one USB report per frame, while scanning continues as normal.
+ *   Use `key_functions__is_typing()` to find out when it's done, and
+ *   `key_functions__cancel_typing()` to stop early.
+ *
+ * - The string must remain valid (and unchanged) until typing is done.
+ *
+ * - A "unicode sequence" is typed for every character in `string` for which a
+ *   dedicated USB keycode has not been specified (i.e. everything besides
+ *   printable 7-bit ASCII, and a few control characters).  How it's typed
+ *   depends on the current unicode method (see
+ *   `key_functions__set_unicode_method()`).  All of unicode (including code
+ *   points above U+FFFF) is supported, as far as the method allows.
  *
  * - This function is, relative to the rest of life, extremely unportable.
  *   Sorry about that: I looked for a better way to do things, but I couldn't
@@ -131,28 +367,8 @@ void key_functions__type_string     (const char * string);
  *
  * Operating system considerations (for typing "unicode sequences"):
  *
- * - "Unicode sequences", as implemented, should work on OS X and Windows
- *   (after enabling "hexidecimal code input" in the OS), but probably will not
- *   work on Linux (2 out of 3 of the major OSs is better than nothing...).  If
- *   you're using Linux and you want to flip that around :) please modify the
- *   function to send Linux friendly start and end sequences.  See [this
- *   Wikipedia article]
- *   (http://en.wikipedia.org/wiki/Unicode_input#Hexadecimal_code_input) for
- *   more information.
- *
- * - On Windows (per the Wikipedia article above): Make sure the registry key
- *   `HKEY_CURRENT_USER\Control Panel\Input Method\EnableHexNumpad` has a
- *   string value of `1`.  If it does not, fix it, then reboot (or log off/on,
- *   in Windows 7+)
- *
- * - On OS X: open "System Preferences", navigate to "Language & Text", select
- *   the "Input Sources" tab (if it isn't selected already), and check the box
- *   next to "Unicode Hex Input".  Make sure this input method is active
- *   whenever you use this function.
- *     - I recommend disabling the default (in the US at least) "U.S." input
- *       method, and just leaving this one active all the time.  Note though
- *       that this will render all the normal "Alt" special characters
- *       unavailable.
+ * - Each OS needs a different method, and usually some setup first.  See the
+ *   documentation for `key_functions__unicode_method_t`.
  *
  *
  * Usage notes:
@@ -160,6 +376,9 @@ void key_functions__type_string     (const char * string);
  * - Characters (and strings) sent with this function do not automatically
  *   repeat (as normal keys do).
  *
+ * - Keys pressed or released by the user while a string is being typed are
+ *   sent along with the string's reports, as usual.
+ *
  * - Please pay very special attention to what this function is actually typing
  *   if you are using any language besides English as the default in your OS,
  *   or if you have characters that aren't 7-bit ASCII in your string and have
@@ -183,3 +402,295 @@ void key_functions__type_string     (const char * string);
  *               "こんにちは世界 γειά σου κόσμε hello world ^_^" ) );
  */
 
+// === key_functions__type_string_from() ===
+/**                       functions/key_functions__type_string_from/description
+ * Like `key_functions__type_string()`, but for a string in any memory space
+ *
+ * Arguments:
+ * - `memory`: The memory space `string` points into
+ * - `string`: A pointer to a valid UTF-8 string
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (another string is still being typed)
+ */
+
+// === key_functions__is_typing() ===
+/**                              functions/key_functions__is_typing/description
+ * Return whether a string is currently being typed
+ */
+
+// === key_functions__cancel_typing() ===
+/**                          functions/key_functions__cancel_typing/description
+ * Stop typing the current string (if any)
+ *
+ * Notes:
+ * - Typing stops at the end of the current character (or run of characters;
+ *   a few frames at most), so that nothing is left held down, and a unicode
+ *   sequence is never cut off part way through.  Until then,
+ *   `key_functions__is_typing()` still returns `true`.
+ */
+
+// === key_functions__set_unicode_method() ===
+/**                     functions/key_functions__set_unicode_method/description
+ * Set the method used to type "unicode sequences"
+ *
+ * Arguments:
+ * - `m`: The method to use from now on
+ *
+ * Notes:
+ * - The default is `KEY_FUNCTIONS__UNICODE__WINDOWS`.
+ * - Changing the method while a string is being typed affects the rest of the
+ *   string.
+ */
+
+// === key_functions__get_unicode_method() ===
+/**                     functions/key_functions__get_unicode_method/description
+ * Return the method currently used to type "unicode sequences"
+ */
+
+// === key_functions__dual_role_press() ===
+/**                        functions/key_functions__dual_role_press/description
+ * Start a dual-role key (a key that does one thing when tapped, and another
+ * when held)
+ *
+ * Arguments:
+ * - `row`, `column`: The position of the key (so that its release can be
+ *   recognized by `key_functions__dual_role_filter()`)
+ * - `tap`: The action to perform (press, then release) if the key is tapped
+ * - `hold`: The action to press if the key is held (it will be released when
+ *   the key is)
+ * - `policy`: How to decide between the two (see
+ *   `key_functions__dual_role_policy_t`)
+ * - `exec`: The function to call to press (`pressed == true`) or release
+ *   (`pressed == false`) `tap` or `hold`
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (too many dual-role keys pressed at once)
+ *
+ * Notes:
+ * - What `tap` and `hold` mean is entirely up to `exec` (which will usually
+ *   be the layout's own function for executing an action).
+ * - If another dual-role key is still undecided when this one is pressed, it
+ *   is decided first (per its policy, this key counts as the "other key").
+ */
+
+// === key_functions__dual_role_filter() ===
+/**                       functions/key_functions__dual_role_filter/description
+ * Give the dual-role engine a chance to look at (and possibly take) a key
+ * event, before it is executed
+ *
+ * Arguments:
+ * - `pressed`: Whether the key was pressed (or released)
+ * - `row`, `column`: The position of the key
+ * - `next`: The function to call to execute events that were held back (this
+ *   should do whatever the caller would have done with an event for which
+ *   this function returned `false`)
+ *
+ * Returns:
+ * - `true`: if the event was handled (or held back, to be replayed later),
+ *   and should not be executed
+ * - `false`: if the event should be executed normally
+ *
+ * Notes:
+ * - This must be called by the layout for every key event, before doing
+ *   anything else with it.  When no dual-role key is pressed, it returns
+ *   `false` right away.
+ */
+
+// === key_functions__one_shot_press() ===
+/**                         functions/key_functions__one_shot_press/description
+ * Press a one-shot (or "sticky") key: one that, if tapped, stays pressed
+ * until the next keypress is over
+ *
+ * Arguments:
+ * - `action`: The action to perform (this also identifies the key, so no two
+ *   one-shot keys should have the same action)
+ * - `exec`: The function to call to press (`pressed == true`) or release
+ *   (`pressed == false`) `action`
+ *
+ * Notes:
+ * - If another key is pressed while this one is held, this one acts like a
+ *   normal key (and is released when it is).
+ * - "The next keypress" means the next time `timer___tick_keypresses()` is
+ *   called.  Layouts shouldn't tick keypresses for modifiers, layer keys, or
+ *   other one-shot keys, so that (e.g.) tapping "shift" and then "ctrl" as
+ *   one-shot keys applies both to the next letter.
+ * - An armed key is released after `OPT__KEY_FUNCTIONS__ONE_SHOT_TIMEOUT`
+ *   milliseconds, if no other key has been pressed.  If
+ *   `OPT__KEY_FUNCTIONS__ONE_SHOT_LOCK` is set, tapping it again while it's
+ *   armed locks it (until it's tapped a third time).
+ */
+
+// === key_functions__one_shot_release() ===
+/**                       functions/key_functions__one_shot_release/description
+ * Release a one-shot key (see `key_functions__one_shot_press()`)
+ *
+ * Arguments:
+ * - `action`, `exec`: As passed to `key_functions__one_shot_press()`
+ */
+
+// === key_functions__leader_start() ===
+/**                           functions/key_functions__leader_start/description
+ * Start a leader key sequence
+ *
+ * Arguments:
+ * - `root`: A pointer to the (PROGMEM) root node of the trie of sequences
+ * - `exec`: The function to call to press (`pressed == true`) and release
+ *   (`pressed == false`) the action of the sequence typed
+ *
+ * Notes:
+ * - Until the sequence ends, every key press is taken by
+ *   `key_functions__leader_filter()`, and used to walk down the trie.  The
+ *   sequence ends when it reaches a node with no edges, or when a key with no
+ *   edge is pressed (in which case nothing is performed), or when
+ *   `OPT__KEY_FUNCTIONS__LEADER_TIMEOUT` milliseconds pass without a key being
+ *   pressed.
+ */
+
+// === key_functions__leader_filter() ===
+/**                          functions/key_functions__leader_filter/description
+ * Give the leader engine a chance to take a key event, before it is executed
+ *
+ * Arguments:
+ * - `pressed`: Whether the key was pressed (or released)
+ * - `row`, `column`: The position of the key
+ * - `action`: The action code of the key
+ *
+ * Returns:
+ * - `true`: if the event was part of a leader sequence, and should not be
+ *   executed
+ * - `false`: if the event should be executed normally
+ *
+ * Notes:
+ * - Releases of keys whose presses were taken are taken as well.
+ * - Layouts will probably not want to pass modifiers to this function (so
+ *   that, e.g., "shift" can be used to type a capital letter in a sequence).
+ */
+
+// === key_functions__tap_dance_press() ===
+/**                        functions/key_functions__tap_dance_press/description
+ * Press a tap-dance key (a key whose action depends on how many times it's
+ * tapped in quick succession, and on whether the last press is held)
+ *
+ * Arguments:
+ * - `row`, `column`: The position of the key
+ * - `actions`: A pointer to a (PROGMEM) array of actions, where
+ *   `actions[n-1]` is the action for `n` taps
+ * - `size`: The number of elements in `actions` (must be at least `1`)
+ * - `hold`: The action to press if the last press is held (it will be
+ *   released when the key is), or `0` to hold the action for the count
+ * - `exec`: The function to call to press (`pressed == true`) or release
+ *   (`pressed == false`) an action
+ *
+ * Notes:
+ * - Pressing a different tap-dance key settles the current one first.
+ * - See ".../key-functions/tap-dance.c" for exactly when a dance is settled.
+ */
+
+// === key_functions__tap_dance_release() ===
+/**                      functions/key_functions__tap_dance_release/description
+ * Release a tap-dance key
+ *
+ * Arguments:
+ * - `row`, `column`: The position of the key
+ */
+
+// === key_functions__tap_dance_interrupt() ===
+/**                    functions/key_functions__tap_dance_interrupt/description
+ * Settle the current tap-dance (if any), because the key at the given position
+ * is being pressed
+ *
+ * Arguments:
+ * - `row`, `column`: The position of the key being pressed
+ *
+ * Notes:
+ * - This should be called by the layout before executing each key press, so
+ *   that the dance's action comes before the other key's.  Does nothing if
+ *   the key being pressed is the one dancing.
+ */
+
+// === key_functions__macro_play() ===
+/**                             functions/key_functions__macro_play/description
+ * Play a macro
+ *
+ * Arguments:
+ * - `macro`: A pointer to the (PROGMEM) macro, a list of instructions ending
+ *   with `KEY_FUNCTIONS__MACRO__END`
+ * - `exec`: The function to call to press (`pressed == true`) or release
+ *   (`pressed == false`) each action in the macro
+ *
+ * Instructions:
+ * - `KEY_FUNCTIONS__MACRO__END`: The end of the macro
+ * - Any other word with bit 15 clear (i.e. any action code besides `0`): Tap
+ *   the action (press it, queue a report, release it, queue a report)
+ * - `KEY_FUNCTIONS__MACRO__PRESS`, followed by an action code: Press the
+ *   action (without queuing a report)
+ * - `KEY_FUNCTIONS__MACRO__RELEASE`, followed by an action code: Release the
+ *   action (without queuing a report)
+ * - `KEY_FUNCTIONS__MACRO__SEND`: Queue a report
+ * - `KEY_FUNCTIONS__MACRO__DELAY | milliseconds`: Wait (up to 4095
+ *   milliseconds)
+ * - `KEY_FUNCTIONS__MACRO__TYPE`, followed by the address of a (PROGMEM)
+ *   string: Type the string (see `key_functions__type_string()`), and wait
+ *   until it's done
+ *
+ * Returns:
+ * - success: `0` (the macro will be played)
+ * - failure: [other] (too many macros are waiting to be played)
+ *
+ * Notes:
+ * - This function returns right away: the macro is played in the background
+ *   (like strings are typed; see `key_functions__type_string()`), at most one
+ *   USB report per frame, while scanning continues as normal.
+ * - Macros given while another is playing are played after it, in order.
+ * - What an action code means is up to `exec`, so layer keys (and anything
+ *   else the layout can do) can be pressed and released in a macro the same
+ *   as regular keys.
+ * - A tap takes one word, so a macro that only taps keys is no bigger than a
+ *   plain list of action codes.
+ */
+
+// === key_functions__macro_is_playing() ===
+/**                       functions/key_functions__macro_is_playing/description
+ * Return whether a macro is playing (or waiting to be played)
+ */
+
+// === key_functions__combo_filter() ===
+/**                           functions/key_functions__combo_filter/description
+ * Give the combo engine a chance to look at (and possibly take) a key event,
+ * before it is executed
+ *
+ * Arguments:
+ * - `pressed`: Whether the key was pressed (or released)
+ * - `row`, `column`: The position of the key
+ * - `set`: The combos the key is part of (bit `i` is set if the key is part of
+ *   `combos[i]`)
+ * - `combos`: A pointer to the (PROGMEM) table of combos
+ * - `exec`: The function to call to press (`pressed == true`) or release
+ *   (`pressed == false`) a combo's action
+ * - `next`: The function to call to execute events that turned out not to be
+ *   part of a combo (this should do whatever the caller would have done with
+ *   an event for which this function returned `false`)
+ *
+ * Returns:
+ * - `true`: if the event was handled (or held back, to be replayed later),
+ *   and should not be executed
+ * - `false`: if the event should be executed normally
+ *
+ * Notes:
+ * - Presses of keys that are part of a combo are held back for up to
+ *   `OPT__KEY_FUNCTIONS__COMBO_TERM` milliseconds, to see if the rest of the
+ *   combo follows.  If every key of a combo is pressed (and nothing else is)
+ *   the combo's action is pressed, and released when the first of its keys
+ *   is.  Otherwise (time runs out, a key is released, or a key that can't
+ *   complete any of the remaining combos is pressed) the events held back are
+ *   passed to `next`, in the order they happened.
+ * - The combos still possible are kept as the bitwise AND of the `set`s of
+ *   the keys held back so far, so the work done per event doesn't depend on
+ *   the number of combos.
+ * - When no combo key is pressed, and `set` is `0`, this returns `false`
+ *   right away.
+ */
+
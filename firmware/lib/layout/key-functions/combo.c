@@ -0,0 +1,294 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the "combo" section of "../key-functions.h"
+ *
+ * While keys are held back, `_state.candidates` is the set of combos they
+ * could still be the start of.  Each new press narrows it down with a single
+ * AND.  A combo matches when it's the only candidate left and all its keys
+ * are pressed; if other (larger) candidates are still possible, we wait for
+ * them until a key is released or time runs out, and then take the one that
+ * matches exactly, if there is one.
+ *
+ * While keys are held back, `_check()` is scheduled (with the milliseconds
+ * timer) to run when the combo term is up, and canceled if they're settled
+ * before then.  Nothing runs during a scan.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "../../../../firmware/lib/timer.h"
+#include "../key-functions.h"
+
+// ----------------------------------------------------------------------------
+
+#ifndef OPT__KEY_FUNCTIONS__COMBO_TERM
+    #error "OPT__KEY_FUNCTIONS__COMBO_TERM not defined"
+#endif
+
+/**                           macros/OPT__KEY_FUNCTIONS__COMBO_TERM/description
+ * The number of milliseconds, after the first key of a possible combo is
+ * pressed, to wait for the rest of it
+ *
+ * Notes:
+ * - Every key that's part of a combo is delayed (by up to this long) when it's
+ *   pressed, so this should be as short as is comfortable.
+ */
+
+// ----------------------------------------------------------------------------
+
+/**                                                macros/_KEYS_MAX/description
+ * The maximum number of keys in a combo (and so the number of key presses
+ * that can be held back at once)
+ */
+#define  _KEYS_MAX  4
+
+/**                                              macros/_ACTIVE_MAX/description
+ * The number of combos that can be pressed at once
+ */
+#define  _ACTIVE_MAX  2
+
+// ----------------------------------------------------------------------------
+
+/**                                               types/_position_t/description
+ * The position of a key
+ */
+typedef struct {
+    uint8_t row;
+    uint8_t column;
+} _position_t;
+
+/**                                                 types/_active_t/description
+ * A combo that has matched, and some of whose keys are still pressed
+ *
+ * Struct members:
+ * - `keys`: The positions of the keys in the combo
+ * - `size`: The number of keys in the combo
+ * - `pressed`: A bitmask of which elements of `keys` are still pressed
+ * - `action`: The action that was pressed
+ * - `exec`: The function to release `action` with
+ */
+typedef struct {
+    _position_t keys[_KEYS_MAX];
+    uint8_t     size;
+    uint8_t     pressed;
+    uint16_t    action;
+    void (*exec)(bool pressed, uint16_t action);
+} _active_t;
+
+// ----------------------------------------------------------------------------
+
+/**                                                variables/_state/description
+ * The state of the combo engine
+ *
+ * Struct members:
+ * - `buffer`: The key presses that have been held back, in order
+ * - `buffered`: The number of presses in `buffer`
+ * - `candidates`: The combos that could still match (meaningless when
+ *   `buffered == 0`)
+ * - `event`: The handle to `_check()`, if it's scheduled to run, or `0`
+ * - `active`: The combos that have matched and are still (partly) pressed
+ * - `used`: A bitmask of which elements of `active` are in use
+ * - `combos`, `exec`, `next`: As last passed to
+ *   `key_functions__combo_filter()`
+ */
+static struct {
+    _position_t    buffer[_KEYS_MAX];
+    uint8_t        buffered;
+    uint16_t       candidates;
+    timer__event_t event;
+    _active_t      active[_ACTIVE_MAX];
+    uint8_t        used;
+    const key_functions__combo_t * combos;
+    void (*exec)(bool pressed, uint16_t action);
+    void (*next)(bool pressed, uint8_t row, uint8_t column);
+} _state;
+
+// ----------------------------------------------------------------------------
+
+/**                                                 functions/_size/description
+ * Return the number of keys in the given combo
+ */
+static uint8_t _size(uint8_t combo) {
+    return pgm_read_byte(&_state.combos[combo].size);
+}
+
+/**                                                 functions/_done/description
+ * Stop holding back presses (once they've been dealt with), and cancel
+ * `_check()`
+ */
+static void _done(void) {
+    _state.buffered = 0;
+
+    timer__cancel(_state.event);
+    _state.event = 0;
+}
+
+/**                                                functions/_flush/description
+ * Pass all held back presses on (in order), since they're not a combo
+ */
+static void _flush(void) {
+    uint8_t buffered = _state.buffered;
+    _done();
+
+    for (uint8_t i=0; i<buffered; i++)
+        (*_state.next)(true, _state.buffer[i].row, _state.buffer[i].column);
+}
+
+/**                                                functions/_match/description
+ * Press the given combo's action, and stop holding back its keys
+ */
+static void _match(uint8_t combo) {
+    uint8_t i = 0;
+    while (i < _ACTIVE_MAX && (_state.used & (1<<i)))
+        i++;
+    if (i == _ACTIVE_MAX) {
+        _flush();  // too many combos pressed at once
+        return;
+    }
+
+    _active_t * active = &_state.active[i];
+    for (uint8_t j=0; j<_state.buffered; j++)
+        active->keys[j] = _state.buffer[j];
+    active->size    = _state.buffered;
+    active->pressed = (1<<_state.buffered)-1;
+    active->action  = pgm_read_word(&_state.combos[combo].action);
+    active->exec    = _state.exec;
+
+    _state.used |= (1<<i);
+    _done();
+
+    (*active->exec)(true, active->action);
+}
+
+/**                                               functions/_settle/description
+ * Decide what the held back presses are, now that no more keys will be added
+ * to them
+ *
+ * Notes:
+ * - If more than one candidate matches exactly (i.e. two combos have the same
+ *   keys), the one with the lowest index wins.
+ * - This looks at each bit of `_state.candidates`, but only runs once for each
+ *   group of held back keys.
+ */
+static void _settle(void) {
+    for (uint8_t i=0; i<16; i++) {
+        if ( (_state.candidates & (1U<<i)) && _size(i) == _state.buffered ) {
+            _match(i);
+            return;
+        }
+    }
+    _flush();
+}
+
+/**                                                functions/_check/description
+ * Settle the held back presses, since we've waited the combo term for them
+ */
+static void _check(void * context) {
+    _state.event = 0;  // (the handle is no longer valid)
+
+    if (_state.buffered)
+        _settle();
+}
+
+/**                                              functions/_release/description
+ * Handle the release of a key that's part of an active combo
+ *
+ * Returns:
+ * - `true`: if the key was part of an active combo (and the release has been
+ *   taken care of)
+ * - `false`: otherwise
+ */
+static bool _release(uint8_t row, uint8_t column) {
+    for (uint8_t i=0; i<_ACTIVE_MAX; i++) {
+        if (!(_state.used & (1<<i)))
+            continue;
+
+        _active_t * active = &_state.active[i];
+        for (uint8_t j=0; j<active->size; j++) {
+            if ( !(active->pressed & (1<<j))
+                 || active->keys[j].row    != row
+                 || active->keys[j].column != column )
+                continue;
+
+            // the first key released releases the combo
+            if (active->pressed == (1<<active->size)-1)
+                (*active->exec)(false, active->action);
+
+            active->pressed &= ~(1<<j);
+            if (!active->pressed)
+                _state.used &= ~(1<<i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+
+bool key_functions__combo_filter
+                    ( bool                           pressed,
+                      uint8_t                        row,
+                      uint8_t                        column,
+                      uint16_t                       set,
+                      const key_functions__combo_t * combos,
+                      void (*exec)(bool pressed, uint16_t action),
+                      void (*next)( bool pressed,
+                                    uint8_t row, uint8_t column ) ) {
+
+    if (!set && !_state.buffered && !_state.used)
+        return false;  // nothing to do
+
+    _state.combos = combos;
+    _state.exec   = exec;
+    _state.next   = next;
+
+    // --- releases ---
+
+    if (!pressed) {
+        // anything held back is not a combo (and was pressed before this)
+        if (_state.buffered)
+            _settle();
+        return _release(row, column);
+    }
+
+    // --- presses ---
+
+    // if this key can't be part of the same combo as the ones before it
+    if ( _state.buffered && ( !(_state.candidates & set) ||
+                              _state.buffered == _KEYS_MAX ) )
+        _settle();
+
+    if (!set)
+        return false;
+
+    if (!_state.buffered) {
+        _state.candidates = set;
+        _state.event      = timer__schedule_milliseconds(
+                                OPT__KEY_FUNCTIONS__COMBO_TERM,
+                                &_check, NULL );
+    }
+
+    _state.buffer[_state.buffered++] = (_position_t) { row, column };
+    _state.candidates &= set;
+
+    // if only one candidate is left, and all its keys are pressed, it matches
+    uint16_t candidates = _state.candidates;
+    if ( !(candidates & (candidates-1)) ) {
+        uint8_t i = 0;
+        while (!(candidates & (1U<<i)))
+            i++;
+        if (_size(i) == _state.buffered)
+            _match(i);
+    }
+
+    return true;
+}
+
@@ -0,0 +1,313 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the "dual-role" section of "../key-functions.h"
+ *
+ * A dual-role key is "undecided" from when it's pressed until its role is
+ * known.  At most one key is undecided at a time (pressing a second dual-role
+ * key decides the first).  Once a key is decided to be a "hold", it's kept
+ * track of until it's released, so that the "hold" action can be released
+ * too.  A "tap" is pressed and released as soon as it's decided, so it doesn't
+ * need to be kept track of.
+ *
+ * While a key is undecided, `_check()` is scheduled (with the milliseconds
+ * timer) to run when the tapping term is up, and canceled if the key is
+ * decided before then.  Nothing runs during a scan.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../../../../firmware/lib/timer.h"
+#include "../../../../firmware/lib/usb.h"
+#include "../key-functions.h"
+
+// ----------------------------------------------------------------------------
+
+#ifndef OPT__KEY_FUNCTIONS__TAPPING_TERM
+    #error "OPT__KEY_FUNCTIONS__TAPPING_TERM not defined"
+#endif
+
+/**                         macros/OPT__KEY_FUNCTIONS__TAPPING_TERM/description
+ * The number of milliseconds a dual-role key must be held for before it
+ * becomes a "hold"
+ *
+ * Notes:
+ * - Keys are only scanned every `OPT__DEBOUNCE_TIME` milliseconds, so the
+ *   effective resolution is no better than that.
+ */
+
+// ----------------------------------------------------------------------------
+
+/**                                                macros/_KEYS_MAX/description
+ * The number of dual-role keys that can be pressed at once
+ */
+#define  _KEYS_MAX  4
+
+/**                                             macros/_BUFFER_SIZE/description
+ * The number of key events that can be held back while a `...TAPPING_TERM`
+ * or `...PERMISSIVE_HOLD` key is undecided
+ *
+ * Notes:
+ * - If the buffer fills up, the undecided key becomes a "hold".  It's
+ *   unlikely that someone meant to tap a key when they've pressed this many
+ *   other keys while holding it.
+ */
+#define  _BUFFER_SIZE  4
+
+/**                                                    macros/_NONE/description
+ * The value of `_state.undecided` when no key is undecided
+ */
+#define  _NONE  UINT8_MAX
+
+// ----------------------------------------------------------------------------
+
+/**                                                    types/_key_t/description
+ * A dual-role key that's currently pressed
+ *
+ * Struct members:
+ * - `row`, `column`: The position of the key
+ * - `tap`, `hold`: The actions for each role
+ * - `policy`: How to decide between the two
+ * - `exec`: The function that performs actions
+ */
+typedef struct {
+    uint8_t                           row;
+    uint8_t                           column;
+    uint16_t                          tap;
+    uint16_t                          hold;
+    key_functions__dual_role_policy_t policy;
+    void (*exec)(bool pressed, uint16_t action);
+} _key_t;
+
+/**                                                  types/_event_t/description
+ * A key event that has been held back
+ */
+typedef struct {
+    uint8_t row;
+    uint8_t column;
+    bool    pressed;
+} _event_t;
+
+// ----------------------------------------------------------------------------
+
+/**                                                variables/_state/description
+ * The state of the dual-role engine
+ *
+ * Struct members:
+ * - `keys`: The dual-role keys currently pressed
+ * - `used`: A bitmask of which elements of `keys` are in use
+ * - `undecided`: The index into `keys` of the undecided key, or `_NONE`
+ * - `event`: The handle to `_check()`, if it's scheduled to run, or `0`
+ * - `buffer`: The key events that have been held back
+ * - `buffered`: The number of events in `buffer`
+ * - `next`: The function to replay events with (as last passed to
+ *   `key_functions__dual_role_filter()`)
+ */
+static struct {
+    _key_t         keys[_KEYS_MAX];
+    uint8_t        used;
+    uint8_t        undecided;
+    timer__event_t event;
+    _event_t       buffer[_BUFFER_SIZE];
+    uint8_t        buffered;
+    void (*next)(bool pressed, uint8_t row, uint8_t column);
+} _state = {
+    .undecided = _NONE,
+};
+
+// ----------------------------------------------------------------------------
+
+/**                                                 functions/_find/description
+ * Return the index into `_state.keys` of the dual-role key at the given
+ * position, or `_NONE`
+ */
+static uint8_t _find(uint8_t row, uint8_t column) {
+    for (uint8_t i=0; i<_KEYS_MAX; i++)
+        if ( (_state.used & (1<<i)) &&
+             _state.keys[i].row == row && _state.keys[i].column == column )
+            return i;
+    return _NONE;
+}
+
+/**                                               functions/_decide/description
+ * Forget the undecided key (which is about to be decided), and cancel
+ * `_check()`
+ *
+ * Returns:
+ * - The undecided key
+ */
+static _key_t * _decide(void) {
+    _key_t * key = &_state.keys[_state.undecided];
+    _state.undecided = _NONE;
+
+    timer__cancel(_state.event);
+    _state.event = 0;
+
+    return key;
+}
+
+/**                                               functions/_replay/description
+ * Execute (in order) all the key events that were held back
+ *
+ * Notes:
+ * - The buffer is emptied first, since events may be held back again while
+ *   they're replayed (if one of them presses a dual-role key).
+ */
+static void _replay(void) {
+    _event_t buffer[_BUFFER_SIZE];
+    uint8_t  buffered = _state.buffered;
+
+    for (uint8_t i=0; i<buffered; i++)
+        buffer[i] = _state.buffer[i];
+    _state.buffered = 0;
+
+    for (uint8_t i=0; i<buffered; i++)
+        (*_state.next)( buffer[i].pressed, buffer[i].row, buffer[i].column );
+}
+
+/**                                                 functions/_hold/description
+ * Decide that the undecided key is a "hold"
+ */
+static void _hold(void) {
+    _key_t * key = _decide();
+
+    (*key->exec)(true, key->hold);
+    _replay();
+}
+
+/**                                                  functions/_tap/description
+ * Decide that the undecided key (which has just been released) is a "tap"
+ */
+static void _tap(void) {
+    _key_t * key = _decide();
+    _state.used &= ~(1<<(key - _state.keys));
+
+    (*key->exec)(true, key->tap);
+    usb__kb__send_report();
+    (*key->exec)(false, key->tap);
+    _replay();
+}
+
+/**                                                functions/_check/description
+ * Decide that the undecided key is a "hold", since it's been held for the
+ * tapping term
+ */
+static void _check(void * context) {
+    _state.event = 0;  // (the handle is no longer valid)
+
+    if (_state.undecided != _NONE)
+        _hold();
+}
+
+// ----------------------------------------------------------------------------
+
+uint8_t key_functions__dual_role_press
+                    ( uint8_t                           row,
+                      uint8_t                           column,
+                      uint16_t                          tap,
+                      uint16_t                          hold,
+                      key_functions__dual_role_policy_t policy,
+                      void (*exec)(bool pressed, uint16_t action) ) {
+
+    // - while a key is undecided, the filter holds back (or decides on) the
+    //   events of every other key, so this shouldn't happen; but if it does,
+    //   it's still better than losing track of the first key
+    if (_state.undecided != _NONE)
+        _hold();
+
+    uint8_t i = 0;
+    while (i < _KEYS_MAX && (_state.used & (1<<i)))
+        i++;
+    if (i == _KEYS_MAX)
+        return 1;  // error: too many dual-role keys pressed
+
+    _state.keys[i] = (_key_t) {
+        .row    = row,
+        .column = column,
+        .tap    = tap,
+        .hold   = hold,
+        .policy = policy,
+        .exec   = exec,
+    };
+    _state.used      |= (1<<i);
+    _state.undecided  = i;
+    _state.event      = timer__schedule_milliseconds(
+                            OPT__KEY_FUNCTIONS__TAPPING_TERM, &_check, NULL );
+
+    return 0;
+}
+
+bool key_functions__dual_role_filter
+                    ( bool    pressed,
+                      uint8_t row,
+                      uint8_t column,
+                      void (*next)( bool pressed,
+                                    uint8_t row, uint8_t column ) ) {
+
+    _state.next = next;
+
+    if (!_state.used)
+        return false;  // nothing to do
+
+    uint8_t i = _find(row, column);
+
+    // --- the dual-role key itself ---
+
+    if (i != _NONE) {
+        if (pressed)
+            return false;  // (shouldn't happen)
+
+        if (i == _state.undecided) {
+            _tap();
+        } else {
+            _state.used &= ~(1<<i);
+            (*_state.keys[i].exec)(false, _state.keys[i].hold);
+        }
+        return true;
+    }
+
+    if (_state.undecided == _NONE)
+        return false;
+
+    // --- some other key, while a dual-role key is undecided ---
+
+    switch (_state.keys[_state.undecided].policy) {
+
+        case KEY_FUNCTIONS__DUAL_ROLE__HOLD_ON_OTHER_KEY_PRESS:
+            if (pressed)
+                _hold();
+            return false;
+
+        default: {  // `...TAPPING_TERM`, `...PERMISSIVE_HOLD`
+            // - hold the event back, so that it's executed after (and with)
+            //   whichever role the key turns out to have
+            // - for `...PERMISSIVE_HOLD`, a release of a key pressed while we
+            //   were undecided means "hold"
+            bool decide = false;
+            if ( !pressed && _state.keys[_state.undecided].policy
+                             == KEY_FUNCTIONS__DUAL_ROLE__PERMISSIVE_HOLD )
+                for (uint8_t j=0; j<_state.buffered; j++)
+                    if ( _state.buffer[j].pressed &&
+                         _state.buffer[j].row    == row &&
+                         _state.buffer[j].column == column )
+                        decide = true;
+
+            _state.buffer[_state.buffered++] = (_event_t) {
+                .row     = row,
+                .column  = column,
+                .pressed = pressed,
+            };
+
+            if (decide || _state.buffered == _BUFFER_SIZE)
+                _hold();
+            return true;
+        }
+    }
+}
+
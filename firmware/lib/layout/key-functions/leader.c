@@ -0,0 +1,199 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the "leader" section of "../key-functions.h"
+ *
+ * While a sequence is being typed, `_state.node` points (in PROGMEM) to the
+ * trie node for the keys typed so far.  Each key press follows one edge, so
+ * the work done per key depends only on how many edges that node has.
+ *
+ * While a sequence is being typed, `_check()` is scheduled (with the
+ * milliseconds timer) to run when the timeout is up, and rescheduled with
+ * each key.  Nothing runs during a scan.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "../../../../firmware/lib/timer.h"
+#include "../../../../firmware/lib/usb.h"
+#include "../key-functions.h"
+
+// ----------------------------------------------------------------------------
+
+#ifndef OPT__KEY_FUNCTIONS__LEADER_TIMEOUT
+    #error "OPT__KEY_FUNCTIONS__LEADER_TIMEOUT not defined"
+#endif
+
+/**                       macros/OPT__KEY_FUNCTIONS__LEADER_TIMEOUT/description
+ * The number of milliseconds to wait for the next key of a leader sequence
+ *
+ * Notes:
+ * - If a sequence is complete but could also be the start of a longer one,
+ *   it's performed when this runs out.
+ */
+
+// ----------------------------------------------------------------------------
+
+/**                                                macros/_KEYS_MAX/description
+ * The number of keys pressed during a sequence whose releases we can keep
+ * track of (so they don't get executed without their presses)
+ */
+#define  _KEYS_MAX  4
+
+// ----------------------------------------------------------------------------
+
+/**                                               types/_position_t/description
+ * The position of a key
+ */
+typedef struct {
+    uint8_t row;
+    uint8_t column;
+} _position_t;
+
+// ----------------------------------------------------------------------------
+
+/**                                                variables/_state/description
+ * The state of the leader engine
+ *
+ * Struct members:
+ * - `node`: The (PROGMEM) trie node for the keys typed so far, or `NULL` if
+ *   no sequence is being typed
+ * - `exec`: As passed to `key_functions__leader_start()`
+ * - `event`: The handle to `_check()`, if it's scheduled to run, or `0`
+ * - `held`: The positions of keys that were pressed as part of a sequence,
+ *   and haven't been released yet
+ * - `held_count`: The number of positions in `held`
+ */
+static struct {
+    const key_functions__leader_node_t * node;
+    void (*exec)(bool pressed, uint16_t action);
+    timer__event_t event;
+    _position_t    held[_KEYS_MAX];
+    uint8_t        held_count;
+} _state;
+
+// ----------------------------------------------------------------------------
+
+/**                                                 functions/_stop/description
+ * Stop typing a sequence, without performing anything
+ */
+static void _stop(void) {
+    _state.node = NULL;
+
+    timer__cancel(_state.event);
+    _state.event = 0;
+}
+
+/**                                                  functions/_end/description
+ * Stop typing a sequence, performing the action of the current node (if it
+ * has one)
+ */
+static void _end(void) {
+    uint16_t action = pgm_read_word(&_state.node->action);
+    _stop();
+
+    if (!action)
+        return;
+
+    (*_state.exec)(true, action);
+    usb__kb__send_report();
+    (*_state.exec)(false, action);
+}
+
+/**                                                functions/_check/description
+ * End the sequence, since we've waited the timeout for the next key
+ */
+static void _check(void * context) {
+    _state.event = 0;  // (the handle is no longer valid)
+
+    if (_state.node)
+        _end();
+}
+
+/**                                                 functions/_wait/description
+ * (Re)start the timeout for the next key
+ */
+static void _wait(void) {
+    if (timer__reschedule(_state.event, OPT__KEY_FUNCTIONS__LEADER_TIMEOUT))
+        _state.event = timer__schedule_milliseconds(
+                           OPT__KEY_FUNCTIONS__LEADER_TIMEOUT, &_check, NULL );
+}
+
+/**                                                 functions/_next/description
+ * Return the child of `_state.node` along the edge for `action`, or `NULL`
+ */
+static const key_functions__leader_node_t * _next(uint16_t action) {
+    uint8_t count = pgm_read_byte(&_state.node->count);
+    const key_functions__leader_edge_t * edges =
+        (const key_functions__leader_edge_t *)
+            pgm_read_word(&_state.node->edges);
+
+    for (uint8_t i=0; i<count; i++)
+        if (pgm_read_word(&edges[i].action) == action)
+            return (const key_functions__leader_node_t *)
+                pgm_read_word(&edges[i].next);
+
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+
+void key_functions__leader_start
+                    ( const key_functions__leader_node_t * root,
+                      void (*exec)(bool pressed, uint16_t action) ) {
+
+    _state.node = root;
+    _state.exec = exec;
+
+    _wait();
+}
+
+bool key_functions__leader_filter( bool     pressed,
+                                   uint8_t  row,
+                                   uint8_t  column,
+                                   uint16_t action ) {
+    // --- releases ---
+
+    if (!pressed) {
+        for (uint8_t i=0; i<_state.held_count; i++) {
+            if ( _state.held[i].row    != row ||
+                 _state.held[i].column != column )
+                continue;
+            _state.held[i] = _state.held[--_state.held_count];
+            return true;
+        }
+        return false;
+    }
+
+    // --- presses ---
+
+    if (!_state.node)
+        return false;  // nothing to do
+
+    if (_state.held_count < _KEYS_MAX)
+        _state.held[_state.held_count++] = (_position_t) { row, column };
+
+    const key_functions__leader_node_t * next = _next(action);
+
+    if (!next) {
+        _stop();  // not a sequence: forget it
+        return true;
+    }
+
+    _state.node = next;
+
+    if (!pgm_read_byte(&next->count))
+        _end();  // nothing could come after this, so don't wait
+    else
+        _wait();
+
+    return true;
+}
+
@@ -0,0 +1,199 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the "macro" section of "../key-functions.h"
+ *
+ * Macros are played in the background, the same way strings are typed (see
+ * "typing.c"): each report a macro generates is queued (see
+ * `usb__kb__queue_report()`), and `_step()` only runs instructions while
+ * there's room in the queue, rescheduling itself once per scan cycle until
+ * the macro is done.  So a long macro (or a delay in one) doesn't hold up
+ * scanning.
+ *
+ * While no macro is playing, `_step()` doesn't run.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "../../../../firmware/lib/timer.h"
+#include "../../../../firmware/lib/usb.h"
+#include "../key-functions.h"
+
+// ----------------------------------------------------------------------------
+
+/**                                              macros/_QUEUE_SIZE/description
+ * The number of macros that can be waiting to play (including the one that's
+ * playing)
+ */
+#define  _QUEUE_SIZE  4
+
+/**                                                  macros/_OPCODE/description
+ * The opcode bits of an instruction
+ */
+#define  _OPCODE(code)  ( (code) & 0xF000 )
+
+/**                                                 macros/_OPERAND/description
+ * The operand bits of an instruction
+ */
+#define  _OPERAND(code)  ( (code) & 0x0FFF )
+
+// ----------------------------------------------------------------------------
+
+/**                                                variables/_state/description
+ * The state of the macro interpreter
+ *
+ * Struct members:
+ * - `queue`: The macros waiting to play; `queue[0]` is the one playing
+ * - `queued`: The number of macros in `queue`
+ * - `next`: The next (PROGMEM) element of `queue[0]` to read
+ * - `exec`: As last passed to `key_functions__macro_play()`
+ * - `release`: The action being tapped, waiting to be released; or `0`
+ * - `typing`: Whether we're waiting for a string to be typed
+ * - `delay`: The number of milliseconds to wait, starting at `waited_at`
+ * - `waited_at`: When (in milliseconds) the current delay started
+ * - `scheduled`: Whether `_step()` is scheduled to run
+ */
+static struct {
+    const uint16_t * queue[_QUEUE_SIZE];
+    uint8_t          queued;
+    const uint16_t * next;
+    void (*exec)(bool pressed, uint16_t action);
+    uint16_t         release;
+    bool             typing;
+    uint16_t         delay;
+    uint16_t         waited_at;
+    bool             scheduled;
+} _state;
+
+// ----------------------------------------------------------------------------
+
+/**                                                 functions/_done/description
+ * Forget the macro that was playing, and start the next one (if there is one)
+ */
+static void _done(void) {
+    _state.queued--;
+    for (uint8_t i=0; i<_state.queued; i++)
+        _state.queue[i] = _state.queue[i+1];
+    _state.next = _state.queue[0];
+}
+
+/**                                                 functions/_read/description
+ * Return the next word of the macro playing, and advance `_state.next`
+ */
+static uint16_t _read(void) {
+    return pgm_read_word(_state.next++);
+}
+
+/**                                                 functions/_step/description
+ * Run as many instructions as there's room for in the report queue (or until
+ * the macro has to wait), then reschedule (if there's more to do)
+ */
+static void _step(void * context) {
+    _state.scheduled = false;
+
+    while (_state.queued) {
+        if (_state.typing) {
+            if (key_functions__is_typing())
+                break;
+            _state.typing = false;
+        }
+        if (_state.delay) {
+            if ( (uint16_t)(timer__get_milliseconds() - _state.waited_at)
+                    < _state.delay )
+                break;
+            _state.delay = 0;
+        }
+        if (usb__kb__queue_full())
+            break;
+
+        // the second half of a tap
+        if (_state.release) {
+            (*_state.exec)(false, _state.release);
+            _state.release = 0;
+            usb__kb__queue_report();
+            continue;
+        }
+
+        uint16_t code = _read();
+
+        if (code == KEY_FUNCTIONS__MACRO__END) {
+            _done();
+            continue;
+        }
+
+        if (!(code & 0x8000)) {  // an action code: tap it
+            (*_state.exec)(true, code);
+            _state.release = code;
+            usb__kb__queue_report();
+            continue;
+        }
+
+        switch (_OPCODE(code)) {
+            case KEY_FUNCTIONS__MACRO__PRESS:
+                (*_state.exec)(true, _read());
+                break;
+
+            case KEY_FUNCTIONS__MACRO__RELEASE:
+                (*_state.exec)(false, _read());
+                break;
+
+            case KEY_FUNCTIONS__MACRO__SEND:
+                usb__kb__queue_report();
+                break;
+
+            case KEY_FUNCTIONS__MACRO__DELAY:
+                _state.delay     = _OPERAND(code);
+                _state.waited_at = timer__get_milliseconds();
+                break;
+
+            case KEY_FUNCTIONS__MACRO__TYPE: {
+                const char * string = (const char *) _read();
+                if (key_functions__type_string(string))
+                    _state.next -= 2;  // another string is being typed: wait
+                _state.typing = true;
+                break;
+            }
+
+            default:
+                break;  // (shouldn't happen)
+        }
+    }
+
+    // - see the note in "typing.c"
+    if (_state.queued && timer__schedule_cycles(1, &_step, NULL))
+        _state.scheduled = true;
+}
+
+// ----------------------------------------------------------------------------
+
+uint8_t key_functions__macro_play( const uint16_t * macro,
+                                   void (*exec)(bool pressed,
+                                                uint16_t action) ) {
+    if (_state.queued == _QUEUE_SIZE)
+        return 1;  // error: too many macros waiting
+
+    _state.exec = exec;
+    _state.queue[_state.queued++] = macro;
+    if (_state.queued == 1) {
+        _state.next = macro;
+
+        // (if another macro is playing, `_step()` is already scheduled, or
+        // running and calling us)
+        if (!_state.scheduled)
+            _step(NULL);
+    }
+
+    return 0;
+}
+
+bool key_functions__macro_is_playing(void) {
+    return _state.queued;
+}
+
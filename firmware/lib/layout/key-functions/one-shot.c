@@ -0,0 +1,270 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the "one-shot" section of "../key-functions.h"
+ *
+ * A one-shot key's action is pressed when the key is.  What happens when the
+ * key is released depends on what happened in between:
+ * - If another key was pressed, the one-shot key was used like a normal key,
+ *   and its action is released right away.
+ * - Otherwise, it's "armed": the action stays pressed until the next
+ *   keypress (as counted by `timer__get_keypresses()`) is over.
+ *
+ * Tapping an armed key again "locks" it (so it stays pressed until it's
+ * tapped a third time), if `OPT__KEY_FUNCTIONS__ONE_SHOT_LOCK` is set.
+ *
+ * Nothing here runs during a scan.  While a key is armed, `_fire()` is
+ * scheduled for the end of the next keypress, and (if there's a timeout)
+ * `_check()` for when the timeout is up.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../../../../firmware/lib/timer.h"
+#include "../../../../firmware/lib/usb.h"
+#include "../key-functions.h"
+
+// ----------------------------------------------------------------------------
+
+#ifndef OPT__KEY_FUNCTIONS__ONE_SHOT_TIMEOUT
+    #error "OPT__KEY_FUNCTIONS__ONE_SHOT_TIMEOUT not defined"
+#endif
+#ifndef OPT__KEY_FUNCTIONS__ONE_SHOT_LOCK
+    #error "OPT__KEY_FUNCTIONS__ONE_SHOT_LOCK not defined"
+#endif
+
+/**                     macros/OPT__KEY_FUNCTIONS__ONE_SHOT_TIMEOUT/description
+ * The number of milliseconds a one-shot key stays armed, if no other key is
+ * pressed
+ *
+ * Notes:
+ * - `0` means "forever".
+ */
+
+/**                        macros/OPT__KEY_FUNCTIONS__ONE_SHOT_LOCK/description
+ * Whether tapping an armed one-shot key locks it (`1`), or disarms it (`0`)
+ */
+
+// ----------------------------------------------------------------------------
+
+/**                                                macros/_KEYS_MAX/description
+ * The number of one-shot keys that can be active at once
+ */
+#define  _KEYS_MAX  4
+
+// ----------------------------------------------------------------------------
+
+/**                                                 types/_status_t/description
+ * What a one-shot key is doing
+ *
+ * Members:
+ * - `_HELD`: Pressed (for the first time)
+ * - `_ARMED`: Tapped, and waiting for the next keypress
+ * - `_LOCKING`: Pressed again while armed
+ * - `_LOCKED`: Tapped again while armed
+ * - `_UNLOCKING`: Pressed again while locked
+ */
+typedef enum {
+    _HELD,
+    _ARMED,
+    _LOCKING,
+    _LOCKED,
+    _UNLOCKING,
+} _status_t;
+
+/**                                                    types/_key_t/description
+ * A one-shot key whose action is currently pressed
+ *
+ * Struct members:
+ * - `action`: The action (and the key's identity)
+ * - `exec`: The function to release the action with
+ * - `status`: What the key is doing
+ * - `keypresses`: The value of `timer__get_keypresses()` when the key was
+ *   pressed
+ */
+typedef struct {
+    uint16_t  action;
+    void (*exec)(bool pressed, uint16_t action);
+    _status_t status;
+    uint16_t  keypresses;
+} _key_t;
+
+// ----------------------------------------------------------------------------
+
+/**                                                variables/_state/description
+ * The state of the one-shot engine
+ *
+ * Struct members:
+ * - `keys`: The one-shot keys whose actions are pressed
+ * - `used`: A bitmask of which elements of `keys` are in use
+ * - `fire_scheduled`: Whether `_fire()` is scheduled to run
+ * - `timeout`: The handle to `_check()`, if it's scheduled to run, or `0`
+ */
+static struct {
+    _key_t         keys[_KEYS_MAX];
+    uint8_t        used;
+    bool           fire_scheduled;
+    timer__event_t timeout;
+} _state;
+
+// ----------------------------------------------------------------------------
+
+/**                                                 functions/_find/description
+ * Return the index into `_state.keys` of the one-shot key with the given
+ * action, or `UINT8_MAX`
+ */
+static uint8_t _find(uint16_t action) {
+    for (uint8_t i=0; i<_KEYS_MAX; i++)
+        if ( (_state.used & (1<<i)) && _state.keys[i].action == action )
+            return i;
+    return UINT8_MAX;
+}
+
+/**                                              functions/_release/description
+ * Release the action of the given one-shot key, and forget the key
+ */
+static void _release(uint8_t i) {
+    _state.used &= ~(1<<i);
+    (*_state.keys[i].exec)(false, _state.keys[i].action);
+}
+
+/**                                                functions/_armed/description
+ * Return whether any one-shot key is armed
+ */
+static bool _armed(void) {
+    for (uint8_t i=0; i<_KEYS_MAX; i++)
+        if ( (_state.used & (1<<i)) && _state.keys[i].status == _ARMED )
+            return true;
+    return false;
+}
+
+/**                                        functions/_release_armed/description
+ * Release all armed keys
+ */
+static void _release_armed(void) {
+    for (uint8_t i=0; i<_KEYS_MAX; i++)
+        if ( (_state.used & (1<<i)) && _state.keys[i].status == _ARMED )
+            _release(i);
+}
+
+/**                                                 functions/_fire/description
+ * Release all armed keys, once the keypress they were waiting for is done
+ *
+ * Notes:
+ * - Runs from `timer___tick_keypresses()`, after the keypress has been
+ *   executed, but before the report with it in has been sent; so we send that
+ *   report here, before releasing anything.
+ */
+static void _fire(void * context) {
+    _state.fire_scheduled = false;
+
+    if (!_armed())
+        return;
+
+    usb__kb__send_report();
+    _release_armed();
+
+    timer__cancel(_state.timeout);
+    _state.timeout = 0;
+}
+
+/**                                                functions/_check/description
+ * Release all armed keys, since it's been the timeout since a key was last
+ * armed
+ */
+static void _check(void * context) {
+    _state.timeout = 0;  // (the handle is no longer valid)
+
+    _release_armed();
+}
+
+// ----------------------------------------------------------------------------
+
+void key_functions__one_shot_press( uint16_t action,
+                                    void (*exec)(bool pressed,
+                                                 uint16_t action) ) {
+    uint8_t i = _find(action);
+
+    if (i != UINT8_MAX) {
+        _key_t * key = &_state.keys[i];
+        if (key->status == _ARMED)
+            key->status = (OPT__KEY_FUNCTIONS__ONE_SHOT_LOCK) ? _LOCKING
+                                                              : _UNLOCKING;
+        else if (key->status == _LOCKED)
+            key->status = _UNLOCKING;
+        return;  // (the action is already pressed)
+    }
+
+    i = 0;
+    while (i < _KEYS_MAX && (_state.used & (1<<i)))
+        i++;
+    if (i == _KEYS_MAX) {
+        (*exec)(true, action);  // act like a normal key
+        return;
+    }
+
+    _state.keys[i] = (_key_t) {
+        .action     = action,
+        .exec       = exec,
+        .status     = _HELD,
+        .keypresses = timer__get_keypresses(),
+    };
+    _state.used |= (1<<i);
+
+    (*exec)(true, action);
+}
+
+void key_functions__one_shot_release( uint16_t action,
+                                      void (*exec)(bool pressed,
+                                                   uint16_t action) ) {
+    uint8_t i = _find(action);
+
+    if (i == UINT8_MAX) {
+        (*exec)(false, action);  // it was acting like a normal key
+        return;
+    }
+
+    _key_t * key = &_state.keys[i];
+    switch (key->status) {
+
+        case _HELD:
+            // if another key was pressed meanwhile, this was a normal press
+            if (timer__get_keypresses() != key->keypresses) {
+                _release(i);
+                break;
+            }
+
+            key->status = _ARMED;
+
+            if ( !_state.fire_scheduled &&
+                 timer__schedule_keypresses(0, &_fire, NULL) )
+                _state.fire_scheduled = true;
+
+            // (re)start the timeout
+            if ( OPT__KEY_FUNCTIONS__ONE_SHOT_TIMEOUT &&
+                 timer__reschedule( _state.timeout,
+                                    OPT__KEY_FUNCTIONS__ONE_SHOT_TIMEOUT ) )
+                _state.timeout = timer__schedule_milliseconds(
+                                     OPT__KEY_FUNCTIONS__ONE_SHOT_TIMEOUT,
+                                     &_check, NULL );
+            break;
+
+        case _LOCKING:
+            key->status = _LOCKED;
+            break;
+
+        case _UNLOCKING:
+            _release(i);
+            break;
+
+        default:
+            break;  // (shouldn't happen)
+    }
+}
+
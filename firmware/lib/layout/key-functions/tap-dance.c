@@ -0,0 +1,232 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the "tap-dance" section of "../key-functions.h"
+ *
+ * At most one tap-dance key is "dancing" (being counted) at a time.  The
+ * dance is settled (and its action pressed) when:
+ * - the key has been up for `OPT__KEY_FUNCTIONS__TAP_DANCE_TERM`
+ *   milliseconds (a tap), or
+ * - the key has been down for `OPT__KEY_FUNCTIONS__TAPPING_TERM`
+ *   milliseconds (a hold), or
+ * - another key is pressed, or
+ * - the key has been tapped as many times as it has actions.
+ *
+ * A hold stays pressed (and is kept track of) until the key is released.
+ *
+ * While a key is dancing, `_check()` is scheduled (with the milliseconds
+ * timer) to run when the current term is up, and rescheduled each time the
+ * key is pressed or released.  Nothing runs during a scan.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "../../../../firmware/lib/timer.h"
+#include "../../../../firmware/lib/usb.h"
+#include "../key-functions.h"
+
+// ----------------------------------------------------------------------------
+
+#ifndef OPT__KEY_FUNCTIONS__TAP_DANCE_TERM
+    #error "OPT__KEY_FUNCTIONS__TAP_DANCE_TERM not defined"
+#endif
+#ifndef OPT__KEY_FUNCTIONS__TAPPING_TERM
+    #error "OPT__KEY_FUNCTIONS__TAPPING_TERM not defined"
+#endif
+
+/**                       macros/OPT__KEY_FUNCTIONS__TAP_DANCE_TERM/description
+ * The number of milliseconds to wait, after a tap-dance key is released, for
+ * it to be tapped again
+ *
+ * Notes:
+ * - How long a key must be down to be a "hold" is
+ *   `OPT__KEY_FUNCTIONS__TAPPING_TERM` (as for dual-role keys).
+ */
+
+// ----------------------------------------------------------------------------
+
+/**                                                macros/_HELD_MAX/description
+ * The number of settled tap-dance keys that can be held at once
+ */
+#define  _HELD_MAX  2
+
+// ----------------------------------------------------------------------------
+
+/**                                                   types/_held_t/description
+ * A tap-dance key whose action is pressed, waiting for the key to be released
+ */
+typedef struct {
+    uint8_t  row;
+    uint8_t  column;
+    uint16_t action;
+    void (*exec)(bool pressed, uint16_t action);
+} _held_t;
+
+// ----------------------------------------------------------------------------
+
+/**                                                variables/_state/description
+ * The state of the tap-dance engine
+ *
+ * Struct members:
+ * - `dancing`: Whether a key is being counted (if not, the following members,
+ *   up to `pressed`, are meaningless)
+ * - `row`, `column`: The position of the key
+ * - `actions`, `size`, `hold`, `exec`: As passed to
+ *   `key_functions__tap_dance_press()`
+ * - `count`: The number of times the key has been pressed
+ * - `pressed`: Whether the key is currently pressed
+ * - `event`: The handle to `_check()`, if it's scheduled to run, or `0`
+ * - `held`: The settled keys being held
+ * - `used`: A bitmask of which elements of `held` are in use
+ */
+static struct {
+    bool             dancing;
+    uint8_t          row;
+    uint8_t          column;
+    const uint16_t * actions;
+    uint8_t          size;
+    uint16_t         hold;
+    void (*exec)(bool pressed, uint16_t action);
+    uint8_t          count;
+    bool             pressed;
+    timer__event_t   event;
+    _held_t          held[_HELD_MAX];
+    uint8_t          used;
+} _state;
+
+// ----------------------------------------------------------------------------
+
+/**                                               functions/_settle/description
+ * Stop counting, and press (and maybe release) the action for the count
+ *
+ * Notes:
+ * - If the key is still pressed, its action (or its "hold" action, if it has
+ *   one) stays pressed until it's released.  Otherwise, the action for the
+ *   count is tapped.
+ */
+static void _settle(void) {
+    _state.dancing = false;
+
+    timer__cancel(_state.event);
+    _state.event = 0;
+
+    uint16_t action = pgm_read_word(&_state.actions[_state.count-1]);
+
+    if (!_state.pressed) {
+        (*_state.exec)(true, action);
+        usb__kb__send_report();
+        (*_state.exec)(false, action);
+        return;
+    }
+
+    if (_state.hold)
+        action = _state.hold;
+
+    uint8_t i = 0;
+    while (i < _HELD_MAX && (_state.used & (1<<i)))
+        i++;
+    if (i == _HELD_MAX) {
+        // can't keep track of another hold: tap instead
+        (*_state.exec)(true, action);
+        usb__kb__send_report();
+        (*_state.exec)(false, action);
+        return;
+    }
+
+    _state.held[i] = (_held_t) {
+        .row    = _state.row,
+        .column = _state.column,
+        .action = action,
+        .exec   = _state.exec,
+    };
+    _state.used |= (1<<i);
+
+    (*_state.exec)(true, action);
+}
+
+/**                                                functions/_check/description
+ * Settle the dance, since it's been the current term since the key was last
+ * pressed or released
+ */
+static void _check(void * context) {
+    _state.event = 0;  // (the handle is no longer valid)
+
+    if (_state.dancing)
+        _settle();
+}
+
+/**                                                 functions/_wait/description
+ * (Re)start the wait for the key to change, using the term for its current
+ * state
+ */
+static void _wait(void) {
+    uint16_t term = (_state.pressed) ? OPT__KEY_FUNCTIONS__TAPPING_TERM
+                                     : OPT__KEY_FUNCTIONS__TAP_DANCE_TERM;
+
+    if (timer__reschedule(_state.event, term))
+        _state.event = timer__schedule_milliseconds(term, &_check, NULL);
+}
+
+// ----------------------------------------------------------------------------
+
+void key_functions__tap_dance_press
+                    ( uint8_t          row,
+                      uint8_t          column,
+                      const uint16_t * actions,
+                      uint8_t          size,
+                      uint16_t         hold,
+                      void (*exec)(bool pressed, uint16_t action) ) {
+
+    if (_state.dancing && (_state.row != row || _state.column != column))
+        _settle();
+
+    if (_state.dancing) {
+        _state.count++;
+    } else {
+        _state.dancing = true;
+        _state.row     = row;
+        _state.column  = column;
+        _state.actions = actions;
+        _state.size    = size;
+        _state.hold    = hold;
+        _state.exec    = exec;
+        _state.count   = 1;
+    }
+    _state.pressed = true;
+
+    _wait();
+}
+
+void key_functions__tap_dance_release(uint8_t row, uint8_t column) {
+    if (_state.dancing && _state.row == row && _state.column == column) {
+        _state.pressed = false;
+
+        if (_state.count >= _state.size)
+            _settle();  // there's no action for another tap
+        else
+            _wait();
+        return;
+    }
+
+    for (uint8_t i=0; i<_HELD_MAX; i++) {
+        if ( (_state.used & (1<<i)) &&
+             _state.held[i].row == row && _state.held[i].column == column ) {
+            _state.used &= ~(1<<i);
+            (*_state.held[i].exec)(false, _state.held[i].action);
+            return;
+        }
+    }
+}
+
+void key_functions__tap_dance_interrupt(uint8_t row, uint8_t column) {
+    if (_state.dancing && (_state.row != row || _state.column != column))
+        _settle();
+}
+
@@ -0,0 +1,594 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2012, 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the "typing" section of "../key-functions.h"
+ *
+ * Strings are typed in the background: each character (or run of
+ * characters; see `_next_actions()`) is turned into a short list of actions
+ * (key presses and releases, some followed by a report), and actions are
+ * performed only while there's room in the USB report queue (see
+ * `usb__kb__queue_report()`).  `_step()` reschedules itself once per scan
+ * cycle until the string is done, and the USB code sends at most one queued
+ * report per frame, so scanning carries on normally while a long string is
+ * typed.
+ *
+ * Characters with a dedicated keycode (see `_ascii`) are typed directly.
+ * Everything else is typed as a "unicode sequence", using whichever method
+ * (see `key_functions__unicode_method_t`) is currently selected.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "../../../../firmware/lib/eeprom.h"
+#include "../../../../firmware/lib/timer.h"
+#include "../../../../firmware/lib/usb.h"
+#include "../../../../firmware/lib/usb/usage-page/keyboard.h"
+#include "../key-functions.h"
+
+// ----------------------------------------------------------------------------
+
+/**                                                 macros/_RUN_MAX/description
+ * The largest number of characters to press together in a single report
+ *
+ * Notes:
+ * - 6 is the number of (non-modifier) keys a boot protocol report can hold.
+ *   Setting this to `1` turns packing off (one press report and one release
+ *   report per character).
+ */
+#define  _RUN_MAX  6
+
+/**                                             macros/_ACTIONS_MAX/description
+ * The largest number of actions a single call to `_next_actions()` can
+ * generate
+ *
+ * Either a run of characters (press "shift", press the keys, release "shift",
+ * release the keys), or a unicode sequence.  The longest unicode sequence is
+ * the Linux one for a 6 digit code point (press "ctrl", "shift", and "u",
+ * release them, press and release 6 hex digits, press and release "space").
+ * The longest macOS sequence (press "option", press and release 8 hex digits
+ * for a surrogate pair, release "option") is 2 shorter.
+ */
+#define  _ACTIONS_MAX  ( (1 + _RUN_MAX)*2 > 3 + 3 + 6*2 + 2 \
+                         ? (1 + _RUN_MAX)*2                 \
+                         : 3 + 3 + 6*2 + 2 )
+
+// ----------------------------------------------------------------------------
+
+/**                                                 types/_action_t/description
+ * A single step of typing a character
+ *
+ * Struct members:
+ * - `keycode`: The keycode to press or release
+ * - `pressed`: Whether to press (`true`) or release (`false`) the keycode
+ * - `report`: Whether to queue a report after setting the keycode
+ */
+typedef struct {
+    uint8_t keycode;
+    bool    pressed : 1;
+    bool    report  : 1;
+} _action_t;
+
+// ----------------------------------------------------------------------------
+
+/**                                                variables/_state/description
+ * The state of the typing engine
+ *
+ * Struct members:
+ * - `active`: Whether a string is currently being typed
+ * - `scheduled`: Whether `_step()` is currently scheduled to run
+ * - `stopping`: Whether to stop once the current character (or run) is done
+ *   (see `key_functions__cancel_typing()`)
+ * - `peeked`: Whether `character` holds the next (already decoded) character
+ * - `memory`: The memory space `string` points into
+ * - `string`: A pointer to the next byte of the string to read
+ * - `character`: The next character (if `peeked`)
+ * - `actions`: The actions for the current character
+ * - `length`: The number of actions in `actions`
+ * - `next`: The index of the next action to perform
+ */
+static struct {
+    bool                    active    : 1;
+    bool                    scheduled : 1;
+    bool                    stopping  : 1;
+    bool                    peeked    : 1;
+    key_functions__memory_t memory;
+    const char *            string;
+    uint32_t                character;
+    _action_t               actions[_ACTIONS_MAX];
+    uint8_t                 length;
+    uint8_t                 next;
+} _state;
+
+/**                                       variables/_unicode_method/description
+ * The method currently used to type "unicode sequences"
+ */
+static key_functions__unicode_method_t _unicode_method
+                                        = KEY_FUNCTIONS__UNICODE__WINDOWS;
+
+// ----------------------------------------------------------------------------
+
+/**                                                 functions/_read/description
+ * Return the next byte of the string being typed, and advance the pointer
+ */
+static uint8_t _read(void) {
+    const char * p = _state.string++;
+    switch (_state.memory) {
+        case KEY_FUNCTIONS__PROGMEM: return pgm_read_byte(p);
+        case KEY_FUNCTIONS__EEPROM:  return eeprom__read((uint8_t *) p);
+        default:                     return *p;
+    }
+}
+
+/**                                                  functions/_add/description
+ * Append an action to the list for the current character
+ */
+static void _add(bool pressed, uint8_t keycode, bool report) {
+    _state.actions[_state.length++] = (_action_t) {
+        .keycode = keycode,
+        .pressed = pressed,
+        .report  = report,
+    };
+}
+
+/**                                          functions/_hex_keycode/description
+ * Return the keycode for the given hexadecimal digit (`0`..`15`)
+ */
+static uint8_t _hex_keycode(uint8_t digit) {
+    if      (digit == 0) return KEYBOARD__0_RightParenthesis;
+    else if (digit < 10) return KEYBOARD__1_Exclamation + digit - 1;
+    else                 return KEYBOARD__a_A + digit - 10;
+}
+
+/**                                              functions/_add_hex/description
+ * Append actions to press and release each hex digit of `value` (most
+ * significant first), reporting after each
+ *
+ * Arguments:
+ * - `value`: The value to type
+ * - `digits`: The number of digits to type
+ */
+static void _add_hex(uint32_t value, uint8_t digits) {
+    while (digits--) {
+        uint8_t keycode = _hex_keycode( (value >> (digits*4)) & 0xF );
+        _add(true,  keycode, true);
+        _add(false, keycode, true);
+    }
+}
+
+/**                                                 macros/_SHIFTED/description
+ * Mark a keycode in `_ascii` as needing "shift"
+ *
+ * Notes:
+ * - All the keycodes we need are below `0x80`, so bit 7 is free.
+ */
+#define  _SHIFTED(keycode)  ( 0x80 | (keycode) )
+
+/**                                                variables/_ascii/description
+ * The keycode (and whether "shift" is needed) for each 7-bit ASCII character
+ *
+ * Entries are `0` for characters that don't have a keycode (and should be
+ * typed as "unicode sequences").  Bit 7 of each entry is set if "shift"
+ * needs to be held down while the keycode is pressed (see `_SHIFTED()`).
+ */
+static const uint8_t PROGMEM _ascii[0x80] = {
+    [0x08] = KEYBOARD__DeleteBackspace,                     // BS
+    [0x09] = KEYBOARD__Tab,                                 // HT
+    [0x0A] = KEYBOARD__ReturnEnter,                         // LF
+    [0x0D] = KEYBOARD__ReturnEnter,                         // CR
+    [0x1B] = KEYBOARD__Escape,                              // ESC
+    [0x20] = KEYBOARD__Spacebar,                            // ' '
+    [0x21] = _SHIFTED( KEYBOARD__1_Exclamation ),           // !
+    [0x22] = _SHIFTED( KEYBOARD__SingleQuote_DoubleQuote ), // "
+    [0x23] = _SHIFTED( KEYBOARD__3_Pound ),                 // #
+    [0x24] = _SHIFTED( KEYBOARD__4_Dollar ),                // $
+    [0x25] = _SHIFTED( KEYBOARD__5_Percent ),               // %
+    [0x26] = _SHIFTED( KEYBOARD__7_Ampersand ),             // &
+    [0x27] = KEYBOARD__SingleQuote_DoubleQuote,             // '
+    [0x28] = _SHIFTED( KEYBOARD__9_LeftParenthesis ),       // (
+    [0x29] = _SHIFTED( KEYBOARD__0_RightParenthesis ),      // )
+    [0x2A] = _SHIFTED( KEYBOARD__8_Asterisk ),              // *
+    [0x2B] = _SHIFTED( KEYBOARD__Equal_Plus ),              // +
+    [0x2C] = KEYBOARD__Comma_LessThan,                      // ,
+    [0x2D] = KEYBOARD__Dash_Underscore,                     // -
+    [0x2E] = KEYBOARD__Period_GreaterThan,                  // .
+    [0x2F] = KEYBOARD__Slash_Question,                      // /
+    [0x30] = KEYBOARD__0_RightParenthesis,                  // 0
+    [0x31] = KEYBOARD__1_Exclamation,                       // 1
+    [0x32] = KEYBOARD__2_At,                                // 2
+    [0x33] = KEYBOARD__3_Pound,                             // 3
+    [0x34] = KEYBOARD__4_Dollar,                            // 4
+    [0x35] = KEYBOARD__5_Percent,                           // 5
+    [0x36] = KEYBOARD__6_Caret,                             // 6
+    [0x37] = KEYBOARD__7_Ampersand,                         // 7
+    [0x38] = KEYBOARD__8_Asterisk,                          // 8
+    [0x39] = KEYBOARD__9_LeftParenthesis,                   // 9
+    [0x3A] = _SHIFTED( KEYBOARD__Semicolon_Colon ),         // :
+    [0x3B] = KEYBOARD__Semicolon_Colon,                     // ;
+    [0x3C] = _SHIFTED( KEYBOARD__Comma_LessThan ),          // <
+    [0x3D] = KEYBOARD__Equal_Plus,                          // =
+    [0x3E] = _SHIFTED( KEYBOARD__Period_GreaterThan ),      // >
+    [0x3F] = _SHIFTED( KEYBOARD__Slash_Question ),          // ?
+    [0x40] = _SHIFTED( KEYBOARD__2_At ),                    // @
+    [0x41] = _SHIFTED( KEYBOARD__a_A ),                     // A
+    [0x42] = _SHIFTED( KEYBOARD__b_B ),                     // B
+    [0x43] = _SHIFTED( KEYBOARD__c_C ),                     // C
+    [0x44] = _SHIFTED( KEYBOARD__d_D ),                     // D
+    [0x45] = _SHIFTED( KEYBOARD__e_E ),                     // E
+    [0x46] = _SHIFTED( KEYBOARD__f_F ),                     // F
+    [0x47] = _SHIFTED( KEYBOARD__g_G ),                     // G
+    [0x48] = _SHIFTED( KEYBOARD__h_H ),                     // H
+    [0x49] = _SHIFTED( KEYBOARD__i_I ),                     // I
+    [0x4A] = _SHIFTED( KEYBOARD__j_J ),                     // J
+    [0x4B] = _SHIFTED( KEYBOARD__k_K ),                     // K
+    [0x4C] = _SHIFTED( KEYBOARD__l_L ),                     // L
+    [0x4D] = _SHIFTED( KEYBOARD__m_M ),                     // M
+    [0x4E] = _SHIFTED( KEYBOARD__n_N ),                     // N
+    [0x4F] = _SHIFTED( KEYBOARD__o_O ),                     // O
+    [0x50] = _SHIFTED( KEYBOARD__p_P ),                     // P
+    [0x51] = _SHIFTED( KEYBOARD__q_Q ),                     // Q
+    [0x52] = _SHIFTED( KEYBOARD__r_R ),                     // R
+    [0x53] = _SHIFTED( KEYBOARD__s_S ),                     // S
+    [0x54] = _SHIFTED( KEYBOARD__t_T ),                     // T
+    [0x55] = _SHIFTED( KEYBOARD__u_U ),                     // U
+    [0x56] = _SHIFTED( KEYBOARD__v_V ),                     // V
+    [0x57] = _SHIFTED( KEYBOARD__w_W ),                     // W
+    [0x58] = _SHIFTED( KEYBOARD__x_X ),                     // X
+    [0x59] = _SHIFTED( KEYBOARD__y_Y ),                     // Y
+    [0x5A] = _SHIFTED( KEYBOARD__z_Z ),                     // Z
+    [0x5B] = KEYBOARD__LeftBracket_LeftBrace,               // [
+    [0x5C] = KEYBOARD__Backslash_Pipe,                      // '\'
+    [0x5D] = KEYBOARD__RightBracket_RightBrace,             // ]
+    [0x5E] = _SHIFTED( KEYBOARD__6_Caret ),                 // ^
+    [0x5F] = _SHIFTED( KEYBOARD__Dash_Underscore ),         // _
+    [0x60] = KEYBOARD__GraveAccent_Tilde,                   // `
+    [0x61] = KEYBOARD__a_A,                                 // a
+    [0x62] = KEYBOARD__b_B,                                 // b
+    [0x63] = KEYBOARD__c_C,                                 // c
+    [0x64] = KEYBOARD__d_D,                                 // d
+    [0x65] = KEYBOARD__e_E,                                 // e
+    [0x66] = KEYBOARD__f_F,                                 // f
+    [0x67] = KEYBOARD__g_G,                                 // g
+    [0x68] = KEYBOARD__h_H,                                 // h
+    [0x69] = KEYBOARD__i_I,                                 // i
+    [0x6A] = KEYBOARD__j_J,                                 // j
+    [0x6B] = KEYBOARD__k_K,                                 // k
+    [0x6C] = KEYBOARD__l_L,                                 // l
+    [0x6D] = KEYBOARD__m_M,                                 // m
+    [0x6E] = KEYBOARD__n_N,                                 // n
+    [0x6F] = KEYBOARD__o_O,                                 // o
+    [0x70] = KEYBOARD__p_P,                                 // p
+    [0x71] = KEYBOARD__q_Q,                                 // q
+    [0x72] = KEYBOARD__r_R,                                 // r
+    [0x73] = KEYBOARD__s_S,                                 // s
+    [0x74] = KEYBOARD__t_T,                                 // t
+    [0x75] = KEYBOARD__u_U,                                 // u
+    [0x76] = KEYBOARD__v_V,                                 // v
+    [0x77] = KEYBOARD__w_W,                                 // w
+    [0x78] = KEYBOARD__x_X,                                 // x
+    [0x79] = KEYBOARD__y_Y,                                 // y
+    [0x7A] = KEYBOARD__z_Z,                                 // z
+    [0x7B] = _SHIFTED( KEYBOARD__LeftBracket_LeftBrace ),   // {
+    [0x7C] = _SHIFTED( KEYBOARD__Backslash_Pipe ),          // |
+    [0x7D] = _SHIFTED( KEYBOARD__RightBracket_RightBrace ), // }
+    [0x7E] = _SHIFTED( KEYBOARD__GraveAccent_Tilde ),       // ~
+    [0x7F] = KEYBOARD__DeleteForward,                       // DEL
+};
+
+/**                                               functions/_decode/description
+ * Read and return the next (UTF-8 encoded) character of the string
+ *
+ * Returns:
+ * - success: the code point of the character
+ * - failure: `0` (the end of the string has been reached)
+ *
+ * Implementation notes:
+ *
+ * - We use `uint8_t` instead of `char` when iterating over `string` because
+ *   the signedness of `char` is implementation defined (and, actually, signed
+ *   by default with avr-gcc, which is not what we want if we're going to be
+ *   doing bitwise operations and comparisons).
+ *
+ * - We assume, for the most part, that the string is valid modified (i.e.
+ *   null-terminated) UTF-8.  This should be a fairly safe assumption, since
+ *   all PROGMEM strings should be generated by the compiler :)
+ *
+ * - UTF-8 character format
+ *
+ *     ----------------------------------------------------------------------
+ *      code points      avail. bits  byte 1    byte 2    byte 3    byte 4
+ *      ---------------  -----------  --------  --------  --------  --------
+ *      0x0000 - 0x007F           7   0xxxxxxx
+ *      0x0080 - 0x07FF          11   110xxxxx  10xxxxxx
+ *      0x0800 - 0xFFFF          16   1110xxxx  10xxxxxx  10xxxxxx
+ *      0x010000 - 0x10FFFF      21   11110xxx  10xxxxxx  10xxxxxx  10xxxxxx
+ *     ----------------------------------------------------------------------
+ */
+static uint32_t _decode(void) {
+    uint8_t  c;       // for storing the current byte of the character
+    uint32_t c_full;  // for storing the full character
+
+    for (;;) {
+        c = _read();
+
+        if (c == 0) {
+            // end of string
+            _state.string--;  // stay here, if we're called again
+            return 0;
+
+        } else if (c >> 7 == 0b0) {
+            // a 1-byte utf-8 character
+            c_full = c;
+            break;
+
+        } else if (c >> 5 == 0b110) {
+            // beginning of a 2-byte utf-8 character
+            // assume the string is valid
+            c_full  = (uint32_t)(c & 0x1F) <<  6; c = _read();
+            c_full |= (c & 0x3F) <<  0;
+            break;
+
+        } else if (c >> 4 == 0b1110) {
+            // beginning of a 3-byte utf-8 character
+            // assume the string is valid
+            c_full  = (uint32_t)(c & 0x0F) << 12; c = _read();
+            c_full |= (uint32_t)(c & 0x3F) <<  6; c = _read();
+            c_full |= (c & 0x3F) <<  0;
+            break;
+
+        } else if ((c >> 3) == 0b11110) {
+            // beginning of a 4-byte utf-8 character
+            // assume the string is valid
+            c_full  = (uint32_t)(c & 0x07) << 18; c = _read();
+            c_full |= (uint32_t)(c & 0x3F) << 12; c = _read();
+            c_full |= (uint32_t)(c & 0x3F) <<  6; c = _read();
+            c_full |= (uint32_t)(c & 0x3F) <<  0;
+            break;
+
+        } else {
+            // ran across some invalid utf-8
+            // ignore it, try again
+        }
+    }
+
+    return c_full;
+}
+
+/**                                                 functions/_peek/description
+ * Return the next character of the string, without consuming it
+ */
+static uint32_t _peek(void) {
+    if (!_state.peeked) {
+        _state.character = _decode();
+        _state.peeked    = true;
+    }
+    return _state.character;
+}
+
+/**                                              functions/_keycode/description
+ * Return the keycode for the given character, or `0` if there isn't one
+ *
+ * Arguments:
+ * - `c`: The character
+ * - `shifted`: A pointer to the location to store whether "shift" needs to be
+ *   held down while the keycode is pressed
+ */
+static uint8_t _keycode(uint32_t c, bool * shifted) {
+    uint8_t entry = (c < 0x80) ? pgm_read_byte(&_ascii[c]) : 0;
+    *shifted = entry & 0x80;
+    return entry & 0x7F;
+}
+
+/**                                               functions/_in_run/description
+ * Return whether `keycode` is one of the first `length` elements of `run`
+ */
+static bool _in_run(const uint8_t * run, uint8_t length, uint8_t keycode) {
+    for (uint8_t i=0; i<length; i++)
+        if (run[i] == keycode)
+            return true;
+    return false;
+}
+
+/**                                         functions/_next_actions/description
+ * Consume the next character (or run of characters) of the string, and fill
+ * in the list of actions needed to type it
+ *
+ * Returns:
+ * - `true`: if there was another character
+ * - `false`: if the end of the string has been reached
+ *
+ * Notes:
+ * - Consecutive characters that have keycodes, need the same shift state, and
+ *   are all distinct, are pressed together in one report and released
+ *   together in the next (up to `_RUN_MAX` of them, or as many as there's
+ *   room for in the report, next to any keys the user is holding down).
+ *   Hosts generate keypresses for newly pressed keys in the order they appear
+ *   in the report, and `usb__kb__set_key()` fills the report in order, so the
+ *   characters come out in the right order with 2 reports per run instead of
+ *   2 per character.
+ * - A character that is already in the run (it can't be pressed twice), or
+ *   that needs a different shift state, starts a new run.
+ */
+static bool _next_actions(void) {
+    bool    shifted;
+    uint8_t keycode;
+
+    uint8_t run[_RUN_MAX];
+    uint8_t run_length = 0;
+    uint8_t run_max    = usb__kb__keys_free();
+    if (run_max > _RUN_MAX)
+        run_max = _RUN_MAX;
+
+    _state.length = 0;
+    _state.next   = 0;
+
+    uint32_t c_full = _peek();
+    if (!c_full)
+        return false;
+    _state.peeked = false;
+
+    keycode = _keycode(c_full, &shifted);
+
+    // --- (if possible) send regular keycodes ---
+
+    if (keycode) {
+        run[run_length++] = keycode;
+
+        while (run_length < run_max) {
+            bool    next_shifted;
+            uint8_t next_keycode = _keycode(_peek(), &next_shifted);
+
+            if ( !next_keycode || next_shifted != shifted
+                 || _in_run(run, run_length, next_keycode) )
+                break;
+
+            run[run_length++] = next_keycode;
+            _state.peeked = false;
+        }
+
+        if (shifted) _add(true, KEYBOARD__LeftShift, false);
+        for (uint8_t i=0; i<run_length; i++)
+            _add(true, run[i], i == run_length-1);
+
+        if (shifted) _add(false, KEYBOARD__LeftShift, false);
+        for (uint8_t i=0; i<run_length; i++)
+            _add(false, run[i], i == run_length-1);
+
+        return true;
+    }
+
+    // --- (otherwise) send unicode sequence ---
+
+    // - at least 4 digits, and as many more as the code point needs
+    uint8_t digits = (c_full > 0xFFFFF) ? 6 : (c_full > 0xFFFF) ? 5 : 4;
+
+    switch (_unicode_method) {
+        case KEY_FUNCTIONS__UNICODE__WINDOWS:
+            _add(true,  KEYBOARD__LeftAlt, true);
+            _add(true,  KEYPAD__Plus,      true);
+            _add(false, KEYPAD__Plus,      true);
+            _add_hex(c_full, digits);
+            _add(false, KEYBOARD__LeftAlt, true);
+            break;
+
+        case KEY_FUNCTIONS__UNICODE__MACOS:
+            _add(true,  KEYBOARD__LeftAlt, true);
+            if (c_full > 0xFFFF) {
+                // utf-16 surrogate pair
+                c_full -= 0x10000;
+                _add_hex(0xD800 + (c_full >> 10),    4);
+                _add_hex(0xDC00 + (c_full &  0x3FF), 4);
+            } else {
+                _add_hex(c_full, 4);
+            }
+            _add(false, KEYBOARD__LeftAlt, true);
+            break;
+
+        case KEY_FUNCTIONS__UNICODE__LINUX:
+            _add(true,  KEYBOARD__LeftControl, false);
+            _add(true,  KEYBOARD__LeftShift,   false);
+            _add(true,  KEYBOARD__u_U,         true);
+            _add(false, KEYBOARD__u_U,         false);
+            _add(false, KEYBOARD__LeftShift,   false);
+            _add(false, KEYBOARD__LeftControl, true);
+            _add_hex(c_full, digits);
+            _add(true,  KEYBOARD__Spacebar,    true);
+            _add(false, KEYBOARD__Spacebar,    true);
+            break;
+    }
+
+    return true;
+}
+
+/**                                                 functions/_step/description
+ * Perform as many actions as there's room for in the report queue, then
+ * reschedule (if there's more to do)
+ *
+ * Notes:
+ * - If the user is holding down so many keys that a keycode can't be pressed
+ *   (there's no room left for it in the report), we wait for a key to be
+ *   released rather than skip the character.
+ */
+static void _step(void * context) {
+    _state.scheduled = false;
+
+    while (_state.active && !usb__kb__queue_full()) {
+        if (_state.next == _state.length) {
+            if (_state.stopping) {
+                _state.active = false;
+                return;
+            }
+            if (!usb__kb__keys_free())
+                break;  // no room to type anything
+            if (!_next_actions()) {
+                _state.active = false;
+                return;
+            }
+        }
+
+        _action_t * a = &_state.actions[_state.next];
+        if (usb__kb__set_key(a->pressed, a->keycode) && a->pressed)
+            break;  // no room (the user pressed a key); try again later
+        _state.next++;
+        if (a->report)
+            usb__kb__queue_report();
+    }
+
+    // - scheduled events are counted down in the same pass they're added
+    //   during, so this runs on the next cycle (or, if we were called from
+    //   outside the timer, the one after)
+    if (_state.active && timer__schedule_cycles(1, &_step, NULL))
+        _state.scheduled = true;
+}
+
+// ----------------------------------------------------------------------------
+
+uint8_t key_functions__type_string(const char * string) {
+    return key_functions__type_string_from(KEY_FUNCTIONS__PROGMEM, string);
+}
+
+uint8_t key_functions__type_string_from( key_functions__memory_t memory,
+                                         const char *            string ) {
+    if (_state.active)
+        return 1;  // busy
+
+    _state.active   = true;
+    _state.stopping = false;
+    _state.memory   = memory;
+    _state.string = string;
+    _state.peeked = false;
+    _state.length = 0;
+    _state.next   = 0;
+
+    if (!_state.scheduled)
+        _step(NULL);
+
+    return 0;
+}
+
+bool key_functions__is_typing(void) {
+    return _state.active;
+}
+
+void key_functions__cancel_typing(void) {
+    // - don't just release what the current character has pressed: in the
+    //   middle of a unicode sequence, that would make the host enter
+    //   whatever part of the code point it had so far (or leave it waiting
+    //   for more digits)
+    _state.stopping = true;
+}
+
+void key_functions__set_unicode_method(key_functions__unicode_method_t m) {
+    _unicode_method = m;
+}
+
+key_functions__unicode_method_t key_functions__get_unicode_method(void) {
+    return _unicode_method;
+}
+
@@ -31,6 +31,8 @@ uint8_t layer_stack__push    ( uint8_t offset,
 uint8_t layer_stack__pop_id  (uint8_t layer_id);
 uint8_t layer_stack__find_id (uint8_t layer_id);
 uint8_t layer_stack__size    (void);
+// -------
+uint16_t layer_stack__generation (void);
 
 
 // ----------------------------------------------------------------------------
@@ -81,6 +83,9 @@ uint8_t layer_stack__size    (void);
  * - If the given layer-id is present in the stack, the element with that
  *   layer-id is updated; this preserves the expectation that all layer-id's in
  *   the stack will be unique
+ * - Pushing a new element fails if the stack is full (its size is fixed at
+ *   compile time by some implementations), or if the implementation doesn't
+ *   support the given layer-id
  */
 
 // === layer_stack__pop_id() ===
@@ -115,3 +120,17 @@ uint8_t layer_stack__size    (void);
  * - success: the current size (height) of the layer-stack (`0` if empty)
  */
 
+// === layer_stack__generation ===
+/**                               functions/layer_stack__generation/description
+ * Return a number that changes every time the contents of the layer-stack do
+ *
+ * Returns:
+ * - success: the number of successful calls to `layer_stack__push()` and
+ *   `layer_stack__pop_id()` so far (modulo 2^16)
+ *
+ * Notes:
+ * - Meant for code that caches the result of searching the layer-stack (like
+ *   the layout's `kb__layout__exec_key()`): if the generation hasn't changed
+ *   since the cache was filled, neither has the layer-stack.
+ */
+
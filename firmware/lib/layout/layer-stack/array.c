@@ -22,6 +22,10 @@
  *   everywhere it's used seems worth it, since the amount of core code that
  *   would be able to be generalized out anyway is relatively small and
  *   straightforward.
+ * - Resizing on demand means calling `realloc()` on most pushes and pops,
+ *   which takes a while, and can fragment the heap.  So unless
+ *   `OPT__LAYER_STACK__SIZE` is `0`, the stack is statically allocated
+ *   instead, and pushing onto a full stack fails.
  */
 
 
@@ -32,6 +36,25 @@
 
 // ----------------------------------------------------------------------------
 
+#ifndef OPT__LAYER_STACK__SIZE
+    #error "OPT__LAYER_STACK__SIZE not defined"
+#endif
+#if OPT__LAYER_STACK__SIZE < 0 || OPT__LAYER_STACK__SIZE > 255
+    #error "OPT__LAYER_STACK__SIZE must be between 0 and 255 inclusive"
+#endif
+
+/**                                   macros/OPT__LAYER_STACK__SIZE/description
+ * The maximum number of elements in the layer-stack, or `0` to allocate the
+ * stack dynamically
+ *
+ * Notes:
+ * - Each element takes 2 bytes of SRAM.
+ * - When the stack is full, `layer_stack__push()` fails (returns
+ *   `UINT8_MAX`), and the layer is not pushed.
+ */
+
+// ----------------------------------------------------------------------------
+
 /**                                               macros/MIN_UNUSED/description
  * The minimum number of elements to have unused after a resize
  */
@@ -62,9 +85,11 @@ typedef struct {
  * To hold the layer-stack and directly related metadata
  *
  * Struct members:
- * - `allocated`:  The number of positions allocated
+ * - `allocated`:  The number of positions allocated (only if the stack is
+ *   dynamically allocated)
  * - `filled`: The number of positions filled
- * - `data`: A pointer to the array of layer-elements
+ * - `data`: The array of layer-elements (or a pointer to it, if the stack is
+ *   dynamically allocated)
  *
  * Notes:
  * - The maximum value of `uint8_t filled` is `UINT8_MAX` indicating a stack
@@ -73,17 +98,30 @@ typedef struct {
  *   therefore always be an invalid value for an offset or index.
  */
 static struct {
+#if OPT__LAYER_STACK__SIZE
+    uint8_t filled;
+    element_t data[OPT__LAYER_STACK__SIZE];
+#else
     uint8_t allocated;
     uint8_t filled;
     element_t * data;
+#endif
 } stack;
 
+/**                                            variables/generation/description
+ * Incremented every time the layer-stack is modified (see
+ * `layer_stack__generation()`)
+ */
+static uint16_t generation;
+
 // ----------------------------------------------------------------------------
 
 /**                                          functions/resize_stack/description
  * Resize the stack, so that the number of unused elements is between
  * `MIN_UNUSED` and `MAX_UNUSED`, inclusive
  *
+ * If the stack is statically allocated, just check that it's big enough.
+ *
  * Returns:
  * - success: `0`
  * - failure: [other]
@@ -100,6 +138,9 @@ static struct {
  *   for `malloc()` in avr-libc.
  */
 static uint8_t resize_stack(void) {
+#if OPT__LAYER_STACK__SIZE
+    return stack.filled > OPT__LAYER_STACK__SIZE;  // error: stack full
+#else
     int8_t unused = stack.allocated - stack.filled;
 
     if (MIN_UNUSED <= unused && unused <= MAX_UNUSED)
@@ -121,6 +162,7 @@ static uint8_t resize_stack(void) {
     stack.data = new_data;
 
     return 0;  // success
+#endif
 }
 
 // ----------------------------------------------------------------------------
@@ -141,6 +183,7 @@ uint8_t layer_stack__push( uint8_t offset,
         uint8_t old_offset = layer_stack__find_id(layer_id);
         if (old_offset != UINT8_MAX) {
             stack.data[stack.filled-1-old_offset].number = layer_number;
+            generation++;
             return old_offset;
         }
     }
@@ -168,6 +211,7 @@ uint8_t layer_stack__push( uint8_t offset,
     stack.data[index].id = layer_id;
     stack.data[index].number = layer_number;
 
+    generation++;
     return offset;  // success
 }
 
@@ -191,6 +235,7 @@ uint8_t layer_stack__pop_id(uint8_t layer_id) {
     stack.filled--;
     resize_stack();  // we're shrinking the stack, so this should never fail
 
+    generation++;
     return offset;  // success
 }
 
@@ -205,3 +250,7 @@ uint8_t layer_stack__size(void) {
     return stack.filled;
 }
 
+uint16_t layer_stack__generation(void) {
+    return generation;
+}
+
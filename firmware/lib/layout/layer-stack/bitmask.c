@@ -0,0 +1,159 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the layer-stack defined in "../layer-stack.h", keeping the set of
+ * active layer-ids as a bitmask
+ *
+ * Notes:
+ * - Layer-ids must be less than `MAX_SIZE` (32).  Pushing a layer with a
+ *   larger id fails.
+ * - Everything is statically allocated (about 100 bytes of SRAM), so unlike
+ *   the "array" implementation this one never calls `malloc()`, and can't fail
+ *   for lack of memory.
+ * - `layer_stack__find_id()` and `layer_stack__peek()` are constant time, as
+ *   are pushes onto and pops off of the top of the stack (which is what
+ *   almost every layer key does).  Pushing or popping below the top still has
+ *   to shift the elements above it, as in the "array" implementation.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../layer-stack.h"
+
+// ----------------------------------------------------------------------------
+
+/**                                                 macros/MAX_SIZE/description
+ * The maximum number of elements (and one more than the maximum layer-id)
+ *
+ * Notes:
+ * - This must match the number of bits in `stack.active`.
+ */
+#define  MAX_SIZE  32
+
+/**                                                      macros/BIT/description
+ * The bit in `stack.active` corresponding to the given layer-id
+ */
+#define  BIT(layer_id)  ( (uint32_t)1 << (layer_id) )
+
+// ----------------------------------------------------------------------------
+
+/**                                                 variables/stack/description
+ * To hold the layer-stack and directly related metadata
+ *
+ * Struct members:
+ * - `active`: A bitmask of the layer-ids currently in the stack
+ * - `filled`: The number of positions filled
+ * - `order`: The layer-ids in the stack, from the bottom (index `0`) to the
+ *   top (index `filled-1`)
+ * - `index`: The index into `order` of each active layer-id
+ * - `number`: The layer-number of each active layer-id
+ *
+ * Notes:
+ * - `index` and `number` are indexed by layer-id, and are only meaningful for
+ *   layer-ids whose bit in `active` is set.
+ */
+static struct {
+    uint32_t active;
+    uint8_t  filled;
+    uint8_t  order  [MAX_SIZE];
+    uint8_t  index  [MAX_SIZE];
+    uint8_t  number [MAX_SIZE];
+} stack;
+
+/**                                            variables/generation/description
+ * Incremented every time the layer-stack is modified (see
+ * `layer_stack__generation()`)
+ */
+static uint16_t generation;
+
+// ----------------------------------------------------------------------------
+
+uint8_t layer_stack__peek(uint8_t offset) {
+    if (offset >= stack.filled)
+        return 0;  // default
+
+    return stack.number[ stack.order[stack.filled-1-offset] ];
+}
+
+uint8_t layer_stack__push( uint8_t offset,
+                           uint8_t layer_id,
+                           uint8_t layer_number ) {
+
+    // if an element with the given layer-id already exists
+    {
+        uint8_t old_offset = layer_stack__find_id(layer_id);
+        if (old_offset != UINT8_MAX) {
+            stack.number[layer_id] = layer_number;
+            generation++;
+            return old_offset;
+        }
+    }
+
+    // add an element
+    if (layer_id >= MAX_SIZE || offset > stack.filled)
+        return UINT8_MAX;  // error: invalid layer-id, or index out of bounds
+    uint8_t index = stack.filled - offset;
+
+    // shift up
+    // - start with the top element, and continue until we've moved the element
+    //   currently at `index`
+    // - if `index` is the top, this will do nothing
+    for (uint8_t i = stack.filled; i > index; i--) {
+        stack.order[i] = stack.order[i-1];
+        stack.index[ stack.order[i] ] = i;
+    }
+
+    // set values
+    stack.order[index]     = layer_id;
+    stack.index[layer_id]  = index;
+    stack.number[layer_id] = layer_number;
+    stack.active |= BIT(layer_id);
+    stack.filled++;
+
+    generation++;
+    return offset;  // success
+}
+
+uint8_t layer_stack__pop_id(uint8_t layer_id) {
+    uint8_t offset = layer_stack__find_id(layer_id);
+
+    if (offset == UINT8_MAX)
+        return UINT8_MAX;  // error: no element with given layer-id
+
+    // shift down
+    // - start with the element above the one being removed, and continue
+    //   until we've moved the top element
+    // - if the top element is being removed, this will do nothing
+    for (uint8_t i = stack.index[layer_id]+1; i < stack.filled; i++) {
+        stack.order[i-1] = stack.order[i];
+        stack.index[ stack.order[i-1] ] = i-1;
+    }
+
+    // remove an element
+    stack.active &= ~BIT(layer_id);
+    stack.filled--;
+
+    generation++;
+    return offset;  // success
+}
+
+uint8_t layer_stack__find_id(uint8_t layer_id) {
+    if (layer_id >= MAX_SIZE || !(stack.active & BIT(layer_id)))
+        return UINT8_MAX;  // error: no element with given layer-id
+
+    return stack.filled-1-stack.index[layer_id];  // offset
+}
+
+uint8_t layer_stack__size(void) {
+    return stack.filled;
+}
+
+uint16_t layer_stack__generation(void) {
+    return generation;
+}
+
@@ -9,7 +9,21 @@
 #
 # This file is meant to be included by the using '.../options.mk'
 #
+# Variables:
+# - `LAYER_STACK`: Which implementation to use
+#     - `array`: An array of `OPT__LAYER_STACK__SIZE` elements, statically
+#       allocated (pushing onto a full stack fails), and allows any layer-id.
+#       If `OPT__LAYER_STACK__SIZE` is `0`, the array is allocated
+#       dynamically instead, and resized (with `realloc()`) on push and pop,
+#       which uses as little SRAM as possible but takes longer and can
+#       fragment the heap.
+#     - `bitmask`: A statically allocated stack, with the active layer-ids
+#       kept in a bitmask; finding a layer-id, and pushing and popping on top,
+#       are constant time, but layer-ids must be less than 32
+#
+
 
+LAYER_STACK ?= array
 
-SRC += $(wildcard $(CURDIR)/*.c)
+SRC += $(wildcard $(CURDIR)/$(LAYER_STACK).c)
 
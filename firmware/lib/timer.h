@@ -45,20 +45,42 @@
 // ----------------------------------------------------------------------------
 
 
+#include <stdint.h>
+
+// ----------------------------------------------------------------------------
+
+typedef uint16_t timer__event_t;
+
+// ----------------------------------------------------------------------------
+
 uint8_t  timer__init             (void);
 
 uint16_t timer__get_cycles       (void);
 uint16_t timer__get_keypresses   (void);
 uint16_t timer__get_milliseconds (void);
 
-uint8_t  timer__schedule_cycles       (uint16_t ticks, void(*function)(void));
-uint8_t  timer__schedule_keypresses   (uint16_t ticks, void(*function)(void));
+timer__event_t timer__schedule_cycles
+                        ( uint16_t ticks,
+                          void(*function)(void * context),
+                          void *   context );
+timer__event_t timer__schedule_keypresses
+                        ( uint16_t ticks,
+                          void(*function)(void * context),
+                          void *   context );
+timer__event_t timer__schedule_milliseconds
+                        ( uint16_t ticks,
+                          void(*function)(void * context),
+                          void *   context );
+
+uint8_t timer__cancel     (timer__event_t event);
+uint8_t timer__reschedule (timer__event_t event, uint16_t ticks);
 
 // ----------------------------------------------------------------------------
 // private
 
 void timer___tick_cycles       (void);
 void timer___tick_keypresses   (void);
+void timer___tick_milliseconds (void);
 
 
 // ----------------------------------------------------------------------------
@@ -72,6 +94,23 @@ void timer___tick_keypresses   (void);
 // ============================================================================
 
 
+// ----------------------------------------------------------------------------
+// types ----------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// === timer__event_t ===
+/**                                            types/timer__event_t/description
+ * A handle to a scheduled event (as returned by the schedule functions), for
+ * canceling or rescheduling it
+ *
+ * Notes:
+ * - `0` is never a valid handle.
+ * - A handle stops being valid once the event runs (including while it's
+ *   running) or is canceled.  Functions taking a handle fail harmlessly if
+ *   given one that's no longer valid.
+ */
+
+
 // ----------------------------------------------------------------------------
 // functions ------------------------------------------------------------------
 // ----------------------------------------------------------------------------
@@ -153,23 +192,46 @@ void timer___tick_keypresses   (void);
 
 // === (group) schedule ===
 /**                                      functions/(group) schedule/description
- * Schedule `function` to run in the given number of "ticks"
+ * Schedule `function` to run (with `context`) in the given number of "ticks"
  *
  * Members:
  * - `timer__schedule_cycles`
  * - `timer__schedule_keypresses`
+ * - `timer__schedule_milliseconds`
  *
  * Arguments:
  * - `ticks`: The number of ticks to wait
  * - `function`: A pointer to the function to run
+ * - `context`: The argument to pass to `function` (for example, a pointer to
+ *   the state of whatever scheduled it), or `NULL`
  *
  * Returns:
- * - success: `0`
- * - failure: [other]
+ * - success: A handle to the event (see `timer__event_t`)
+ * - failure: `0` (too many events are already scheduled)
  *
  *
  * Usage notes:
  *
+ * - Events that are due on the same tick run in the order they were
+ *   scheduled.
+ *
+ * - The same function may be scheduled any number of times, with different
+ *   contexts, so one function can serve any number of keys (or anything
+ *   else) that need to wait.
+ *
+ * - Functions scheduled with `timer__schedule_milliseconds()` run from the
+ *   main loop (see `timer___tick_milliseconds()`), never from an interrupt;
+ *   so they run as soon as possible after *more than* `ticks - 1`
+ *   milliseconds have passed (since we don't know how far into the current
+ *   millisecond we are when they're scheduled).  The main loop checks while
+ *   it waits between scans, so they're late by at most however long the scan
+ *   in progress takes, no matter how often scans happen.
+ *
+ * - Use `timer__schedule_milliseconds()` for anything that depends on real
+ *   time (like waiting for hardware).  Cycles last at least
+ *   `OPT__DEBOUNCE_TIME` milliseconds, but how much longer depends on what's
+ *   being done during the scan.
+ *
  * - If a function needs a longer wait time than is possible with a 16-bit
  *   resolution counter, it can repeatedly schedule itself to run in, say, 1
  *   minute (= 1000*60/5 cycles, assuming cycles take on average 5
@@ -178,6 +240,36 @@ void timer___tick_keypresses   (void);
  *   delay).
  */
 
+// === timer__cancel() ===
+/**                                         functions/timer__cancel/description
+ * Cancel a scheduled event, so that it won't run
+ *
+ * Arguments:
+ * - `event`: A handle to the event
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (the event is not scheduled)
+ */
+
+// === timer__reschedule() ===
+/**                                     functions/timer__reschedule/description
+ * Change when a scheduled event will run
+ *
+ * Arguments:
+ * - `event`: A handle to the event
+ * - `ticks`: The number of ticks (of the same timer the event was scheduled
+ *   with) to wait, counting from now, as for the schedule functions
+ *
+ * Returns:
+ * - success: `0` (the handle is still valid)
+ * - failure: [other] (the event is not scheduled)
+ *
+ * Notes:
+ * - A rescheduled event runs after any other events due on the same tick
+ *   (as if it had just been scheduled).
+ */
+
 // ----------------------------------------------------------------------------
 // private
 
@@ -196,3 +288,16 @@ void timer___tick_keypresses   (void);
  * Meant to be used only by `kb__layout__exec_key()`
  */
 
+// === timer___tick_milliseconds() ===
+/**                             functions/timer___tick_milliseconds/description
+ * Bring the counter for the number of milliseconds (as far as scheduled tasks
+ * are concerned) up to date, and perform scheduled tasks
+ *
+ * Meant to be used only by `main()`, as often as is convenient
+ *
+ * Notes:
+ * - The number of milliseconds is counted by an interrupt.  Scheduled tasks
+ *   are performed here (rather than by the interrupt) so that they don't
+ *   interrupt anything else.
+ */
+
@@ -15,6 +15,7 @@
 #include <stdint.h>
 #include <avr/interrupt.h>
 #include <avr/io.h>
+#include <util/atomic.h>
 #include "../../timer.h"
 
 // ----------------------------------------------------------------------------
@@ -42,7 +43,15 @@ uint8_t timer__init(void) {
 }
 
 uint16_t timer__get_milliseconds(void) {
-    return milliseconds.counter;
+    uint16_t counter;
+
+    // - the counter is 2 bytes, so the interrupt could change it between our
+    //   reading one and the other
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        counter = milliseconds.counter;
+    }
+
+    return counter;
 }
 
 ISR(TIMER0_COMPA_vect) {
@@ -7,25 +7,56 @@
 /**                                                                 description
  * Implements the device agnostic portion of the timer interface defined in
  * ".../firmware/lib/timer.h"
+ *
+ * Each timer keeps its scheduled events in a "delta list": a linked list,
+ * sorted by when each event is due, where each event stores the number of
+ * ticks between it and the event before it.  So a tick only ever has to look
+ * at (and decrement) the first event in the list, no matter how many are
+ * scheduled; the work of finding an event's place is done once, when it's
+ * scheduled.
+ *
+ * Events are allocated from a fixed pool (shared by all the timers), so
+ * nothing here uses the heap.  A handle to an event (`timer__event_t`) is its
+ * index in the pool, along with a "generation" that changes every time the
+ * event is freed, so a handle to an event that has already run (or been
+ * canceled) can't be mistaken for a handle to whatever uses the same spot
+ * next.
+ *
+ * The milliseconds timer works the same way, except that its counter is only
+ * brought up to date (from `timer__get_milliseconds()`, which counts in an
+ * interrupt) when `timer___tick_milliseconds()` is called from the main loop;
+ * so a tick may be several milliseconds long, and scheduled functions never
+ * run from inside the interrupt.
  */
 
 
+#include <stdbool.h>
 #include <stdint.h>
-#include <stdlib.h>
 #include "../timer.h"
 
 // ----------------------------------------------------------------------------
 // macros ---------------------------------------------------------------------
 
-/**                                               macros/MIN_UNUSED/description
- * The minimum number of elements to have unused after a resize
+#ifndef OPT__TIMER__EVENTS
+    #error "OPT__TIMER__EVENTS not defined"
+#endif
+
+/**                                       macros/OPT__TIMER__EVENTS/description
+ * The number of events that can be scheduled at once (by all the timers
+ * together)
+ *
+ * Notes:
+ * - Must be less than `UINT8_MAX` (which we use to mean "no event").
+ * - Each event takes 8 bytes of SRAM.
  */
-#define  MIN_UNUSED  0
+#if OPT__TIMER__EVENTS >= 255
+    #error "OPT__TIMER__EVENTS must be < 255"
+#endif
 
-/**                                               macros/MAX_UNUSED/description
- * The maximum number of elements to have unused after a resize
+/**                                                     macros/NONE/description
+ * The index of "no event" (used to terminate lists)
  */
-#define  MAX_UNUSED  4
+#define  NONE  UINT8_MAX
 
 // ----------------------------------------------------------------------------
 // types ----------------------------------------------------------------------
@@ -34,190 +65,344 @@
  * To hold an event that should be run at some point in the future
  *
  * Struct members:
- * - `ticks`: The number of units of time to wait until running this event
+ * - `ticks`: The number of ticks between when the previous event in the list
+ *   is due and when this one is (or, for the first event, the number of ticks
+ *   left until this one is due)
  * - `function`: The event (the function to run)
+ * - `context`: The argument to pass to `function`
+ * - `next`: The index (into `events`) of the next event in the list, or `NONE`
+ * - `timer`: The index (into `timers`) of the timer whose list this event is
+ *   in (if it's in one)
+ * - `generation`: The generation of this event (see the description of this
+ *   file); never `0`, so no handle is `0`
  */
 typedef struct {
     uint16_t ticks;
-    void (*function)(void);
+    void (*function)(void * context);
+    void *   context;
+    uint8_t  next;
+    uint8_t  timer      : 2;
+    uint8_t  generation : 6;
 } event_t;
 
-/**                                                    types/list_t/description
- * To hold a list of events, with corresponding metadata
- *
- * Struct members:
- * - `allocated`: The number of positions allocated
- * - `filled`: The number of positions filled
- * - `data`: A list of events to run at some point in the future
- */
-typedef struct {
-    uint8_t   allocated;
-    uint8_t   filled;
-    event_t * data;
-} list_t;
-
 /**                                                   types/timer_t/description
  * To hold all the variables needed by a timer
  *
  * Struct members:
  * - `counter`: How many "ticks" of this timer have occurred since it was
- *   initialized (mod 2^16)
- * - `scheduled`: The list of events to be eventually run by this timer, with
- *   corresponding metadata
- *
+ *   initialized (mod 2^16), as of the last tick
+ * - `ticking`: Whether this timer is in the middle of a tick (running events)
+ * - `head`: The index (into `events`) of the first event in this timer's
+ *   list, or `NONE`
  */
 typedef struct {
     uint16_t counter;
-    list_t   scheduled;
+    bool     ticking;
+    uint8_t  head;
 } timer_t;
 
+/**                                              types/(enum) timer/description
+ * Indices into `timers`
+ *
+ * Members:
+ * - `CYCLES`
+ * - `KEYPRESSES`
+ * - `MILLISECONDS`
+ */
+enum timer {
+    CYCLES,
+    KEYPRESSES,
+    MILLISECONDS,
+};
+
+// ----------------------------------------------------------------------------
+// variables ------------------------------------------------------------------
+
+/**                                                variables/events/description
+ * The pool of events, and the index of the first unused one
+ *
+ * Notes:
+ * - Unused events are kept in a list of their own (linked by `next`), starting
+ *   at `unused`.  This is set up the first time an event is scheduled (which
+ *   may be before `timer__init()` is called), and `initialized` is set.
+ */
+static event_t events[OPT__TIMER__EVENTS];
+static uint8_t unused;
+static bool    initialized;
+
+/**                                                variables/timers/description
+ * The timers (indexed by `enum timer`)
+ */
+static timer_t timers[] = {
+    [CYCLES]       = { .head = NONE },
+    [KEYPRESSES]   = { .head = NONE },
+    [MILLISECONDS] = { .head = NONE },
+};
+
 // ----------------------------------------------------------------------------
 // variable manipulator functions ---------------------------------------------
 
-/**                                                functions/resize/description
- * Resize `list->data`, so that the number of unused elements is between
- * `MIN_UNUSED` and `MAX_UNUSED`, inclusive
+/**                                                functions/handle/description
+ * Return the handle for the event at index `e`
+ */
+static timer__event_t handle(uint8_t e) {
+    return ( (timer__event_t)events[e].generation << 8 ) | e;
+}
+
+/**                                                  functions/find/description
+ * Return the index of the event `event` is a handle for, if the event is
+ * still scheduled; otherwise, `NONE`
+ */
+static uint8_t find(timer__event_t event) {
+    uint8_t e = event & 0xFF;
+
+    if ( !initialized || e >= OPT__TIMER__EVENTS ||
+         events[e].generation != event >> 8 )
+        return NONE;
+
+    return e;
+}
+
+/**                                            functions/free_event/description
+ * Return the event at index `e` (which must not be in any timer's list) to the
+ * pool, and start its next generation
  *
- * Arguments:
- * - `list`: A pointer to the list to operate on
+ * Notes:
+ * - Generations wrap around after 63, so a handle kept for that many uses of
+ *   the same event after the event has run may be mistaken for a new one.
+ */
+static void free_event(uint8_t e) {
+    events[e].generation = (events[e].generation == 0x3F)
+                           ? 1 : events[e].generation + 1;
+    events[e].next = unused;
+    unused = e;
+}
+
+/**                                                  functions/link/description
+ * Put the event at index `e` into `timer`'s list
  *
- * Returns:
- * - success: `0`
- * - failure: [other]
+ * Arguments:
+ * - `timer`: The timer to operate on
+ * - `e`: The index of the event (which must not be in any timer's list)
+ * - `ticks`: The number of ticks to wait (as passed to a schedule function)
  *
- * Implementation notes:
- * - We use a signed type for `unused` in case `filled` is greater than
- *   `allocated`, as may happen when appending a new event.  This number should
- *   normally be much smaller than either `filled` or `allocated`, so there is
- *   no need to worry about using a signed type (with a smaller maximum value)
- *   rather than an unsigned one.
- * - The only time `realloc()` should fail is if we are trying to grow the
- *   stack.  See [the documentation]
- *   (http://www.nongnu.org/avr-libc/user-manual/malloc.html)
- *   for `malloc()` in avr-libc.
+ * Notes:
+ * - An event goes after every event that's due at the same time or earlier,
+ *   so events that are due together run in the order they were scheduled.
+ * - Outside of a tick, an event scheduled to run in `0` ticks runs at the
+ *   next tick.  During a tick (i.e. from an event being run by the tick),
+ *   `ticks` counts from the tick in progress, so an event scheduled to run in
+ *   `0` ticks runs during this one, after the events already due, and one
+ *   scheduled to run in `1` tick runs at the next.
+ * - The milliseconds timer is only brought up to date when it ticks, so
+ *   outside of a tick we add the number of milliseconds since then.
  */
-static uint8_t resize(list_t * list) {
-    int8_t unused = list->allocated - list->filled;
+static void link(enum timer timer, uint8_t e, uint16_t ticks) {
+    timer_t * t = &timers[timer];
+
+    if (!t->ticking) {
+        uint16_t offset = (timer == MILLISECONDS)
+                          ? timer__get_milliseconds() - t->counter
+                          : 1;  // (the tick that runs it counts)
+        ticks = (ticks < UINT16_MAX - offset) ? ticks + offset : UINT16_MAX;
+    }
 
-    if (MIN_UNUSED <= unused && unused <= MAX_UNUSED)
-        return 0;  // nothing to do
+    // find the events it goes between
+    uint8_t previous = NONE;
+    uint8_t current  = t->head;
+    while (current != NONE && events[current].ticks <= ticks) {
+        ticks -= events[current].ticks;
+        previous = current;
+        current  = events[current].next;
+    }
+
+    events[e].ticks = ticks;
+    events[e].next  = current;
+    events[e].timer = timer;
+
+    if (current != NONE)
+        events[current].ticks -= ticks;
 
-    uint8_t new_allocated;
-    if (UINT8_MAX >= list->filled + (MIN_UNUSED+MAX_UNUSED)/2)
-        new_allocated = list->filled + (MIN_UNUSED+MAX_UNUSED)/2;
-    else if (UINT8_MAX >= list->filled + MIN_UNUSED)
-        new_allocated = UINT8_MAX;
+    if (previous == NONE)
+        t->head = e;
     else
-        return 1;  // unable to count the required number of elements
+        events[previous].next = e;
+}
 
-    void * new_data = realloc( list->data, sizeof(event_t) * new_allocated );
-    if (!new_data)
-        return 1;  // error: `realloc()` failed (unable to grow list)
+/**                                                functions/unlink/description
+ * Take the event at index `e` out of the list it's in
+ *
+ * Notes:
+ * - The event after it (if there is one) is due relative to it, so that one
+ *   gets its ticks.
+ */
+static void unlink(uint8_t e) {
+    timer_t * t = &timers[events[e].timer];
+
+    uint8_t previous = NONE;
+    uint8_t current  = t->head;
+    while (current != e) {
+        previous = current;
+        current  = events[current].next;
+    }
 
-    list->allocated = new_allocated;
-    list->data = new_data;
+    if (events[e].next != NONE)
+        events[events[e].next].ticks += events[e].ticks;
 
-    return 0;  // success
+    if (previous == NONE)
+        t->head = events[e].next;
+    else
+        events[previous].next = events[e].next;
 }
 
-/**                                                functions/append/description
- * Append a new event containing the passed information to `list->data`
- *
- * Arguments:
- * - `list`: A pointer to the list to operate on
- * - `ticks`: The value to put into the event's corresponding field
- * - `function`: The value to put into the event's corresponding field
+/**                                              functions/schedule/description
+ * Schedule `function` to run with `context` in `ticks` ticks of `timer`
  *
  * Returns:
- * - success: `0`
- * - failure: [other]
+ * - success: A handle to the event
+ * - failure: `0`
  */
-static uint8_t append(list_t * list, uint16_t ticks, void(*function)(void)) {
+static timer__event_t schedule( enum timer timer,
+                                uint16_t   ticks,
+                                void(*function)(void * context),
+                                void *     context ) {
     if (!function)
         return 0;  // nothing to do
 
-    if (list->filled == UINT8_MAX)
-        return 1;  // error: list already full
-    list->filled++;
-    if(resize(list)) {
-        list->filled--;
-        return 1;  // resize failed
+    if (!initialized) {
+        for (uint8_t i = 0; i < OPT__TIMER__EVENTS; i++) {
+            events[i].next       = (i+1 < OPT__TIMER__EVENTS) ? i+1 : NONE;
+            events[i].generation = 1;
+        }
+        unused = 0;
+        initialized = true;
     }
 
-    list->data[list->filled - 1].ticks    = ticks;
-    list->data[list->filled - 1].function = function;
+    if (unused == NONE)
+        return 0;  // error: no unused events left
 
-    return 0;  // success
+    uint8_t e = unused;
+    unused = events[e].next;
+
+    events[e].function = function;
+    events[e].context  = context;
+    link(timer, e, ticks);
+
+    return handle(e);
 }
 
-/**                                                    function/pop/description
- * Remove the event at `index` from `list->data`
+/**                                                  functions/tick/description
+ * Add `elapsed` to `timer`'s counter, and run (and forget) the events that
+ * are due
  *
  * Arguments:
- * - `list`: A pointer to the list to operate on
- * - `index`: The index of the event to pop
+ * - `timer`: The timer to operate on
+ * - `elapsed`: The number of ticks that have passed since the last tick
+ *
+ * Notes:
+ * - Only the events that are due, and the first one that isn't, are
+ *   decremented.  The events that follow are due relative to those, so this
+ *   counts for them as well.
+ * - All of `elapsed` is taken off the list before anything runs, so that
+ *   events scheduled by the events we run are placed relative to the right
+ *   time.
+ * - An event is freed before it's run, so that it's free to schedule itself
+ *   again (and so its handle is no longer valid while it runs).
  */
-static void pop(list_t * list, uint8_t index) {
-    // shift down
-    // - start with the element at `index`, and copy the element above it down
-    // - continue until we copy the top element (which will then be duplicated
-    //   at indices `list->filled - 2` and `list->filled - 1`)
-    // - if the top element is at `index` (or `index` is out of bounds), this
-    //   will do nothing
-    for (uint8_t i = index; i < list->filled - 1; i++)
-        list->data[i] = list->data[i+1];
+static void tick(enum timer timer, uint16_t elapsed) {
+    timer_t * t = &timers[timer];
 
-    // remove an element
-    list->filled--;
-    resize(list);  // we're shrinking the list, so this should never fail
-}
+    t->counter += elapsed;
 
-// ----------------------------------------------------------------------------
-// variables ------------------------------------------------------------------
+    if (t->head == NONE)
+        return;  // nothing to do
 
-static timer_t cycles;
-static timer_t keypresses;
+    t->ticking = true;
+
+    for (uint8_t e = t->head; e != NONE && elapsed; e = events[e].next) {
+        if (events[e].ticks <= elapsed) {
+            elapsed -= events[e].ticks;
+            events[e].ticks = 0;
+        } else {
+            events[e].ticks -= elapsed;
+            elapsed = 0;
+        }
+    }
+
+    while (t->head != NONE && events[t->head].ticks == 0) {
+        uint8_t due = t->head;
+        void (*function)(void * context) = events[due].function;
+        void * context = events[due].context;
+
+        t->head = events[due].next;
+        free_event(due);
+
+        (*function)(context);
+    }
+
+    t->ticking = false;
+}
 
 // ----------------------------------------------------------------------------
 // front end functions --------------------------------------------------------
 
 uint16_t timer__get_cycles(void) {
-    return cycles.counter;
+    return timers[CYCLES].counter;
 }
 
 uint16_t timer__get_keypresses(void) {
-    return keypresses.counter;
+    return timers[KEYPRESSES].counter;
+}
+
+timer__event_t timer__schedule_cycles( uint16_t ticks,
+                                       void(*function)(void * context),
+                                       void *   context ) {
+    return schedule(CYCLES, ticks, function, context);
 }
 
-uint8_t timer__schedule_cycles(uint16_t ticks, void(*function)(void)) {
-    return append(&cycles.scheduled, ticks, function);
+timer__event_t timer__schedule_keypresses( uint16_t ticks,
+                                           void(*function)(void * context),
+                                           void *   context ) {
+    return schedule(KEYPRESSES, ticks, function, context);
 }
 
-uint8_t timer__schedule_keypresses(uint16_t ticks, void(*function)(void)) {
-    return append(&keypresses.scheduled, ticks, function);
+timer__event_t timer__schedule_milliseconds( uint16_t ticks,
+                                             void(*function)(void * context),
+                                             void *   context ) {
+    return schedule(MILLISECONDS, ticks, function, context);
+}
+
+uint8_t timer__cancel(timer__event_t event) {
+    uint8_t e = find(event);
+    if (e == NONE)
+        return 1;  // error: not scheduled
+
+    unlink(e);
+    free_event(e);
+
+    return 0;  // success
+}
+
+uint8_t timer__reschedule(timer__event_t event, uint16_t ticks) {
+    uint8_t e = find(event);
+    if (e == NONE)
+        return 1;  // error: not scheduled
+
+    unlink(e);
+    link(events[e].timer, e, ticks);
+
+    return 0;  // success
 }
 
 void timer___tick_cycles(void) {
-    cycles.counter++;
-    for (uint8_t i = 0; i < cycles.scheduled.filled; i++) {
-        if (cycles.scheduled.data[i].ticks == 0) {
-            (*cycles.scheduled.data[i].function)();
-            pop(&cycles.scheduled, i);
-        } else {
-            cycles.scheduled.data[i].ticks--;
-        }
-    }
+    tick(CYCLES, 1);
 }
 
 void timer___tick_keypresses(void) {
-    keypresses.counter++;
-    for (uint8_t i = 0; i < keypresses.scheduled.filled; i++) {
-        if (keypresses.scheduled.data[i].ticks == 0) {
-            (*keypresses.scheduled.data[i].function)();
-            pop(&keypresses.scheduled, i);
-        } else {
-            keypresses.scheduled.data[i].ticks--;
-        }
-    }
+    tick(KEYPRESSES, 1);
 }
 
+void timer___tick_milliseconds(void) {
+    tick( MILLISECONDS,
+          timer__get_milliseconds() - timers[MILLISECONDS].counter );
+}
@@ -24,15 +24,20 @@
 
 // --- general ---
 
-void usb__init          (void);
-bool usb__is_configured (void);
+void    usb__init          (void);
+bool    usb__is_configured (void);
+bool    usb__is_suspended  (void);
+uint8_t usb__wakeup        (void);
 
 // --- keyboard ---
 
-uint8_t usb__kb__set_key     (bool pressed, uint8_t keycode);
-bool    usb__kb__read_key    (uint8_t keycode);
-bool    usb__kb__read_led    (char led);
-uint8_t usb__kb__send_report (void);
+uint8_t usb__kb__set_key      (bool pressed, uint8_t keycode);
+bool    usb__kb__read_key     (uint8_t keycode);
+uint8_t usb__kb__keys_free    (void);
+bool    usb__kb__read_led     (char led);
+uint8_t usb__kb__send_report  (void);
+uint8_t usb__kb__queue_report (void);
+bool    usb__kb__queue_full   (void);
 
 
 // ----------------------------------------------------------------------------
@@ -70,6 +75,36 @@ uint8_t usb__kb__send_report (void);
  * - Should return `true` before calling any function other than `usb__init()`
  */
 
+// === usb__is_suspended() ===
+/**                                     functions/usb__is_suspended/description
+ * Check whether the host has suspended the bus
+ *
+ * Returns:
+ * - `true`: if the bus is suspended
+ * - `false`: if the bus is active
+ *
+ * Notes:
+ * - While suspended, the device is supposed to draw as little power as it can
+ *   (no more than 2.5 mA; usb spec sec 7.2.3), and reports can't be sent.
+ *   `main()` uses this to turn off the LEDs and to slow down scanning.
+ */
+
+// === usb__wakeup() ===
+/**                                           functions/usb__wakeup/description
+ * Ask the host to resume the bus (remote wakeup)
+ *
+ * Returns:
+ * - success: `0` (resume signaling has been started, or is already in
+ *   progress)
+ * - failure: [other] (the bus isn't suspended, or the host hasn't enabled
+ *   remote wakeup)
+ *
+ * Notes:
+ * - The host decides whether we're allowed to wake it up (by setting or
+ *   clearing the DEVICE_REMOTE_WAKEUP feature), usually before suspending.
+ * - This function does not wait for the bus to resume.
+ */
+
 
 // ----------------------------------------------------------------------------
 // keyboard -------------------------------------------------------------------
@@ -111,6 +146,17 @@ uint8_t usb__kb__send_report (void);
  *   keycodes if the report has been sent since the last change.
  */
 
+// === usb__kb__keys_free() ===
+/**                                    functions/usb__kb__keys_free/description
+ * Return the number of (non-modifier) keycodes that can still be set 'on'
+ * (device side)
+ *
+ * Notes:
+ * - The report has room for 6 keycodes (plus the modifiers, which are always
+ *   available).  Once they're all in use, `usb__kb__set_key()` will fail to
+ *   set any other (non-modifier) keycode 'on'.
+ */
+
 // === usb__kb__read_led() ===
 /**                                     functions/usb__kb__read_led/description
  * Check whether the given (logical) LED is set to 'on' (host side)
@@ -142,5 +188,37 @@ uint8_t usb__kb__send_report (void);
  * Returns:
  * - success: `0`
  * - failure: status code (unspecified, nonzero)
+ *
+ * Notes:
+ * - If there are reports waiting in the queue (see `usb__kb__queue_report()`)
+ *   this report is queued behind them, waiting for room if necessary;
+ *   otherwise it is handed straight to the hardware.
+ */
+
+// === usb__kb__queue_report() ===
+/**                                 functions/usb__kb__queue_report/description
+ * Queue a copy of the current USB report, to be sent to the host in the
+ * background (without waiting)
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (the queue is full)
+ *
+ * Notes:
+ * - Queued reports are sent in order, at most one per USB frame, and before
+ *   any report given to `usb__kb__send_report()` after them.
+ * - This is meant for sending long sequences of reports (e.g. when typing a
+ *   string) without blocking the scan loop.  Check `usb__kb__queue_full()`
+ *   before changing the state of any keys, so that no state is lost if the
+ *   queue turns out to be full.
+ */
+
+// === usb__kb__queue_full() ===
+/**                                   functions/usb__kb__queue_full/description
+ * Check whether the report queue is full
+ *
+ * Returns:
+ * - `true`: if `usb__kb__queue_report()` would fail
+ * - `false`: if there is room for at least one more report
  */
 
@@ -0,0 +1,320 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2012, 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements '.../firmware/lib/usb/common/hal.h' for the ATMega32U4
+ *
+ * Notes:
+ * - While the bus is suspended the USB clock is frozen and the PLL is turned
+ *   off (datasheet sec 21.13), which is most of what we can do here to reduce
+ *   power.  They're turned back on when bus activity is detected (`WAKEUPI`),
+ *   or when we start a remote wakeup.
+ * - The control endpoint is handled entirely from `USB_COM_vect`.  Other
+ *   endpoints are written by the main loop (through `usb__hal__ep__send()`)
+ *   and by `usb___start_of_frame()` (from `USB_GEN_vect`), so all access to
+ *   them is done with interrupts disabled (because `UENUM` is shared).
+ * - The register level code started out as the PJRC "USB Keyboard" example
+ *   <http://www.pjrc.com/teensy/usb_keyboard.html>
+ *
+ * References:
+ * - [Datasheet: ATmega32U4]
+ *   (http://www.atmel.com/Images/doc7766.pdf)
+ *   sections 21 (USB controller) and 22 (USB device operating modes)
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "../common/definitions.h"
+#include "../common/device.h"
+#include "../common/hal.h"
+
+// ----------------------------------------------------------------------------
+
+#if F_CPU != 16000000
+    #error "Expecting different CPU frequency"
+#endif
+
+// ----------------------------------------------------------------------------
+
+#define  _ENDPOINTS  7  // endpoints 0..6 (datasheet sec 22.1)
+
+/**                                                macros/_EP__SIZE/description
+ * Return the `EPSIZE` bits of `UECFG1X` for the given endpoint size
+ */
+#define  _EP__SIZE(size)  ( (size) <=  8 ? (0<<EPSIZE0) \
+                          : (size) <= 16 ? (1<<EPSIZE0) \
+                          : (size) <= 32 ? (2<<EPSIZE0) \
+                          :                (3<<EPSIZE0) )
+
+/**                                           macros/_EP__SEND_BANK/description
+ * The value to write to `UEINTX` to hand the current bank to the hardware
+ *
+ * Clears `TXINI` and `FIFOCON` (datasheet sec 22.14); the other flags are
+ * left alone (writing `1` to them has no effect).
+ */
+#define  _EP__SEND_BANK  ( (uint8_t) ~( (1<<FIFOCON) | (1<<NAKINI) \
+                                      | (1<<RXOUTI)  | (1<<TXINI) ) )
+
+// ----------------------------------------------------------------------------
+
+/**                                     functions/_control__wait_in/description
+ * Wait until the control endpoint is ready for an IN packet (or the host has
+ * moved on to the status stage)
+ *
+ * Returns:
+ * - `true`: if the endpoint is ready
+ * - `false`: if the host aborted the transfer
+ */
+static inline bool _control__wait_in(void) {
+    uint8_t intbits;
+    do {
+        intbits = UEINTX;
+    } while ( !(intbits & ((1<<TXINI)|(1<<RXOUTI))) );
+    return !(intbits & (1<<RXOUTI));
+}
+
+static inline void _control__send_in(void) {
+    UEINTX = ~(1<<TXINI);
+}
+
+// ----------------------------------------------------------------------------
+
+/**                                         functions/_clock__start/description
+ * Turn on the PLL, wait for it to lock, and unfreeze the USB clock
+ */
+static inline void _clock__start(void) {
+    PLLCSR = (1<<PINDIV)|(1<<PLLE);                     // 16 MHz in, PLL on
+    while (!(PLLCSR & (1<<PLOCK)));                     // wait for the PLL
+    USBCON &= ~(1<<FRZCLK);                             // unfreeze the clock
+}
+
+/**                                          functions/_clock__stop/description
+ * Freeze the USB clock, and turn off the PLL
+ */
+static inline void _clock__stop(void) {
+    USBCON |= (1<<FRZCLK);
+    PLLCSR &= ~(1<<PLLE);
+}
+
+// ----------------------------------------------------------------------------
+
+void usb__hal__init(void) {
+    UHWCON = (1<<UVREGE);                               // enable the pad
+                                                        //   regulator
+    USBCON = (1<<USBE)|(1<<FRZCLK);                     // enable USB, clock
+                                                        //   frozen
+    PLLCSR = (1<<PINDIV)|(1<<PLLE);                     // 16 MHz in, PLL on
+    while (!(PLLCSR & (1<<PLOCK)));                     // wait for the PLL
+    USBCON = (1<<USBE)|(1<<OTGPADE);                    // unfreeze the clock
+    UDCON  = 0;                                         // attach
+    UDIEN  = (1<<EORSTE)|(1<<SOFE)|(1<<SUSPE);          // enable interrupts
+    sei();
+}
+
+void usb__hal__set_address(uint8_t address) {
+    while (!(UEINTX & (1<<TXINI)));  // wait for the status stage to finish
+    UDADDR = address | (1<<ADDEN);
+}
+
+void usb__hal__remote_wakeup(void) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!(UDCON & (1<<RMWKUP))) {  // (cleared by hardware when done)
+            _clock__start();
+            UDCON |= (1<<RMWKUP);
+        }
+    }
+}
+
+uint16_t usb__hal__frame_number(void) {
+    uint16_t frame;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        frame = UDFNUML | ((uint16_t)(UDFNUMH & 0x07) << 8);
+    }
+    return frame;
+}
+
+// ----------------------------------------------------------------------------
+
+uint8_t usb__hal__ep__configure( uint8_t address,
+                                 uint8_t attributes,
+                                 uint8_t size,
+                                 uint8_t banks ) {
+    uint8_t number = address & 0x0F;
+    if (number == 0 || number >= _ENDPOINTS)
+        return 1;
+    if (size > 64)
+        return 1;
+
+    uint8_t status = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t previous = UENUM;
+        UENUM   = number;
+        UECONX  = (1<<EPEN);
+        UECFG0X = ((attributes & 0x03) << EPTYPE0)
+                | ((address & USB__ENDPOINT__IN) ? (1<<EPDIR) : 0);
+        UECFG1X = _EP__SIZE(size)
+                | ((banks > 1) ? (1<<EPBK0) : 0)
+                | (1<<ALLOC);
+        if (!(UESTA0X & (1<<CFGOK)))
+            status = 1;
+        UERST = (1<<number);  // reset the FIFO
+        UERST = 0;
+        UENUM = previous;
+    }
+    return status;
+}
+
+void usb__hal__ep__set_halt(uint8_t endpoint, bool halt) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t previous = UENUM;
+        UENUM = endpoint;
+        if (halt) {
+            UECONX = (1<<STALLRQ)|(1<<EPEN);
+        } else {
+            UECONX = (1<<STALLRQC)|(1<<RSTDT)|(1<<EPEN);
+            UERST = (1<<endpoint);
+            UERST = 0;
+        }
+        UENUM = previous;
+    }
+}
+
+bool usb__hal__ep__is_halted(uint8_t endpoint) {
+    bool halted;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t previous = UENUM;
+        UENUM = endpoint;
+        halted = UECONX & (1<<STALLRQ);
+        UENUM = previous;
+    }
+    return halted;
+}
+
+uint8_t usb__hal__ep__send( uint8_t         endpoint,
+                            const uint8_t * data,
+                            uint8_t         length ) {
+    uint8_t status = 1;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t previous = UENUM;
+        UENUM = endpoint;
+        if (UEINTX & (1<<RWAL)) {  // a bank is free
+            for (uint8_t i=0; i<length; i++)
+                UEDATX = data[i];
+            UEINTX = _EP__SEND_BANK;
+            status = 0;
+        }
+        UENUM = previous;
+    }
+    return status;
+}
+
+// ----------------------------------------------------------------------------
+
+void usb__hal__control__send( const uint8_t * data,
+                              uint8_t         length,
+                              uint16_t        requested,
+                              bool            progmem ) {
+    // a full last packet needs to be followed by a zero length packet, unless
+    // we're sending exactly as much as was asked for (usb spec sec 5.5.3)
+    bool zlp = length < requested && length % USB___CONTROL_SIZE == 0;
+
+    uint8_t n;
+    do {
+        if (!_control__wait_in())
+            return;  // aborted
+
+        n = (length < USB___CONTROL_SIZE) ? length : USB___CONTROL_SIZE;
+        for (uint8_t i=n; i; i--)
+            UEDATX = (progmem) ? pgm_read_byte(data++) : *data++;
+        length -= n;
+
+        _control__send_in();
+    } while ( length || (zlp && n == USB___CONTROL_SIZE) );
+}
+
+uint8_t usb__hal__control__receive(uint8_t * data, uint8_t length) {
+    while (!(UEINTX & (1<<RXOUTI)));
+    if (UEBCLX < length)
+        return 1;
+    for (uint8_t i=0; i<length; i++)
+        data[i] = UEDATX;
+    UEINTX = ~(1<<RXOUTI);
+    return 0;
+}
+
+void usb__hal__control__status(void) {
+    _control__send_in();
+}
+
+// ----------------------------------------------------------------------------
+
+/**                                     functions/ISR(USB_GEN_vect)/description
+ * Handle device level events (bus reset, suspend, resume, start of frame)
+ *
+ * Notes:
+ * - `UDIEN` and `UDINT` have the same bit layout, so masking with `UDIEN`
+ *   leaves only the events we're currently interested in.  `SUSPE` and
+ *   `WAKEUPE` are swapped back and forth so that only one is ever enabled.
+ * - `WAKEUPI` can only be cleared while the USB clock is running.
+ */
+ISR(USB_GEN_vect) {
+    uint8_t intbits = UDINT & UDIEN;
+
+    if (intbits & (1<<WAKEUPI)) {
+        _clock__start();
+        UDINT = ~(1<<WAKEUPI);
+        UDIEN = (UDIEN & ~(1<<WAKEUPE)) | (1<<SUSPE);
+        usb___resume();
+    }
+
+    if (intbits & (1<<SUSPI)) {
+        UDINT = ~((1<<SUSPI)|(1<<WAKEUPI));
+        UDIEN = (UDIEN & ~(1<<SUSPE)) | (1<<WAKEUPE);
+        _clock__stop();
+        usb___suspend();
+        return;
+    }
+
+    UDINT = ~intbits;
+
+    if (intbits & (1<<EORSTI)) {
+        UENUM   = 0;
+        UECONX  = (1<<EPEN);
+        UECFG0X = (0<<EPTYPE0);  // control, OUT
+        UECFG1X = _EP__SIZE(USB___CONTROL_SIZE) | (1<<ALLOC);  // single bank
+        UEIENX  = (1<<RXSTPE);
+        usb___reset();
+    }
+
+    if (intbits & (1<<SOFI))
+        usb___start_of_frame();
+}
+
+/**                                     functions/ISR(USB_COM_vect)/description
+ * Handle SETUP packets on the control endpoint
+ */
+ISR(USB_COM_vect) {
+    UENUM = 0;
+    if (!(UEINTX & (1<<RXSTPI)))
+        return;
+
+    usb___setup_t setup;
+    uint8_t * p = (uint8_t *) &setup;
+    for (uint8_t i=0; i<sizeof(setup); i++)
+        p[i] = UEDATX;
+    UEINTX = ~((1<<RXSTPI)|(1<<RXOUTI)|(1<<TXINI));
+
+    if (usb___setup(&setup)) {
+        UENUM  = 0;
+        UECONX = (1<<STALLRQ)|(1<<EPEN);  // stall
+    }
+}
+
@@ -0,0 +1,250 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the "general" section of '.../firmware/lib/usb.h', and the
+ * standard (chapter 9) requests on the control endpoint
+ *
+ * Notes:
+ * - Endpoints are configured from the endpoint descriptors in the
+ *   configuration descriptor, so the descriptors are the only place endpoint
+ *   numbers, types, and sizes are listed.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "../../usb.h"
+#include "./definitions.h"
+#include "./device.h"
+#include "./hal.h"
+
+// ----------------------------------------------------------------------------
+
+/**                                                   macros/_BANKS/description
+ * The number of hardware buffers to give each (non-control) endpoint
+ *
+ * Notes:
+ * - With 2, `usb__kb__send_report()` can queue a report while the previous one
+ *   is still waiting to be picked up by the host, which means that sending a
+ *   report will almost never have to wait.
+ */
+#define  _BANKS  2
+
+// ----------------------------------------------------------------------------
+
+/**                                        variables/_configuration/description
+ * The current configuration (`bConfigurationValue`); `0` if not configured
+ */
+static volatile uint8_t _configuration;
+
+/**                                         variables/(group) power/description
+ * Bus power state
+ *
+ * Members:
+ * - `_suspended`: Whether the bus is currently suspended
+ * - `_remote_wakeup`: Whether the host has enabled remote wakeup (the
+ *   DEVICE_REMOTE_WAKEUP feature)
+ */
+static volatile bool _suspended;
+static volatile bool _remote_wakeup;
+
+// ----------------------------------------------------------------------------
+
+/**                                  functions/_configure_endpoints/description
+ * Configure every endpoint listed in the configuration descriptor
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other]
+ */
+static uint8_t _configure_endpoints(void) {
+    const uint8_t * address;
+    uint8_t length;
+
+    if ( usb___descriptor( USB__DESCRIPTOR__CONFIGURATION<<8, 0,
+                           &address, &length ) )
+        return 1;
+
+    const uint8_t * end = address + length;
+    while (address < end) {
+        uint8_t d_length = pgm_read_byte(address+0);
+        uint8_t d_type   = pgm_read_byte(address+1);
+
+        if (d_length == 0)
+            return 1;  // malformed descriptor
+
+        if (d_type == USB__DESCRIPTOR__ENDPOINT) {
+            if ( usb__hal__ep__configure( pgm_read_byte(address+2),
+                                          pgm_read_byte(address+3),
+                                          pgm_read_byte(address+4),
+                                          _BANKS ) )
+                return 1;
+        }
+
+        address += d_length;
+    }
+
+    return 0;
+}
+
+/**                                             functions/_standard/description
+ * Handle a standard request
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (request not supported)
+ */
+static uint8_t _standard(usb___setup_t * s) {
+    uint8_t recipient = s->bmRequestType & USB__REQUEST__RECIPIENT_MASK;
+    bool    in        = s->bmRequestType & USB__REQUEST__DIRECTION_IN;
+    uint8_t data[2]   = {0, 0};
+
+    switch (s->bRequest) {
+
+        case USB__GET_DESCRIPTOR: {
+            const uint8_t * address;
+            uint8_t length;
+            if ( !in || usb___descriptor( s->wValue, s->wIndex,
+                                          &address, &length ) )
+                return 1;
+            if (length > s->wLength)
+                length = s->wLength;
+            usb__hal__control__send(address, length, s->wLength, true);
+            return 0;
+        }
+
+        case USB__SET_ADDRESS:
+            if (recipient != USB__REQUEST__TO_DEVICE)
+                return 1;
+            usb__hal__control__status();
+            usb__hal__set_address(s->wValue & 0x7F);
+            return 0;
+
+        case USB__GET_CONFIGURATION:
+            if (!in || recipient != USB__REQUEST__TO_DEVICE)
+                return 1;
+            data[0] = _configuration;
+            usb__hal__control__send(data, 1, s->wLength, false);
+            return 0;
+
+        case USB__SET_CONFIGURATION:
+            if (recipient != USB__REQUEST__TO_DEVICE || s->wValue > 1)
+                return 1;
+            _configuration = 0;
+            if ( s->wValue && _configure_endpoints() )
+                return 1;
+            _configuration = s->wValue;
+            usb__hal__control__status();
+            return 0;
+
+        case USB__GET_STATUS:
+            if (!in)
+                return 1;
+            if (recipient == USB__REQUEST__TO_DEVICE)
+                data[0] = (1<<0)                       // self powered
+                        | ((_remote_wakeup) ? (1<<1) : 0);
+            else if (recipient == USB__REQUEST__TO_ENDPOINT)
+                data[0] = usb__hal__ep__is_halted(s->wIndex & 0x0F);
+            else if (recipient != USB__REQUEST__TO_INTERFACE)
+                return 1;
+            usb__hal__control__send(data, 2, s->wLength, false);
+            return 0;
+
+        case USB__CLEAR_FEATURE:
+        case USB__SET_FEATURE:
+            if ( recipient == USB__REQUEST__TO_DEVICE &&
+                 s->wValue == USB__FEATURE__DEVICE_REMOTE_WAKEUP ) {
+                _remote_wakeup = (s->bRequest == USB__SET_FEATURE);
+                usb__hal__control__status();
+                return 0;
+            }
+            if ( recipient != USB__REQUEST__TO_ENDPOINT ||
+                 s->wValue != USB__FEATURE__ENDPOINT_HALT ||
+                 (s->wIndex & 0x0F) == 0 )
+                return 1;
+            usb__hal__control__status();
+            usb__hal__ep__set_halt( s->wIndex & 0x0F,
+                                    s->bRequest == USB__SET_FEATURE );
+            return 0;
+
+        case USB__GET_INTERFACE:
+            // we have no alternate settings
+            if (!in || recipient != USB__REQUEST__TO_INTERFACE)
+                return 1;
+            usb__hal__control__send(data, 1, s->wLength, false);
+            return 0;
+
+        case USB__SET_INTERFACE:
+            if (recipient != USB__REQUEST__TO_INTERFACE || s->wValue != 0)
+                return 1;
+            usb__hal__control__status();
+            return 0;
+    }
+
+    return 1;
+}
+
+// ----------------------------------------------------------------------------
+
+void usb__init(void) {
+    _configuration = 0;
+    usb__hal__init();
+}
+
+bool usb__is_configured(void) {
+    return _configuration;
+}
+
+bool usb__is_suspended(void) {
+    return _suspended;
+}
+
+uint8_t usb__wakeup(void) {
+    if (!_suspended || !_remote_wakeup)
+        return 1;
+    usb__hal__remote_wakeup();
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void usb___reset(void) {
+    _configuration = 0;
+    _suspended     = false;
+    _remote_wakeup = false;
+    usb___kb__reset();
+}
+
+void usb___suspend(void) {
+    _suspended = true;
+}
+
+void usb___resume(void) {
+    _suspended = false;
+}
+
+void usb___start_of_frame(void) {
+    if (_configuration)
+        usb___kb__start_of_frame();
+}
+
+uint8_t usb___setup(usb___setup_t * s) {
+    switch (s->bmRequestType & USB__REQUEST__TYPE_MASK) {
+        case USB__REQUEST__TYPE_STANDARD:
+            return _standard(s);
+        case USB__REQUEST__TYPE_CLASS:
+            if ( (s->bmRequestType & USB__REQUEST__RECIPIENT_MASK)
+                    == USB__REQUEST__TO_INTERFACE
+                 && s->wIndex == USB___KB__INTERFACE )
+                return usb___kb__setup(s);
+            return 1;
+    }
+
+    return 1;
+}
+
@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2012, 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * USB 2.0 and HID 1.11 constants
+ *
+ * Prefix: `USB__`
+ *
+ * See "./notes from usb 2.0 spec sec 9 (usb device framework).h" and "./notes
+ * from hid device class definition 1.11.md" for where most of these come
+ * from, and what they mean.
+ *
+ * The following document versions were used, unless otherwise noted:
+ * - USB Specification: revision 2.0
+ * - HID Usage Tables: version 1.12
+ * - Device Class Definition for Human Interface Devices (HID): version 1.11
+ */
+
+
+#ifndef ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__COMMON__DEFINITIONS__H
+#define ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__COMMON__DEFINITIONS__H
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+
+// - spec sec 9.3 (USB Device Requests): `bmRequestType`
+//   - the values we actually compare against (direction | type | recipient)
+#define  USB__REQUEST__DIRECTION_IN     0x80
+#define  USB__REQUEST__TYPE_MASK        0x60
+#define  USB__REQUEST__TYPE_STANDARD    0x00
+#define  USB__REQUEST__TYPE_CLASS       0x20
+#define  USB__REQUEST__RECIPIENT_MASK   0x1F
+#define  USB__REQUEST__TO_DEVICE        0x00
+#define  USB__REQUEST__TO_INTERFACE     0x01
+#define  USB__REQUEST__TO_ENDPOINT      0x02
+
+// - spec table 9-4 (Standard Request Codes)
+#define  USB__GET_STATUS          0
+#define  USB__CLEAR_FEATURE       1
+// (reserved for future use):     2
+#define  USB__SET_FEATURE         3
+// (reserved for future use):     4
+#define  USB__SET_ADDRESS         5
+#define  USB__GET_DESCRIPTOR      6
+#define  USB__SET_DESCRIPTOR      7
+#define  USB__GET_CONFIGURATION   8
+#define  USB__SET_CONFIGURATION   9
+#define  USB__GET_INTERFACE      10
+#define  USB__SET_INTERFACE      11
+#define  USB__SYNCH_FRAME        12
+
+// - spec table 9-5 (Descriptor Types)
+#define  USB__DESCRIPTOR__DEVICE                     1
+#define  USB__DESCRIPTOR__CONFIGURATION              2
+#define  USB__DESCRIPTOR__STRING                     3
+#define  USB__DESCRIPTOR__INTERFACE                  4
+#define  USB__DESCRIPTOR__ENDPOINT                   5
+#define  USB__DESCRIPTOR__DEVICE_QUALIFIER           6
+#define  USB__DESCRIPTOR__OTHER_SPEED_CONFIGURATION  7
+#define  USB__DESCRIPTOR__INTERFACE_POWER            8
+
+// - spec table 9-6 (Standard Feature Selectors)
+#define  USB__FEATURE__ENDPOINT_HALT         0  // recipient: endpoint
+#define  USB__FEATURE__DEVICE_REMOTE_WAKEUP  1  // recipient: device
+#define  USB__FEATURE__TEST_MODE             2  // recipient: device
+
+// - spec table 9-13 (Standard Endpoint Descriptor): `bmAttributes`
+#define  USB__ENDPOINT__CONTROL      0x00
+#define  USB__ENDPOINT__ISOCHRONOUS  0x01
+#define  USB__ENDPOINT__BULK         0x02
+#define  USB__ENDPOINT__INTERRUPT    0x03
+#define  USB__ENDPOINT__IN           0x80  // (in `bEndpointAddress`)
+
+// - hid sec 7.1 (Standard Requests) and 7.2 (Class-Specific Requests)
+#define  USB__HID__GET_REPORT    0x01
+#define  USB__HID__GET_IDLE      0x02
+#define  USB__HID__GET_PROTOCOL  0x03
+#define  USB__HID__SET_REPORT    0x09
+#define  USB__HID__SET_IDLE      0x0A
+#define  USB__HID__SET_PROTOCOL  0x0B
+
+// - hid sec 7.1 (Standard Requests): class descriptor types
+#define  USB__DESCRIPTOR__HID         0x21
+#define  USB__DESCRIPTOR__HID_REPORT  0x22
+
+// ----------------------------------------------------------------------------
+
+/**                                                 macros/USB__LSB/description
+ * The least significant byte of a 16-bit value (for building descriptors)
+ */
+#define  USB__LSB(n)  ( (n) & 0xFF )
+
+/**                                                 macros/USB__MSB/description
+ * The most significant byte of a 16-bit value (for building descriptors)
+ */
+#define  USB__MSB(n)  ( ((n) >> 8) & 0xFF )
+
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+#endif  // ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__COMMON__DEFINITIONS__H
+
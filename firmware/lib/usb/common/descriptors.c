@@ -0,0 +1,274 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2012, 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * The USB descriptors for this device, and the table used to look them up
+ *
+ * Everything here lives in PROGMEM.  Adding a descriptor (e.g. another string,
+ * or another interface's HID report descriptor) should only require adding
+ * the data and a row to `_table`.
+ *
+ * Notes:
+ * - The descriptors (and the keyboard report descriptor in particular) started
+ *   out as the ones in the PJRC "USB Keyboard" example
+ *   <http://www.pjrc.com/teensy/usb_keyboard.html>
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "./definitions.h"
+#include "./device.h"
+
+// ----------------------------------------------------------------------------
+
+#ifndef OPT__USB__STR_MANUFACTURER
+    #error "OPT__USB__STR_MANUFACTURER not defined"
+#endif
+#ifndef OPT__USB__STR_PRODUCT
+    #error "OPT__USB__STR_PRODUCT not defined"
+#endif
+#ifndef OPT__USB__VENDOR_ID
+    #error "OPT__USB__VENDOR_ID not defined"
+#endif
+#ifndef OPT__USB__PRODUCT_ID
+    #error "OPT__USB__PRODUCT_ID not defined"
+#endif
+#ifndef OPT__USB__POLLING_INTERVAL
+    #error "OPT__USB__POLLING_INTERVAL not defined"
+#endif
+#if OPT__USB__POLLING_INTERVAL < 1 || OPT__USB__POLLING_INTERVAL > 255
+    #error "OPT__USB__POLLING_INTERVAL must be between 1 and 255 inclusive"
+#endif
+
+/**                                              macros/(group) USB/description
+ * USB identifier information
+ *
+ * Members:
+ * - `OPT__USB__STR_MANUFACTURER`
+ * - `OPT__USB__STR_PRODUCT`
+ * - `OPT__USB__VENDOR_ID`
+ * - `OPT__USB__PRODUCT_ID`
+ */
+
+/**                               macros/OPT__USB__POLLING_INTERVAL/description
+ * The interval (in milliseconds) at which the host should poll the keyboard
+ * endpoint for new reports
+ *
+ * Notes:
+ * - This is the `bInterval` field of the keyboard endpoint descriptor.  For a
+ *   full speed interrupt endpoint it is measured in frames (1 ms each), and may
+ *   be anything from 1 to 255.  `1` is the fastest polling rate a full speed
+ *   device can ask for.
+ * - The host treats this as an upper bound; it may poll more often, and some
+ *   hosts round it down to a power of 2.
+ * - We send one report per scan (see `main()`), so the effective report rate
+ *   is 1000 / max(`OPT__DEBOUNCE_TIME`, `OPT__USB__POLLING_INTERVAL`) reports
+ *   per second.  Polling faster than we scan costs nothing (the host just gets
+ *   NAKs on the empty frames); scanning faster than we're polled fills both
+ *   endpoint banks and makes `usb__kb__send_report()` wait.
+ * - `make usb-benchmark` (see "../test/benchmark.c") measures the effective
+ *   report rate, and the latency from scan to host, against a simulated host
+ *   polling at this interval (or any other).
+ */
+
+// ----------------------------------------------------------------------------
+
+/**                                       macros/_STRING_DESCRIPTOR/description
+ * Declare a string descriptor named `name`, containing the (wide) string
+ * literal `string`
+ *
+ * Notes:
+ * - `sizeof` a wide string literal includes the terminating null, which takes
+ *   up exactly as much room as the 2 byte header the descriptor needs, so
+ *   `sizeof(string)` is the total length of the descriptor.
+ */
+#define  _STRING_DESCRIPTOR(name, string)                                   \
+    static const struct {                                                   \
+        uint8_t bLength;                                                    \
+        uint8_t bDescriptorType;                                            \
+        wchar_t bString[sizeof(string)/sizeof(wchar_t)-1];                  \
+    } PROGMEM name = {                                                      \
+        .bLength         = sizeof(string),                                  \
+        .bDescriptorType = USB__DESCRIPTOR__STRING,                         \
+        .bString         = string,                                          \
+    }
+
+// ----------------------------------------------------------------------------
+
+// - spec sec 9.6.1 (Device), table 9-8
+static const uint8_t PROGMEM _device[] = {
+    18,                                 // bLength
+    USB__DESCRIPTOR__DEVICE,            // bDescriptorType
+    0x00, 0x02,                         // bcdUSB (2.00)
+    0,                                  // bDeviceClass (per interface)
+    0,                                  // bDeviceSubClass
+    0,                                  // bDeviceProtocol
+    USB___CONTROL_SIZE,                 // bMaxPacketSize0
+    USB__LSB(OPT__USB__VENDOR_ID),      // idVendor
+    USB__MSB(OPT__USB__VENDOR_ID),
+    USB__LSB(OPT__USB__PRODUCT_ID),     // idProduct
+    USB__MSB(OPT__USB__PRODUCT_ID),
+    0x00, 0x01,                         // bcdDevice (1.00)
+    1,                                  // iManufacturer
+    2,                                  // iProduct
+    0,                                  // iSerialNumber
+    1,                                  // bNumConfigurations
+};
+
+// - hid appendix B.1 (Protocol 1 (Keyboard))
+static const uint8_t PROGMEM _kb_report[] = {
+    0x05, 0x01,  // Usage Page (Generic Desktop)
+    0x09, 0x06,  // Usage (Keyboard)
+    0xA1, 0x01,  // Collection (Application)
+    0x75, 0x01,  //   Report Size (1)
+    0x95, 0x08,  //   Report Count (8)
+    0x05, 0x07,  //   Usage Page (Key Codes)
+    0x19, 0xE0,  //   Usage Minimum (224)
+    0x29, 0xE7,  //   Usage Maximum (231)
+    0x15, 0x00,  //   Logical Minimum (0)
+    0x25, 0x01,  //   Logical Maximum (1)
+    0x81, 0x02,  //   Input (Data, Variable, Absolute) ; modifier byte
+    0x95, 0x01,  //   Report Count (1)
+    0x75, 0x08,  //   Report Size (8)
+    0x81, 0x03,  //   Input (Constant)                 ; reserved byte
+    0x95, 0x05,  //   Report Count (5)
+    0x75, 0x01,  //   Report Size (1)
+    0x05, 0x08,  //   Usage Page (LEDs)
+    0x19, 0x01,  //   Usage Minimum (1)
+    0x29, 0x05,  //   Usage Maximum (5)
+    0x91, 0x02,  //   Output (Data, Variable, Absolute) ; LED report
+    0x95, 0x01,  //   Report Count (1)
+    0x75, 0x03,  //   Report Size (3)
+    0x91, 0x03,  //   Output (Constant)                 ; LED report padding
+    0x95, 0x06,  //   Report Count (6)
+    0x75, 0x08,  //   Report Size (8)
+    0x15, 0x00,  //   Logical Minimum (0)
+    0x25, 0x68,  //   Logical Maximum (104)
+    0x05, 0x07,  //   Usage Page (Key Codes)
+    0x19, 0x00,  //   Usage Minimum (0)
+    0x29, 0x68,  //   Usage Maximum (104)
+    0x81, 0x00,  //   Input (Data, Array)
+    0xC0,        // End Collection
+};
+
+#define  _CONFIGURATION__LENGTH  (9+9+9+7)
+#define  _CONFIGURATION__KB_HID  (9+9)  // offset of the keyboard HID desc.
+
+static const uint8_t PROGMEM _configuration[_CONFIGURATION__LENGTH] = {
+    // - spec sec 9.6.3 (Configuration), table 9-10
+    9,                                  // bLength
+    USB__DESCRIPTOR__CONFIGURATION,     // bDescriptorType
+    USB__LSB(_CONFIGURATION__LENGTH),   // wTotalLength
+    USB__MSB(_CONFIGURATION__LENGTH),
+    1,                                  // bNumInterfaces
+    1,                                  // bConfigurationValue
+    0,                                  // iConfiguration
+    0xE0,                               // bmAttributes (self powered,
+                                        //   remote wakeup)
+    50,                                 // bMaxPower (in 2 mA units)
+
+    // - spec sec 9.6.5 (Interface), table 9-12
+    9,                                  // bLength
+    USB__DESCRIPTOR__INTERFACE,         // bDescriptorType
+    USB___KB__INTERFACE,                // bInterfaceNumber
+    0,                                  // bAlternateSetting
+    1,                                  // bNumEndpoints
+    0x03,                               // bInterfaceClass (HID)
+    0x01,                               // bInterfaceSubClass (boot)
+    0x01,                               // bInterfaceProtocol (keyboard)
+    0,                                  // iInterface
+
+    // - hid sec 6.2.1 (HID Descriptor)
+    9,                                  // bLength
+    USB__DESCRIPTOR__HID,               // bDescriptorType
+    0x11, 0x01,                         // bcdHID (1.11)
+    0,                                  // bCountryCode
+    1,                                  // bNumDescriptors
+    USB__DESCRIPTOR__HID_REPORT,        // bDescriptorType
+    USB__LSB(sizeof(_kb_report)),       // wDescriptorLength
+    USB__MSB(sizeof(_kb_report)),
+
+    // - spec sec 9.6.6 (Endpoint), table 9-13
+    7,                                  // bLength
+    USB__DESCRIPTOR__ENDPOINT,          // bDescriptorType
+    USB___KB__ENDPOINT | USB__ENDPOINT__IN,  // bEndpointAddress
+    USB__ENDPOINT__INTERRUPT,           // bmAttributes
+    USB___KB__REPORT_SIZE, 0,           // wMaxPacketSize
+    OPT__USB__POLLING_INTERVAL,         // bInterval
+};
+
+// - spec sec 9.6.7 (String), tables 9-15 and 9-16
+static const uint8_t PROGMEM _string_0[] = {
+    4,                                  // bLength
+    USB__DESCRIPTOR__STRING,            // bDescriptorType
+    USB__LSB(0x0409),                   // wLANGID[0] (English (US))
+    USB__MSB(0x0409),
+};
+_STRING_DESCRIPTOR( _string_1, OPT__USB__STR_MANUFACTURER );
+_STRING_DESCRIPTOR( _string_2, OPT__USB__STR_PRODUCT      );
+
+// ----------------------------------------------------------------------------
+
+/**                                                  types/_entry_t/description
+ * A row of the descriptor table
+ *
+ * Struct members:
+ * - `value`: The `wValue` a GET_DESCRIPTOR request must have to match
+ * - `index`: The `wIndex` a GET_DESCRIPTOR request must have to match
+ * - `address`: The (PROGMEM) address of the descriptor
+ * - `length`: The length of the descriptor
+ */
+typedef struct {
+    uint16_t        value;
+    uint16_t        index;
+    const uint8_t * address;
+    uint8_t         length;
+} _entry_t;
+
+#define  _ENTRY(type, number, index, descriptor, length)                    \
+    { ((type)<<8)|(number), (index), (const uint8_t *)(descriptor), (length) }
+
+static const _entry_t PROGMEM _table[] = {
+    _ENTRY( USB__DESCRIPTOR__DEVICE,        0, 0,
+            _device, sizeof(_device) ),
+    _ENTRY( USB__DESCRIPTOR__CONFIGURATION, 0, 0,
+            _configuration, sizeof(_configuration) ),
+    _ENTRY( USB__DESCRIPTOR__HID_REPORT,    0, USB___KB__INTERFACE,
+            _kb_report, sizeof(_kb_report) ),
+    _ENTRY( USB__DESCRIPTOR__HID,           0, USB___KB__INTERFACE,
+            _configuration+_CONFIGURATION__KB_HID, 9 ),
+    _ENTRY( USB__DESCRIPTOR__STRING,        0, 0,
+            _string_0, sizeof(_string_0) ),
+    _ENTRY( USB__DESCRIPTOR__STRING,        1, 0x0409,
+            &_string_1, sizeof(_string_1) ),
+    _ENTRY( USB__DESCRIPTOR__STRING,        2, 0x0409,
+            &_string_2, sizeof(_string_2) ),
+};
+
+#define  _TABLE__LENGTH  (sizeof(_table)/sizeof(_entry_t))
+
+// ----------------------------------------------------------------------------
+
+uint8_t usb___descriptor( uint16_t         value,
+                          uint16_t         index,
+                          const uint8_t ** address,
+                          uint8_t *        length ) {
+
+    for (uint8_t i=0; i<_TABLE__LENGTH; i++) {
+        if ( pgm_read_word(&_table[i].value) != value ||
+             pgm_read_word(&_table[i].index) != index )
+            continue;
+
+        *address = (const uint8_t *) pgm_read_word(&_table[i].address);
+        *length  = pgm_read_byte(&_table[i].length);
+        return 0;
+    }
+
+    return 1;  // not found
+}
+
@@ -0,0 +1,216 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * The device independent part of the USB implementation: private things
+ * shared between the files in this directory, and the event handlers the HAL
+ * (see "./hal.h") calls into
+ *
+ * Prefix: `usb___`
+ *
+ * Meant to be included only by the files implementing '.../firmware/lib/usb.h'
+ * (this directory, and the HAL implementations).
+ */
+
+
+#ifndef ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__COMMON__DEVICE__H
+#define ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__COMMON__DEVICE__H
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ----------------------------------------------------------------------------
+
+#define  USB___CONTROL_SIZE      32
+#define  USB___KB__INTERFACE      0
+#define  USB___KB__ENDPOINT       1
+#define  USB___KB__REPORT_SIZE    8
+
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    uint8_t  bmRequestType;
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} usb___setup_t;
+
+// ----------------------------------------------------------------------------
+
+// --- events (called by the HAL) ---
+
+void    usb___reset          (void);
+void    usb___suspend        (void);
+void    usb___resume         (void);
+void    usb___start_of_frame (void);
+uint8_t usb___setup          (usb___setup_t * setup);
+
+// --- descriptors ---
+
+uint8_t usb___descriptor ( uint16_t        value,
+                           uint16_t        index,
+                           const uint8_t ** address,
+                           uint8_t *       length );
+
+// --- keyboard ---
+
+void    usb___kb__reset          (void);
+void    usb___kb__start_of_frame (void);
+uint8_t usb___kb__setup          (usb___setup_t * setup);
+
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+#endif  // ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__COMMON__DEVICE__H
+
+
+
+// ============================================================================
+// === documentation ==========================================================
+// ============================================================================
+
+
+// ----------------------------------------------------------------------------
+// macros ---------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// === USB___CONTROL_SIZE ===
+/**                                       macros/USB___CONTROL_SIZE/description
+ * The maximum packet size of the control endpoint (endpoint 0)
+ *
+ * Notes:
+ * - Must be one of 8, 16, 32, or 64 (for full speed devices)
+ */
+
+// === (group) keyboard ===
+/**                                         macros/(group) keyboard/description
+ * The configuration of the keyboard interface
+ *
+ * Members:
+ * - `USB___KB__INTERFACE`: The `bInterfaceNumber` of the keyboard interface
+ * - `USB___KB__ENDPOINT`: The number of the keyboard's interrupt IN endpoint
+ * - `USB___KB__REPORT_SIZE`: The size of a keyboard report (and of the
+ *   keyboard endpoint), in bytes
+ */
+
+
+// ----------------------------------------------------------------------------
+// types ----------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// === usb___setup_t ===
+/**                                             types/usb___setup_t/description
+ * The 8 bytes of a SETUP packet (spec sec 9.3, table 9-2)
+ *
+ * Notes:
+ * - USB is little endian, as is avr-gcc, so the HAL may fill this in byte by
+ *   byte in the order the bytes are received.
+ */
+
+
+// ----------------------------------------------------------------------------
+// functions ------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// --- events -----------------------------------------------------------------
+
+// === usb___reset() ===
+/**                                           functions/usb___reset/description
+ * Handle a bus reset
+ *
+ * Called by the HAL (after it has reconfigured the control endpoint) when the
+ * host resets the bus.  The device is unconfigured afterwards.
+ */
+
+// === usb___suspend() ===
+/**                                         functions/usb___suspend/description
+ * Handle the bus being suspended (no activity for 3 ms)
+ *
+ * Called by the HAL, from interrupt context, after it has put the USB
+ * hardware into its low power state.
+ */
+
+// === usb___resume() ===
+/**                                          functions/usb___resume/description
+ * Handle the bus being resumed (by the host, or after a remote wakeup)
+ *
+ * Called by the HAL, from interrupt context, after it has brought the USB
+ * hardware back up.
+ */
+
+// === usb___start_of_frame() ===
+/**                                  functions/usb___start_of_frame/description
+ * Handle a Start Of Frame packet (once per millisecond, on a full speed bus)
+ *
+ * Called by the HAL, from interrupt context.
+ */
+
+// === usb___setup() ===
+/**                                           functions/usb___setup/description
+ * Handle a SETUP packet received on the control endpoint
+ *
+ * Arguments:
+ * - `setup`: The contents of the packet
+ *
+ * Returns:
+ * - success: `0` (request handled, including the data and status stages)
+ * - failure: [other] (request not supported; the HAL should stall the control
+ *   endpoint)
+ *
+ * Notes:
+ * - Called by the HAL, from interrupt context, after the SETUP packet has been
+ *   read and acknowledged.
+ */
+
+
+// --- descriptors ------------------------------------------------------------
+
+// === usb___descriptor() ===
+/**                                      functions/usb___descriptor/description
+ * Look up a descriptor in the descriptor table
+ *
+ * Arguments:
+ * - `value`: The `wValue` of the GET_DESCRIPTOR request (descriptor type in
+ *   the high byte, descriptor index in the low byte)
+ * - `index`: The `wIndex` of the GET_DESCRIPTOR request (language ID, or
+ *   interface number)
+ * - `address`: A pointer to the location to store the (PROGMEM) address of the
+ *   descriptor
+ * - `length`: A pointer to the location to store the length of the descriptor
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (no such descriptor)
+ */
+
+
+// --- keyboard ---------------------------------------------------------------
+
+// === usb___kb__reset() ===
+/**                                       functions/usb___kb__reset/description
+ * Return the keyboard interface to its power on state (on bus reset)
+ */
+
+// === usb___kb__start_of_frame() ===
+/**                              functions/usb___kb__start_of_frame/description
+ * Send the keyboard report if the HID idle rate says it's time to
+ *
+ * Called by `usb___start_of_frame()`, only when the device is configured.
+ */
+
+// === usb___kb__setup() ===
+/**                                       functions/usb___kb__setup/description
+ * Handle a class (HID) request addressed to the keyboard interface
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (request not supported)
+ */
+
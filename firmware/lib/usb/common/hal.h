@@ -0,0 +1,222 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * The USB hardware abstraction layer interface
+ *
+ * Prefix: `usb__hal__`
+ *
+ * This is the boundary between the device independent part of the USB
+ * implementation (in this directory) and the part that talks to the hardware
+ * (e.g. "../atmega32u4/hal.c").  Implementations must implement all prototyped
+ * functions, and must call the `usb___` event handlers declared in
+ * "./device.h" when the corresponding events occur.  Nothing else in the
+ * device independent code touches the hardware, so a host side fake that
+ * implements this interface (and feeds in SETUP packets, frames, and suspend
+ * and resume events) is enough to exercise the rest of the stack.  See
+ * "../test/fake.h".
+ *
+ * Endpoints are referred to by number (`0`..`15`, without the direction bit),
+ * except in `usb__hal__ep__configure()`, which takes the values straight out
+ * of an endpoint descriptor.
+ */
+
+
+#ifndef ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__COMMON__HAL__H
+#define ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__COMMON__HAL__H
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ----------------------------------------------------------------------------
+
+// device
+void     usb__hal__init          (void);
+void     usb__hal__set_address   (uint8_t address);
+uint16_t usb__hal__frame_number  (void);
+void     usb__hal__remote_wakeup (void);
+
+// endpoints
+uint8_t  usb__hal__ep__configure ( uint8_t address,
+                                   uint8_t attributes,
+                                   uint8_t size,
+                                   uint8_t banks );
+void     usb__hal__ep__set_halt  (uint8_t endpoint, bool halt);
+bool     usb__hal__ep__is_halted (uint8_t endpoint);
+uint8_t  usb__hal__ep__send      ( uint8_t         endpoint,
+                                   const uint8_t * data,
+                                   uint8_t         length );
+
+// control endpoint
+void     usb__hal__control__send    ( const uint8_t * data,
+                                      uint8_t         length,
+                                      uint16_t        requested,
+                                      bool            progmem );
+uint8_t  usb__hal__control__receive (uint8_t * data, uint8_t length);
+void     usb__hal__control__status  (void);
+
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+#endif  // ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__COMMON__HAL__H
+
+
+
+// ============================================================================
+// === documentation ==========================================================
+// ============================================================================
+
+
+// ----------------------------------------------------------------------------
+// functions ------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// device ---------------------------------------------------------------------
+
+// === usb__hal__init() ===
+/**                                        functions/usb__hal__init/description
+ * Power up the USB hardware, attach to the bus, and enable the interrupts
+ * needed to generate events
+ *
+ * Notes:
+ * - Must enable interrupts globally before returning.
+ * - The control endpoint is configured when the first bus reset is seen, not
+ *   here.
+ */
+
+// === usb__hal__set_address() ===
+/**                                 functions/usb__hal__set_address/description
+ * Set the device address
+ *
+ * Arguments:
+ * - `address`: The address assigned by the host
+ *
+ * Notes:
+ * - Called after `usb__hal__control__status()` for a SET_ADDRESS request.  The
+ *   new address must not take effect until the status stage has completed
+ *   (spec sec 9.4.6).
+ */
+
+// === usb__hal__frame_number() ===
+/**                                functions/usb__hal__frame_number/description
+ * Return the number of the most recent frame (11 bits, from the SOF packet)
+ */
+
+// === usb__hal__remote_wakeup() ===
+/**                               functions/usb__hal__remote_wakeup/description
+ * Bring the USB hardware out of its low power state and signal resume to the
+ * host
+ *
+ * Notes:
+ * - Only called while the bus is suspended, and only if the host has enabled
+ *   remote wakeup.
+ * - Must not block until the bus resumes; `usb___resume()` should be called
+ *   when it does, as for a host initiated resume.
+ * - Calling this again while resume signaling is in progress must be
+ *   harmless.
+ */
+
+// ----------------------------------------------------------------------------
+// endpoints ------------------------------------------------------------------
+
+// === usb__hal__ep__configure() ===
+/**                               functions/usb__hal__ep__configure/description
+ * Configure (and enable) an endpoint
+ *
+ * Arguments:
+ * - `address`: The `bEndpointAddress` of the endpoint (number, and direction
+ *   in bit 7)
+ * - `attributes`: The `bmAttributes` of the endpoint (transfer type in the low
+ *   2 bits)
+ * - `size`: The maximum packet size of the endpoint, in bytes
+ * - `banks`: The number of hardware buffers to give the endpoint (`1` or
+ *   `2`).  With two banks, one packet can be written while the other waits
+ *   for the host to pick it up.
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (the hardware can't provide the requested endpoint)
+ */
+
+// === usb__hal__ep__set_halt() ===
+/**                                functions/usb__hal__ep__set_halt/description
+ * Set or clear the halt (stall) condition of an endpoint
+ *
+ * Arguments:
+ * - `endpoint`: The endpoint number
+ * - `halt`: Whether to halt (`true`) or un-halt (`false`) the endpoint
+ *
+ * Notes:
+ * - Un-halting an endpoint must also reset its data toggle (spec sec 9.4.5).
+ */
+
+// === usb__hal__ep__is_halted() ===
+/**                               functions/usb__hal__ep__is_halted/description
+ * Return whether the given endpoint is halted
+ */
+
+// === usb__hal__ep__send() ===
+/**                                    functions/usb__hal__ep__send/description
+ * Queue one packet for sending on an IN endpoint, if there's room
+ *
+ * Arguments:
+ * - `endpoint`: The endpoint number
+ * - `data`: A pointer to the data (in SRAM) to send
+ * - `length`: The number of bytes to send
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (no free bank; try again later)
+ *
+ * Notes:
+ * - Must not block, and must be safe to call from both the main loop and
+ *   interrupt context.
+ */
+
+// ----------------------------------------------------------------------------
+// control endpoint -----------------------------------------------------------
+
+// === usb__hal__control__send() ===
+/**                               functions/usb__hal__control__send/description
+ * Perform the data stage of a control IN (device to host) transfer
+ *
+ * Arguments:
+ * - `data`: A pointer to the data to send
+ * - `length`: The number of bytes to send (already clipped to `requested`)
+ * - `requested`: The `wLength` of the request
+ * - `progmem`: Whether `data` points to PROGMEM (`true`) or SRAM (`false`)
+ *
+ * Notes:
+ * - If `length < requested` and the last packet is full, a zero length packet
+ *   must be sent to end the transfer (spec sec 5.5.3).
+ * - If the host aborts the transfer (by starting the status stage early), the
+ *   function should return quietly.
+ */
+
+// === usb__hal__control__receive() ===
+/**                            functions/usb__hal__control__receive/description
+ * Perform the data stage of a control OUT (host to device) transfer (which
+ * must fit in a single packet)
+ *
+ * Arguments:
+ * - `data`: A pointer to the location to store the data
+ * - `length`: The number of bytes to store
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other]
+ */
+
+// === usb__hal__control__status() ===
+/**                             functions/usb__hal__control__status/description
+ * Perform the status stage of a control transfer with no data stage, or with
+ * an OUT data stage (by sending a zero length IN packet)
+ */
+
@@ -0,0 +1,317 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2012, 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements the "keyboard" section of '.../firmware/lib/usb.h', and the HID
+ * class requests for the keyboard interface
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <util/atomic.h>
+#include "../../usb.h"
+#include "../usage-page/keyboard.h"
+#include "./definitions.h"
+#include "./device.h"
+#include "./hal.h"
+
+// ----------------------------------------------------------------------------
+
+#ifndef OPT__USB__REPORT_QUEUE_SIZE
+    #error "OPT__USB__REPORT_QUEUE_SIZE not defined"
+#endif
+#if OPT__USB__REPORT_QUEUE_SIZE < 1 || OPT__USB__REPORT_QUEUE_SIZE > 255
+    #error "OPT__USB__REPORT_QUEUE_SIZE must be between 1 and 255 inclusive"
+#endif
+
+/**                              macros/OPT__USB__REPORT_QUEUE_SIZE/description
+ * The number of keyboard reports that can be waiting in the report queue
+ *
+ * Notes:
+ * - Each entry takes `USB___KB__REPORT_SIZE` (8) bytes of SRAM.
+ * - The queue is drained at one report per frame, so anything that fills it
+ *   once per scan can send up to about `OPT__DEBOUNCE_TIME` reports per scan
+ *   without ever falling behind.  Making it larger than that only helps
+ *   absorb bursts.
+ */
+
+// ----------------------------------------------------------------------------
+
+/**                                                 macros/_TIMEOUT/description
+ * The number of frames (milliseconds) `usb__kb__send_report()` will wait for
+ * a free endpoint bank before giving up
+ */
+#define  _TIMEOUT  50
+
+// ----------------------------------------------------------------------------
+
+/**                                                 types/_report_t/description
+ * A boot protocol keyboard report (hid appendix B.1)
+ */
+typedef struct {
+    uint8_t modifiers;  // 1 bit per modifier, in keycode order (hid B.1)
+    uint8_t reserved;
+    uint8_t keys[6];
+} _report_t;
+
+// ----------------------------------------------------------------------------
+
+/**                                               variables/_report/description
+ * The current (device side) state of the keyboard
+ */
+static _report_t _report;
+
+/**                                                 variables/_leds/description
+ * The current state of the LEDs, as last set by the host
+ *
+ * Bits: 1=num lock, 2=caps lock, 4=scroll lock, 8=compose, 16=kana
+ */
+static volatile uint8_t _leds;
+
+/**                                           variables/(group) hid/description
+ * HID state the host can get and set
+ *
+ * Members:
+ * - `_protocol`: The current protocol (`0` = boot, `1` = report).  We use the
+ *   boot report in both cases, so this is only stored so we can report it
+ *   back.
+ * - `_idle_rate`: How often to resend the report when nothing has changed, in
+ *   4 ms units (`0` = never)
+ * - `_idle_count`: The number of 4 ms periods since the last report was sent
+ */
+static uint8_t          _protocol;
+static uint8_t          _idle_rate;
+static volatile uint8_t _idle_count;
+
+/**                                           variables/(group) queue/description
+ * The report queue (a ring buffer)
+ *
+ * Members:
+ * - `_queue`: The reports
+ * - `_queue_head`: The index of the next report to send
+ * - `_queue_length`: The number of reports waiting to be sent
+ *
+ * Notes:
+ * - Reports are only added by the main loop, and only removed by
+ *   `usb___kb__start_of_frame()` (in interrupt context), so the only thing
+ *   both sides modify is `_queue_length`.
+ */
+static _report_t        _queue[OPT__USB__REPORT_QUEUE_SIZE];
+static uint8_t          _queue_head;
+static volatile uint8_t _queue_length;
+
+// ----------------------------------------------------------------------------
+
+/**                                            functions/_queue__send/description
+ * Hand the report at the head of the queue to the hardware, if there is one
+ * and there's room
+ *
+ * Notes:
+ * - Only called from interrupt context.
+ */
+static void _queue__send(void) {
+    if ( !_queue_length || usb__hal__ep__send( USB___KB__ENDPOINT,
+                                               (const uint8_t *)
+                                                   &_queue[_queue_head],
+                                               sizeof(_report_t) ) )
+        return;
+
+    if (++_queue_head == OPT__USB__REPORT_QUEUE_SIZE)
+        _queue_head = 0;
+    _queue_length--;
+    _idle_count = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+uint8_t usb__kb__set_key(bool pressed, uint8_t keycode) {
+    // no-op
+    if (keycode == 0)
+        return 1;
+
+    // modifier keys
+    if (keycode >= KEYBOARD__LeftControl && keycode <= KEYBOARD__RightGUI) {
+        uint8_t bit = 1 << (keycode - KEYBOARD__LeftControl);
+        if (pressed) _report.modifiers |=  bit;
+        else         _report.modifiers &= ~bit;
+        return 0;
+    }
+
+    // all others
+    for (uint8_t i=0; i<6; i++) {
+        if (pressed) {
+            if (_report.keys[i] == 0) {
+                _report.keys[i] = keycode;
+                return 0;
+            }
+        } else {
+            if (_report.keys[i] == keycode) {
+                _report.keys[i] = 0;
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+bool usb__kb__read_key(uint8_t keycode) {
+    // no-op
+    if (keycode == 0)
+        return false;
+
+    // modifier keys
+    if (keycode >= KEYBOARD__LeftControl && keycode <= KEYBOARD__RightGUI)
+        return _report.modifiers & (1 << (keycode - KEYBOARD__LeftControl));
+
+    // all others
+    for (uint8_t i=0; i<6; i++)
+        if (_report.keys[i] == keycode)
+            return true;
+
+    return false;
+}
+
+uint8_t usb__kb__keys_free(void) {
+    uint8_t free = 0;
+    for (uint8_t i=0; i<6; i++)
+        if (_report.keys[i] == 0)
+            free++;
+
+    return free;
+}
+
+bool usb__kb__read_led(char led) {
+    switch(led) {
+        case 'N': return _leds & (1<<0);  // numlock
+        case 'C': return _leds & (1<<1);  // capslock
+        case 'S': return _leds & (1<<2);  // scroll lock
+        case 'O': return _leds & (1<<3);  // compose
+        case 'K': return _leds & (1<<4);  // kana
+    };
+    return false;
+}
+
+uint8_t usb__kb__send_report(void) {
+    // no frames are sent while the bus is suspended, so we'd wait forever
+    if (usb__is_suspended())
+        return 3;
+
+    uint16_t start = usb__hal__frame_number();
+
+    for (;;) {
+        // if nothing is queued, go straight to the hardware (only the
+        // interrupt removes things from the queue, so it can't go from empty
+        // to not empty behind our back)
+        if (!_queue_length) {
+            if ( !usb__hal__ep__send( USB___KB__ENDPOINT,
+                                      (const uint8_t *) &_report,
+                                      sizeof(_report) ) ) {
+                _idle_count = 0;
+                return 0;
+            }
+        } else if (!usb__kb__queue_report()) {
+            return 0;
+        }
+
+        if (!usb__is_configured() || usb__is_suspended())
+            return 1;
+        if ( ((usb__hal__frame_number() - start) & 0x7FF) >= _TIMEOUT )
+            return 2;
+    }
+}
+
+uint8_t usb__kb__queue_report(void) {
+    uint16_t tail;  // (head + length may not fit in 8 bits)
+
+    if (usb__kb__queue_full())
+        return 1;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        tail = _queue_head + _queue_length;
+    }
+    if (tail >= OPT__USB__REPORT_QUEUE_SIZE)
+        tail -= OPT__USB__REPORT_QUEUE_SIZE;
+
+    _queue[tail] = _report;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _queue_length++;
+    }
+
+    return 0;
+}
+
+bool usb__kb__queue_full(void) {
+    return _queue_length >= OPT__USB__REPORT_QUEUE_SIZE;
+}
+
+// ----------------------------------------------------------------------------
+
+void usb___kb__reset(void) {
+    _protocol     = 1;
+    _idle_rate    = 125;  // 500 ms (the recommended default; hid sec 7.2.4)
+    _idle_count   = 0;
+    _queue_head   = 0;
+    _queue_length = 0;
+}
+
+void usb___kb__start_of_frame(void) {
+    static uint8_t divider;
+
+    _queue__send();
+
+    if ( !_idle_rate || (++divider & 3) || _queue_length )
+        return;
+
+    if (++_idle_count >= _idle_rate) {
+        // if there's no room, try again in 4 ms
+        if ( !usb__hal__ep__send( USB___KB__ENDPOINT,
+                                  (const uint8_t *) &_report,
+                                  sizeof(_report) ) )
+            _idle_count = 0;
+    }
+}
+
+uint8_t usb___kb__setup(usb___setup_t * s) {
+    if (s->bmRequestType & USB__REQUEST__DIRECTION_IN) {
+        switch (s->bRequest) {
+            case USB__HID__GET_REPORT:
+                usb__hal__control__send( (const uint8_t *) &_report,
+                                         sizeof(_report), s->wLength, false );
+                return 0;
+            case USB__HID__GET_IDLE:
+                usb__hal__control__send(&_idle_rate, 1, s->wLength, false);
+                return 0;
+            case USB__HID__GET_PROTOCOL:
+                usb__hal__control__send(&_protocol, 1, s->wLength, false);
+                return 0;
+        }
+    } else {
+        switch (s->bRequest) {
+            case USB__HID__SET_REPORT: {
+                uint8_t leds;
+                if (usb__hal__control__receive(&leds, 1))
+                    return 1;
+                _leds = leds;
+                usb__hal__control__status();
+                return 0;
+            }
+            case USB__HID__SET_IDLE:
+                _idle_rate  = USB__MSB(s->wValue);
+                _idle_count = 0;
+                usb__hal__control__status();
+                return 0;
+            case USB__HID__SET_PROTOCOL:
+                _protocol = USB__LSB(s->wValue);
+                usb__hal__control__status();
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
@@ -11,9 +11,23 @@
 #
 
 
+SRC += $(wildcard $(CURDIR)/common/*.c)
 SRC += $(wildcard $(CURDIR)/$(MCU)/*.c)
 
-ifeq '$(MCU)' 'atmega32u4'
-	SRC += $(wildcard $(CURDIR)/$(MCU)/keyboard/from-pjrc/*.c)
-endif
 
+# -----------------------------------------------------------------------------
+
+.PHONY: test usb-test
+test: usb-test
+
+usb-test: USB_TEST_DIR := $(CURDIR)/test
+usb-test:
+	$(MAKE) -C $(USB_TEST_DIR)
+# build and run the host side tests (see './test/makefile')
+
+.PHONY: usb-benchmark
+usb-benchmark: USB_TEST_DIR := $(CURDIR)/test
+usb-benchmark:
+	$(MAKE) -C $(USB_TEST_DIR) run-benchmark
+# build and run the host side report rate benchmark (see
+# './test/benchmark.c')
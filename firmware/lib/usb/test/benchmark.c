@@ -0,0 +1,285 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * A host side benchmark of the effective keyboard report rate
+ *
+ * Enumerates the device (against the fake in "./fake.h"), reads `bInterval`
+ * out of the keyboard endpoint descriptor, and has the fake host poll at that
+ * interval.  Then it measures:
+ *
+ * - scanning: a key changes on every scan, and `main()`'s loop is followed
+ *   (wait until `OPT__DEBOUNCE_TIME` ms have passed since the last scan
+ *   started, then send one report).  Reports the rate at which reports reach
+ *   the host, and the time from the start of a scan to the host receiving
+ *   its report.
+ * - streaming: the report queue is kept full (as the typing engine does while
+ *   typing a long string).  Reports the rate at which reports reach the host,
+ *   which is the most the keyboard can send.
+ *
+ * Usage: `benchmark [interval]`, where `interval` (optional) makes the host
+ * poll every `interval` frames instead of at the descriptor's `bInterval`
+ * (e.g. to see what a host that rounds `bInterval` would do).
+ *
+ * Notes:
+ * - Time is measured in frames (1 ms each, on a full speed bus), from
+ *   `fake__frame_number`.  A scan is taken to happen just after the frame
+ *   boundary it's started at, so a report that goes straight into a bank is
+ *   picked up by the next poll.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../usb.h"
+#include "../common/definitions.h"
+#include "../common/device.h"
+#include "../usage-page/keyboard.h"
+#include "./fake.h"
+
+// ----------------------------------------------------------------------------
+
+/**                                                  macros/_FRAMES/description
+ * The length of each measurement, in frames (10 seconds)
+ */
+#define  _FRAMES  10000
+
+/**                                                  macros/_WINDOW/description
+ * The number of reports we remember the send time of (must be more than can
+ * be in flight at once)
+ */
+#define  _WINDOW  256
+
+// ----------------------------------------------------------------------------
+
+/**                                          variables/(group) host/description
+ * What the host has received
+ *
+ * Members:
+ * - `_sent`: The frame each report was sent (i.e. its scan started) in,
+ *   indexed by sequence number (mod `_WINDOW`)
+ * - `_sent_count`: The number of reports sent
+ * - `_received_count`: The number of reports received
+ * - `_latency_total`, `_latency_max`: The sum and maximum of the number of
+ *   frames from sending each report to receiving it
+ * - `_mismatches`: The number of reports that arrived out of order, or with
+ *   the wrong contents
+ */
+static uint16_t _sent[_WINDOW];
+static uint32_t _sent_count;
+static uint32_t _received_count;
+static uint32_t _latency_total;
+static uint16_t _latency_max;
+static uint32_t _mismatches;
+
+// ----------------------------------------------------------------------------
+
+/**                                                  functions/_key/description
+ * The key pressed in the report with the given sequence number
+ */
+static uint8_t _key(uint32_t sequence) {
+    return KEYBOARD__a_A + (sequence % 26);
+}
+
+static void _on_packet( uint8_t         endpoint,
+                        const uint8_t * data,
+                        uint8_t         length ) {
+    uint32_t sequence = _received_count++;
+
+    if (data[2] != _key(sequence) || sequence >= _sent_count) {
+        _mismatches++;
+        return;
+    }
+
+    uint16_t latency = fake__frame_number - _sent[sequence % _WINDOW];
+    _latency_total += latency;
+    if (latency > _latency_max)
+        _latency_max = latency;
+}
+
+/**                                                 functions/_next/description
+ * Change the report (release the last key, press the next), and note the
+ * time
+ */
+static void _next(void) {
+    if (_sent_count)
+        usb__kb__set_key(false, _key(_sent_count-1));
+    usb__kb__set_key(true, _key(_sent_count));
+    _sent[_sent_count % _WINDOW] = fake__frame_number;
+    _sent_count++;
+}
+
+/**                                                functions/_start/description
+ * Reset the counters, and let the device settle
+ */
+static void _start(void) {
+    for (uint8_t i = 0; i < 16; i++)
+        fake__frame();
+    if (_sent_count)
+        usb__kb__set_key(false, _key(_sent_count-1));
+    _sent_count     = 0;
+    _received_count = 0;
+    _latency_total  = 0;
+    _latency_max    = 0;
+    _mismatches     = 0;
+}
+
+/**                                                functions/_drain/description
+ * Let frames go by until everything sent has arrived (or it's clear it never
+ * will)
+ */
+static void _drain(void) {
+    for (uint16_t i = 0; i < 60000 && _received_count < _sent_count; i++)
+        fake__frame();
+}
+
+/**                                                functions/_print/description
+ * Print the results of a measurement
+ *
+ * Arguments:
+ * - `name`: The name of the measurement
+ * - `received`: The number of reports received during the measurement
+ * - `frames`: The number of frames the measurement took
+ * - `latency`: Whether to print the latency
+ *
+ * Returns:
+ * - `0`: if every report sent arrived intact and in order
+ * - [other]: if not
+ */
+static uint8_t _print( const char * name,
+                       uint32_t     received,
+                       uint32_t     frames,
+                       bool         latency ) {
+    printf( "  %-10s %7.1f reports/s", name, received * 1000.0 / frames );
+    if (latency && _received_count)
+        printf( ", latency: mean %.2f ms, max %u ms",
+                (double) _latency_total / _received_count, _latency_max );
+    printf("\n");
+
+    if (_received_count == _sent_count && !_mismatches)
+        return 0;
+    printf( "  error: %lu sent, %lu received, %lu wrong\n",
+            (unsigned long) _sent_count,
+            (unsigned long) _received_count,
+            (unsigned long) _mismatches );
+    return 1;
+}
+
+// ----------------------------------------------------------------------------
+
+/**                                            functions/_enumerate/description
+ * Enumerate and configure the device
+ *
+ * Returns:
+ * - success: the `bInterval` of the keyboard endpoint
+ * - failure: `0`
+ */
+static uint8_t _enumerate(void) {
+    const uint8_t * d = fake__control.data;
+    uint8_t interval = 0;
+
+    usb__init();
+    fake__reset();
+
+    if ( fake__setup( USB__REQUEST__DIRECTION_IN, USB__GET_DESCRIPTOR,
+                      USB__DESCRIPTOR__CONFIGURATION<<8, 0, 255, NULL ) )
+        return 0;
+    for (uint16_t i = 0; i+1 < fake__control.length && d[i]; i += d[i])
+        if ( d[i+1] == USB__DESCRIPTOR__ENDPOINT
+                && (d[i+2] & 0x0F) == USB___KB__ENDPOINT )
+            interval = d[i+6];
+
+    if ( fake__setup(0, USB__SET_ADDRESS, 1, 0, 0, NULL)
+            || fake__setup(0, USB__SET_CONFIGURATION, 1, 0, 0, NULL)
+            || !usb__is_configured() )
+        return 0;
+
+    // no idle reports (as most hosts ask), so every report we count is one
+    // we sent
+    if ( fake__setup( USB__REQUEST__TYPE_CLASS | USB__REQUEST__TO_INTERFACE,
+                      USB__HID__SET_IDLE, 0, USB___KB__INTERFACE, 0, NULL ) )
+        return 0;
+
+    return interval;
+}
+
+/**                                                 functions/_scan/description
+ * Send one report per scan, the way `main()` does, for `_FRAMES` frames
+ */
+static uint8_t _scan(void) {
+    _start();
+
+    uint16_t start = fake__frame_number;
+    uint16_t scan_started = start - OPT__DEBOUNCE_TIME;
+    while ((uint16_t)(fake__frame_number - start) < _FRAMES) {
+        while ( (uint16_t)(fake__frame_number - scan_started)
+                < OPT__DEBOUNCE_TIME )
+            fake__frame();
+        scan_started = fake__frame_number;
+
+        _next();
+        usb__kb__send_report();
+    }
+    uint16_t frames = fake__frame_number - start;
+    uint32_t received = _received_count;
+
+    _drain();
+    return _print("scanning:", received, frames, true);
+}
+
+/**                                               functions/_stream/description
+ * Keep the report queue full for `_FRAMES` frames
+ */
+static uint8_t _stream(void) {
+    _start();
+
+    uint16_t start = fake__frame_number;
+    while ((uint16_t)(fake__frame_number - start) < _FRAMES) {
+        while (!usb__kb__queue_full()) {
+            _next();
+            usb__kb__queue_report();
+        }
+        fake__frame();
+    }
+    uint32_t received = _received_count;
+
+    _drain();
+    return _print("streaming:", received, _FRAMES, false);
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int argc, char * argv[]) {
+    uint8_t interval = _enumerate();
+    if (!interval) {
+        printf("enumeration failed\n");
+        return 1;
+    }
+
+    int poll = interval;
+    if (argc > 1)
+        poll = atoi(argv[1]);
+    if (poll < 1 || poll > 255) {
+        printf("usage: %s [interval (1..255)]\n", argv[0]);
+        return 1;
+    }
+
+    fake__on_packet = &_on_packet;
+    fake__ep[USB___KB__ENDPOINT].interval = poll;
+
+    printf( "usb: host polling every %u ms (bInterval %u), "
+            "scanning every %u ms\n",
+            poll, interval, OPT__DEBOUNCE_TIME );
+    uint8_t errors = _scan() + _stream();
+
+    if (fake__error) {
+        printf("error: %s\n", fake__error);
+        errors++;
+    }
+    return errors;
+}
@@ -0,0 +1,264 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Implements '.../firmware/lib/usb/common/hal.h' (and "./fake.h") on the host
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../common/device.h"
+#include "../common/hal.h"
+#include "./fake.h"
+
+// ----------------------------------------------------------------------------
+
+bool            fake__attached;
+bool            fake__suspended;
+uint8_t         fake__address;
+uint16_t        fake__frame_number;
+uint8_t         fake__wakeups;
+const char *    fake__error;
+fake__ep_t      fake__ep[FAKE__ENDPOINTS];
+fake__control_t fake__control;
+void         (* fake__on_packet) ( uint8_t         endpoint,
+                                   const uint8_t * data,
+                                   uint8_t         length );
+
+// ----------------------------------------------------------------------------
+
+/**                                            variables/_interrupt/description
+ * Whether we're currently "in interrupt context" (i.e. inside one of the
+ * `fake__` functions that deliver events to the device)
+ */
+static bool _interrupt;
+
+// ----------------------------------------------------------------------------
+
+/**                                                functions/_error/description
+ * Record a violation of the HAL interface, if it's the first one
+ */
+static void _error(const char * message) {
+    if (!fake__error)
+        fake__error = message;
+}
+
+/**                                                 functions/_poll/description
+ * Have the host poll the given IN endpoint (picking up the oldest waiting
+ * packet, if there is one)
+ */
+static void _poll(uint8_t endpoint) {
+    fake__ep_t * ep = &fake__ep[endpoint];
+    if (!ep->full)
+        return;  // NAK
+
+    uint8_t bank = ep->first;
+    ep->first = (ep->first + 1) % ep->banks;
+    ep->full--;
+
+    if (fake__on_packet)
+        fake__on_packet(endpoint, ep->data[bank], ep->length[bank]);
+}
+
+// ----------------------------------------------------------------------------
+
+void fake__reset(void) {
+    _interrupt = true;
+    fake__suspended = false;
+    fake__address   = 0;
+    for (uint8_t i=0; i<FAKE__ENDPOINTS; i++) {
+        uint8_t interval = fake__ep[i].interval;
+        memset(&fake__ep[i], 0, sizeof(fake__ep_t));
+        fake__ep[i].interval = interval;
+    }
+    usb___reset();
+    _interrupt = false;
+}
+
+void fake__suspend(void) {
+    _interrupt = true;
+    fake__suspended = true;
+    usb___suspend();
+    _interrupt = false;
+}
+
+void fake__resume(void) {
+    _interrupt = true;
+    fake__suspended = false;
+    usb___resume();
+    _interrupt = false;
+}
+
+void fake__frame(void) {
+    if (fake__suspended)
+        return;
+
+    bool interrupt = _interrupt;
+    _interrupt = true;
+
+    fake__frame_number++;
+    usb___start_of_frame();
+
+    for (uint8_t i=1; i<FAKE__ENDPOINTS; i++) {
+        fake__ep_t * ep = &fake__ep[i];
+        if ( ep->enabled && !ep->halted && (ep->address & 0x80)
+                && ep->interval && !(fake__frame_number % ep->interval) )
+            _poll(i);
+    }
+
+    _interrupt = interrupt;
+}
+
+uint8_t fake__setup( uint8_t         bmRequestType,
+                     uint8_t         bRequest,
+                     uint16_t        wValue,
+                     uint16_t        wIndex,
+                     uint16_t        wLength,
+                     const uint8_t * out ) {
+    usb___setup_t setup = {
+        .bmRequestType = bmRequestType,
+        .bRequest      = bRequest,
+        .wValue        = wValue,
+        .wIndex        = wIndex,
+        .wLength       = wLength,
+    };
+
+    memset(&fake__control, 0, sizeof(fake__control));
+    fake__control.out        = out;
+    fake__control.out_length = (out) ? wLength : 0;
+
+    _interrupt = true;
+    fake__control.stalled = usb___setup(&setup);
+    _interrupt = false;
+
+    if (!fake__control.stalled && fake__control.length > wLength)
+        _error("control IN data longer than wLength");
+
+    return fake__control.stalled;
+}
+
+// ----------------------------------------------------------------------------
+
+void usb__hal__init(void) {
+    fake__attached = true;
+}
+
+void usb__hal__set_address(uint8_t address) {
+    if (!fake__control.status)
+        _error("address set before the status stage");
+    fake__address = address;
+}
+
+uint16_t usb__hal__frame_number(void) {
+    return fake__frame_number & 0x7FF;
+}
+
+void usb__hal__remote_wakeup(void) {
+    if (!fake__suspended)
+        _error("remote wakeup while the bus is not suspended");
+    fake__wakeups++;
+}
+
+// ----------------------------------------------------------------------------
+
+uint8_t usb__hal__ep__configure( uint8_t address,
+                                 uint8_t attributes,
+                                 uint8_t size,
+                                 uint8_t banks ) {
+    uint8_t number = address & 0x0F;
+    if (number == 0 || number >= FAKE__ENDPOINTS)
+        return 1;
+    if (size > 64 || banks < 1 || banks > FAKE__BANKS)
+        return 1;
+
+    fake__ep_t * ep = &fake__ep[number];
+    uint8_t interval = ep->interval;
+    memset(ep, 0, sizeof(fake__ep_t));
+    ep->enabled    = true;
+    ep->address    = address;
+    ep->attributes = attributes;
+    ep->size       = size;
+    ep->banks      = banks;
+    ep->interval   = interval;
+    return 0;
+}
+
+void usb__hal__ep__set_halt(uint8_t endpoint, bool halt) {
+    fake__ep[endpoint].halted = halt;
+    if (!halt) {
+        fake__ep[endpoint].full  = 0;
+        fake__ep[endpoint].first = 0;
+    }
+}
+
+bool usb__hal__ep__is_halted(uint8_t endpoint) {
+    return fake__ep[endpoint].halted;
+}
+
+uint8_t usb__hal__ep__send( uint8_t         endpoint,
+                            const uint8_t * data,
+                            uint8_t         length ) {
+    fake__ep_t * ep = &fake__ep[endpoint];
+
+    if (!ep->enabled || !(ep->address & 0x80)) {
+        _error("send on an endpoint that isn't a configured IN endpoint");
+        return 1;
+    }
+    if (length > ep->size) {
+        _error("send longer than the endpoint's maximum packet size");
+        return 1;
+    }
+
+    if (ep->full == ep->banks) {
+        if (!_interrupt)
+            fake__frame();  // the caller is waiting; let time pass
+        return 1;
+    }
+
+    uint8_t bank = (ep->first + ep->full) % ep->banks;
+    memcpy(ep->data[bank], data, length);
+    ep->length[bank] = length;
+    ep->full++;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void usb__hal__control__send( const uint8_t * data,
+                              uint8_t         length,
+                              uint16_t        requested,
+                              bool            progmem ) {
+    // (PROGMEM is ordinary memory on the host)
+    bool zlp = length < requested && length % USB___CONTROL_SIZE == 0;
+
+    uint8_t n;
+    do {
+        n = (length < USB___CONTROL_SIZE) ? length : USB___CONTROL_SIZE;
+        if (fake__control.length + n > sizeof(fake__control.data)) {
+            _error("control IN data too long for the fake");
+            return;
+        }
+        memcpy(&fake__control.data[fake__control.length], data, n);
+        fake__control.length += n;
+        fake__control.packets++;
+        data   += n;
+        length -= n;
+    } while ( length || (zlp && n == USB___CONTROL_SIZE) );
+}
+
+uint8_t usb__hal__control__receive(uint8_t * data, uint8_t length) {
+    if (!fake__control.out || fake__control.out_length < length)
+        return 1;
+    memcpy(data, fake__control.out, length);
+    return 0;
+}
+
+void usb__hal__control__status(void) {
+    fake__control.status = true;
+}
@@ -0,0 +1,242 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * A host side fake of the USB hardware, and of the host at the other end of
+ * the bus
+ *
+ * Prefix: `fake__`
+ *
+ * "./fake.c" implements '.../firmware/lib/usb/common/hal.h' in plain C, so
+ * that the device independent part of the USB implementation can be compiled
+ * and run on the machine doing the building.  The functions here play the
+ * part of the host (and of the interrupts): they deliver bus events and
+ * SETUP packets to the device, let frames go by, and record what the device
+ * sent back.
+ *
+ * Notes:
+ * - Everything runs in one thread.  Interrupts are modelled by calling the
+ *   `usb___` event handlers directly from the functions below, which is
+ *   equivalent to the interrupt firing at that point in the main loop.
+ * - A main loop busy-wait is modelled by letting one frame go by every time
+ *   `usb__hal__ep__send()` is called from outside interrupt context and finds
+ *   no free bank.  Every wait in the USB code is on a free bank (with a
+ *   timeout measured in frames), so this is enough to make the waits end.
+ */
+
+
+#ifndef ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__TEST__FAKE__H
+#define ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__TEST__FAKE__H
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ----------------------------------------------------------------------------
+
+#define  FAKE__ENDPOINTS  16
+#define  FAKE__BANKS       2
+
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    bool    enabled;
+    uint8_t address;
+    uint8_t attributes;
+    uint8_t size;
+    uint8_t banks;
+    bool    halted;
+    uint8_t interval;
+    uint8_t full;
+    uint8_t first;
+    uint8_t data[FAKE__BANKS][64];
+    uint8_t length[FAKE__BANKS];
+} fake__ep_t;
+
+typedef struct {
+    uint8_t         data[512];
+    uint16_t        length;
+    uint8_t         packets;
+    bool            status;
+    bool            stalled;
+    const uint8_t * out;
+    uint8_t         out_length;
+} fake__control_t;
+
+// ----------------------------------------------------------------------------
+
+extern bool            fake__attached;
+extern bool            fake__suspended;
+extern uint8_t         fake__address;
+extern uint16_t        fake__frame_number;
+extern uint8_t         fake__wakeups;
+extern const char *    fake__error;
+extern fake__ep_t      fake__ep[FAKE__ENDPOINTS];
+extern fake__control_t fake__control;
+extern void         (* fake__on_packet) ( uint8_t         endpoint,
+                                          const uint8_t * data,
+                                          uint8_t         length );
+
+// ----------------------------------------------------------------------------
+
+void    fake__reset   (void);
+void    fake__suspend (void);
+void    fake__resume  (void);
+void    fake__frame   (void);
+uint8_t fake__setup   ( uint8_t         bmRequestType,
+                        uint8_t         bRequest,
+                        uint16_t        wValue,
+                        uint16_t        wIndex,
+                        uint16_t        wLength,
+                        const uint8_t * out );
+
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+#endif  // ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__TEST__FAKE__H
+
+
+
+// ============================================================================
+// === documentation ==========================================================
+// ============================================================================
+
+
+// ----------------------------------------------------------------------------
+// macros ---------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// === FAKE__ENDPOINTS ===
+/**                                          macros/FAKE__ENDPOINTS/description
+ * The number of endpoints the fake hardware has (including endpoint 0)
+ */
+
+// === FAKE__BANKS ===
+/**                                              macros/FAKE__BANKS/description
+ * The maximum number of banks the fake hardware will give an endpoint
+ */
+
+
+// ----------------------------------------------------------------------------
+// types ----------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// === fake__ep_t ===
+/**                                                types/fake__ep_t/description
+ * The state of a (non-control) endpoint
+ *
+ * Struct members:
+ * - `enabled`: Whether the endpoint has been configured
+ * - `address`, `attributes`, `size`, `banks`: The arguments it was configured
+ *   with (see `usb__hal__ep__configure()`)
+ * - `halted`: Whether the endpoint is halted
+ * - `interval`: How often the host polls the endpoint, in frames (`0` =
+ *   never).  Set by the test; not touched by the device.
+ * - `full`: The number of banks holding a packet the host hasn't picked up
+ * - `first`: The index of the bank holding the oldest such packet
+ * - `data`, `length`: The contents of the banks
+ */
+
+// === fake__control_t ===
+/**                                           types/fake__control_t/description
+ * What happened on the control endpoint during the last call to
+ * `fake__setup()`
+ *
+ * Struct members:
+ * - `data`, `length`: The data the device sent in the data stage
+ * - `packets`: The number of IN packets the data was sent in, including any
+ *   zero length packet at the end
+ * - `status`: Whether the device completed the status stage of a transfer
+ *   with no data stage (or an OUT data stage)
+ * - `stalled`: Whether the device stalled the request
+ * - `out`, `out_length`: The data for the OUT data stage, if any (private)
+ */
+
+
+// ----------------------------------------------------------------------------
+// variables ------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// === (group) state ===
+/**                                         variables/(group) state/description
+ * The state of the fake hardware (all readable by tests)
+ *
+ * Members:
+ * - `fake__attached`: Whether `usb__hal__init()` has been called
+ * - `fake__suspended`: Whether the bus is suspended
+ * - `fake__address`: The current device address
+ * - `fake__frame_number`: The number of frames that have gone by (not
+ *   truncated to 11 bits)
+ * - `fake__wakeups`: The number of times the device has signalled remote
+ *   wakeup
+ * - `fake__error`: A description of the first thing the device did that the
+ *   HAL interface (or the USB spec) doesn't allow, or `NULL`
+ * - `fake__ep`: The endpoints
+ * - `fake__control`: See `fake__control_t`
+ */
+
+// === fake__on_packet ===
+/**                                       variables/fake__on_packet/description
+ * A function to call with each packet the host picks up from an IN endpoint
+ * (may be `NULL`)
+ *
+ * Arguments:
+ * - `endpoint`: The endpoint number
+ * - `data`: A pointer to the contents of the packet
+ * - `length`: The length of the packet
+ */
+
+
+// ----------------------------------------------------------------------------
+// functions ------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// === fake__reset() ===
+/**                                           functions/fake__reset/description
+ * Reset the bus
+ *
+ * Clears the device address and all non-control endpoints, and calls
+ * `usb___reset()` (as the HAL would from its bus reset interrupt).
+ */
+
+// === fake__suspend() ===
+/**                                         functions/fake__suspend/description
+ * Suspend the bus (no frames go by until it's resumed)
+ */
+
+// === fake__resume() ===
+/**                                          functions/fake__resume/description
+ * Resume the bus
+ */
+
+// === fake__frame() ===
+/**                                           functions/fake__frame/description
+ * Let one (1 ms) frame go by
+ *
+ * Calls `usb___start_of_frame()`, and then lets the host poll every enabled,
+ * un-halted, IN endpoint that is due (`fake__frame_number % interval == 0`),
+ * passing each packet it picks up to `fake__on_packet`.  Does nothing while
+ * the bus is suspended.
+ */
+
+// === fake__setup() ===
+/**                                           functions/fake__setup/description
+ * Send a SETUP packet, and let the device handle the whole control transfer
+ *
+ * Arguments:
+ * - `bmRequestType`, `bRequest`, `wValue`, `wIndex`, `wLength`: The contents
+ *   of the packet
+ * - `out`: The data for the OUT data stage (`wLength` bytes), or `NULL`
+ *
+ * Returns:
+ * - success: `0`
+ * - failure: [other] (the device stalled the request)
+ *
+ * Notes:
+ * - The results are left in `fake__control`.
+ */
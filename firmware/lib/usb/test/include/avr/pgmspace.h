@@ -0,0 +1,38 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * A host side stand-in for the parts of <avr/pgmspace.h> the USB code uses
+ *
+ * On the host, PROGMEM is ordinary memory.
+ *
+ * Notes:
+ * - `pgm_read_word()` reads through the pointer it's given, instead of always
+ *   reading 16 bits, so that reading a (PROGMEM) pointer out of a PROGMEM
+ *   table still works where pointers are wider than 16 bits.
+ */
+
+
+#ifndef ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__TEST__INCLUDE__AVR__PGMSPACE__H
+#define ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__TEST__INCLUDE__AVR__PGMSPACE__H
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+
+#include <stdint.h>
+
+// ----------------------------------------------------------------------------
+
+#define  PROGMEM
+#define  PSTR(s)  (s)
+
+#define  pgm_read_byte(address)  ( *(const uint8_t *)(address) )
+#define  pgm_read_word(address)  ( *(address) )
+
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+#endif  // ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__TEST__INCLUDE__AVR__PGMSPACE__H
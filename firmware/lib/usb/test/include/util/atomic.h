@@ -0,0 +1,29 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * A host side stand-in for <util/atomic.h>
+ *
+ * The fake (see "../../fake.h") runs everything in one thread, and only
+ * delivers "interrupts" when it's called, so every block is already atomic.
+ */
+
+
+#ifndef ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__TEST__INCLUDE__UTIL__ATOMIC__H
+#define ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__TEST__INCLUDE__UTIL__ATOMIC__H
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+
+#define  ATOMIC_RESTORESTATE
+#define  ATOMIC_FORCEON
+
+#define  ATOMIC_BLOCK(type)  for (int _atomic = 1; _atomic; _atomic = 0)
+
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+#endif  // ERGODOX_FIRMWARE__FIRMWARE__LIB__USB__TEST__INCLUDE__UTIL__ATOMIC__H
@@ -0,0 +1,503 @@
+/* ----------------------------------------------------------------------------
+ * Copyright (c) 2013 Ben Blazak <benblazak.dev@gmail.com>
+ * Released under The MIT License (see "doc/licenses/MIT.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+/**                                                                 description
+ * Tests for the device independent part of the USB implementation, run
+ * against the fake in "./fake.h"
+ *
+ * Each `_test__...()` function starts from a freshly reset (and, except for
+ * enumeration, configured) device.  Failures are printed as they're found;
+ * the exit status is the number of failures (capped at 255).
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../../usb.h"
+#include "../common/definitions.h"
+#include "../common/device.h"
+#include "../usage-page/keyboard.h"
+#include "./fake.h"
+
+// ----------------------------------------------------------------------------
+
+/**                                                   macros/_CHECK/description
+ * Count (and print) a failure if `condition` is false
+ */
+#define  _CHECK(condition)                                                  \
+    do {                                                                    \
+        _checks++;                                                          \
+        if (!(condition)) {                                                 \
+            _failures++;                                                    \
+            printf( "%s:%d: %s: failed: %s\n",                              \
+                    __FILE__, __LINE__, __func__, #condition );             \
+        }                                                                   \
+    } while (0)
+
+/**                                         macros/(group) requests/description
+ * Shorthand for the `bmRequestType`s we use
+ *
+ * Members:
+ * - `_IN_DEVICE`, `_OUT_DEVICE`: Standard, to the device
+ * - `_IN_INTERFACE`, `_OUT_INTERFACE`: Standard, to an interface
+ * - `_IN_ENDPOINT`, `_OUT_ENDPOINT`: Standard, to an endpoint
+ * - `_IN_HID`, `_OUT_HID`: Class, to an interface
+ */
+#define  _IN_DEVICE      ( USB__REQUEST__DIRECTION_IN               \
+                         | USB__REQUEST__TYPE_STANDARD              \
+                         | USB__REQUEST__TO_DEVICE )
+#define  _OUT_DEVICE     ( USB__REQUEST__TYPE_STANDARD              \
+                         | USB__REQUEST__TO_DEVICE )
+#define  _IN_INTERFACE   ( USB__REQUEST__DIRECTION_IN               \
+                         | USB__REQUEST__TYPE_STANDARD              \
+                         | USB__REQUEST__TO_INTERFACE )
+#define  _OUT_INTERFACE  ( USB__REQUEST__TYPE_STANDARD              \
+                         | USB__REQUEST__TO_INTERFACE )
+#define  _IN_ENDPOINT    ( USB__REQUEST__DIRECTION_IN               \
+                         | USB__REQUEST__TYPE_STANDARD              \
+                         | USB__REQUEST__TO_ENDPOINT )
+#define  _OUT_ENDPOINT   ( USB__REQUEST__TYPE_STANDARD              \
+                         | USB__REQUEST__TO_ENDPOINT )
+#define  _IN_HID         ( USB__REQUEST__DIRECTION_IN               \
+                         | USB__REQUEST__TYPE_CLASS                 \
+                         | USB__REQUEST__TO_INTERFACE )
+#define  _OUT_HID        ( USB__REQUEST__TYPE_CLASS                 \
+                         | USB__REQUEST__TO_INTERFACE )
+
+#define  _KB_IN  (USB___KB__ENDPOINT | USB__ENDPOINT__IN)
+
+// ----------------------------------------------------------------------------
+
+static unsigned int _checks;
+static unsigned int _failures;
+
+/**                                          variables/(group) host/description
+ * What the host has received on the keyboard endpoint
+ *
+ * Members:
+ * - `_received`: The reports, in the order they were received
+ * - `_received_frame`: The frame each report was received in
+ * - `_received_count`: The number of reports received
+ */
+static uint8_t      _received[64][USB___KB__REPORT_SIZE];
+static uint16_t     _received_frame[64];
+static uint8_t      _received_count;
+
+// ----------------------------------------------------------------------------
+
+static void _on_packet( uint8_t         endpoint,
+                        const uint8_t * data,
+                        uint8_t         length ) {
+    if (endpoint != USB___KB__ENDPOINT || length != USB___KB__REPORT_SIZE) {
+        _CHECK(false);
+        return;
+    }
+    if (_received_count < sizeof(_received)/sizeof(_received[0])) {
+        memcpy(_received[_received_count], data, length);
+        _received_frame[_received_count] = fake__frame_number;
+    }
+    _received_count++;
+}
+
+/**                                           functions/_descriptor/description
+ * Read a descriptor with GET_DESCRIPTOR, leaving it in `fake__control.data`
+ *
+ * Returns:
+ * - success: the length of the descriptor
+ * - failure: `0`
+ */
+static uint16_t _descriptor(uint8_t type, uint8_t number, uint16_t index) {
+    if ( fake__setup( _IN_DEVICE, USB__GET_DESCRIPTOR,
+                      (type<<8)|number, index, 255, NULL ) )
+        return 0;
+    return fake__control.length;
+}
+
+/**                                              functions/_release/description
+ * Release every key in the report
+ */
+static void _release(void) {
+    for (uint8_t k = KEYBOARD__a_A; k <= KEYBOARD__RightGUI; k++)
+        usb__kb__set_key(false, k);
+}
+
+/**                                                functions/_start/description
+ * Reset the bus (and the record of what's been received), and configure the
+ * device if asked to
+ */
+static void _start(bool configure, uint8_t interval) {
+    _release();
+    fake__on_packet = &_on_packet;
+    fake__ep[USB___KB__ENDPOINT].interval = interval;
+    fake__reset();
+    fake__error = NULL;
+    _received_count = 0;
+    if (configure) {
+        fake__setup(_OUT_DEVICE, USB__SET_ADDRESS, 7, 0, 0, NULL);
+        fake__setup(_OUT_DEVICE, USB__SET_CONFIGURATION, 1, 0, 0, NULL);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+/**                                    functions/_test__enumeration/description
+ * Go through the requests a host makes when the device is plugged in, and
+ * check the answers
+ */
+static void _test__enumeration(void) {
+    _start(false, 0);
+    _CHECK( !usb__is_configured() );
+
+    // the first request is usually for the first 8 (or 64) bytes of the
+    // device descriptor, at address 0
+    _CHECK( !fake__setup( _IN_DEVICE, USB__GET_DESCRIPTOR,
+                          USB__DESCRIPTOR__DEVICE<<8, 0, 8, NULL ) );
+    _CHECK( fake__control.length == 8 );
+    _CHECK( fake__control.packets == 1 );
+    _CHECK( fake__control.data[7] == USB___CONTROL_SIZE );  // bMaxPacketSize0
+
+    _CHECK( !fake__setup(_OUT_DEVICE, USB__SET_ADDRESS, 7, 0, 0, NULL) );
+    _CHECK( fake__control.status );
+    _CHECK( fake__address == 7 );
+
+    // device descriptor
+    _CHECK( _descriptor(USB__DESCRIPTOR__DEVICE, 0, 0) == 18 );
+    const uint8_t * d = fake__control.data;
+    _CHECK( d[0] == 18 && d[1] == USB__DESCRIPTOR__DEVICE );
+    _CHECK( (d[8]|d[9]<<8) == OPT__USB__VENDOR_ID );
+    _CHECK( (d[10]|d[11]<<8) == OPT__USB__PRODUCT_ID );
+    _CHECK( d[17] == 1 );  // bNumConfigurations
+
+    // configuration descriptor: first the header, then the whole thing
+    _CHECK( !fake__setup( _IN_DEVICE, USB__GET_DESCRIPTOR,
+                          USB__DESCRIPTOR__CONFIGURATION<<8, 0, 9, NULL ) );
+    _CHECK( fake__control.length == 9 );
+    uint16_t total = d[2] | d[3]<<8;
+
+    _CHECK( _descriptor(USB__DESCRIPTOR__CONFIGURATION, 0, 0) == total );
+    // a short transfer ends with a short packet (adding a zero length one if
+    // the last was full), so this is `total/size` full packets, plus one
+    _CHECK( fake__control.packets == total/USB___CONTROL_SIZE + 1 );
+
+    uint8_t interfaces = 0, endpoints = 0, hid_report_length = 0;
+    for (uint16_t i = 0; i < total; i += d[i]) {
+        _CHECK( d[i] != 0 );
+        if (d[i] == 0)
+            break;
+        switch (d[i+1]) {
+            case USB__DESCRIPTOR__INTERFACE:
+                interfaces++;
+                _CHECK( d[i+2] == USB___KB__INTERFACE );
+                _CHECK( d[i+5] == 0x03 );  // HID
+                _CHECK( d[i+6] == 0x01 );  // boot
+                _CHECK( d[i+7] == 0x01 );  // keyboard
+                break;
+            case USB__DESCRIPTOR__HID:
+                hid_report_length = d[i+7];
+                break;
+            case USB__DESCRIPTOR__ENDPOINT:
+                endpoints++;
+                _CHECK( d[i+2] == _KB_IN );
+                _CHECK( d[i+3] == USB__ENDPOINT__INTERRUPT );
+                _CHECK( d[i+4] == USB___KB__REPORT_SIZE && d[i+5] == 0 );
+                _CHECK( d[i+6] == OPT__USB__POLLING_INTERVAL );
+                break;
+        }
+    }
+    _CHECK( interfaces == 1 && endpoints == 1 );
+
+    // an exact length transfer ends without a zero length packet
+    if (total >= USB___CONTROL_SIZE) {
+        _CHECK( !fake__setup( _IN_DEVICE, USB__GET_DESCRIPTOR,
+                              USB__DESCRIPTOR__CONFIGURATION<<8, 0,
+                              USB___CONTROL_SIZE, NULL ) );
+        _CHECK( fake__control.packets == 1 );
+    }
+
+    // strings
+    _CHECK( _descriptor(USB__DESCRIPTOR__STRING, 0, 0) == 4 );
+    _CHECK( (d[2]|d[3]<<8) == 0x0409 );
+
+    static const uint16_t product[] = OPT__USB__STR_PRODUCT;
+    _CHECK( _descriptor(USB__DESCRIPTOR__STRING, 2, 0x0409)
+            == sizeof(product) );
+    _CHECK( d[0] == sizeof(product) && d[1] == USB__DESCRIPTOR__STRING );
+    _CHECK( !memcmp(d+2, product, sizeof(product)-2) );
+
+    _CHECK( _descriptor(USB__DESCRIPTOR__STRING, 3, 0x0409) == 0 );
+    _CHECK( fake__control.stalled );
+
+    // HID descriptors (requested from the interface)
+    _CHECK( !fake__setup( _IN_INTERFACE, USB__GET_DESCRIPTOR,
+                          USB__DESCRIPTOR__HID_REPORT<<8,
+                          USB___KB__INTERFACE, 255, NULL ) );
+    _CHECK( fake__control.length == hid_report_length );
+    _CHECK( d[0] == 0x05 && d[1] == 0x01 );  // Usage Page (Generic Desktop)
+
+    // set configuration
+    _CHECK( !fake__setup(_IN_DEVICE, USB__GET_CONFIGURATION, 0, 0, 1, NULL) );
+    _CHECK( fake__control.length == 1 && d[0] == 0 );
+
+    _CHECK( fake__setup(_OUT_DEVICE, USB__SET_CONFIGURATION, 2, 0, 0, NULL) );
+    _CHECK( !usb__is_configured() );
+
+    _CHECK( !fake__setup(_OUT_DEVICE, USB__SET_CONFIGURATION, 1, 0, 0, NULL) );
+    _CHECK( usb__is_configured() );
+    _CHECK( fake__ep[USB___KB__ENDPOINT].enabled );
+    _CHECK( fake__ep[USB___KB__ENDPOINT].address == _KB_IN );
+    _CHECK( fake__ep[USB___KB__ENDPOINT].size == USB___KB__REPORT_SIZE );
+    _CHECK( fake__ep[USB___KB__ENDPOINT].banks == 2 );
+
+    _CHECK( !fake__setup(_IN_DEVICE, USB__GET_CONFIGURATION, 0, 0, 1, NULL) );
+    _CHECK( fake__control.length == 1 && d[0] == 1 );
+
+    // requests we don't support
+    _CHECK( fake__setup(_IN_ENDPOINT, USB__SYNCH_FRAME, 0, 1, 2, NULL) );
+    _CHECK( fake__setup(_OUT_DEVICE, USB__SET_DESCRIPTOR, 0, 0, 0, NULL) );
+
+    // a bus reset unconfigures the device
+    fake__reset();
+    _CHECK( !usb__is_configured() );
+
+    _CHECK( fake__error == NULL );
+}
+
+/**                                       functions/_test__features/description
+ * Check GET_STATUS, SET_FEATURE, and CLEAR_FEATURE
+ */
+static void _test__features(void) {
+    const uint8_t * d = fake__control.data;
+    _start(true, 0);
+
+    // remote wakeup
+    _CHECK( !fake__setup(_IN_DEVICE, USB__GET_STATUS, 0, 0, 2, NULL) );
+    _CHECK( fake__control.length == 2 && (d[0] & 0x02) == 0 );
+
+    _CHECK( !fake__setup( _OUT_DEVICE, USB__SET_FEATURE,
+                          USB__FEATURE__DEVICE_REMOTE_WAKEUP, 0, 0, NULL ) );
+    _CHECK( !fake__setup(_IN_DEVICE, USB__GET_STATUS, 0, 0, 2, NULL) );
+    _CHECK( d[0] & 0x02 );
+
+    // endpoint halt
+    _CHECK( !fake__setup( _OUT_ENDPOINT, USB__SET_FEATURE,
+                          USB__FEATURE__ENDPOINT_HALT, _KB_IN, 0, NULL ) );
+    _CHECK( fake__ep[USB___KB__ENDPOINT].halted );
+    _CHECK( !fake__setup(_IN_ENDPOINT, USB__GET_STATUS, 0, _KB_IN, 2, NULL) );
+    _CHECK( d[0] == 1 );
+
+    _CHECK( !fake__setup( _OUT_ENDPOINT, USB__CLEAR_FEATURE,
+                          USB__FEATURE__ENDPOINT_HALT, _KB_IN, 0, NULL ) );
+    _CHECK( !fake__ep[USB___KB__ENDPOINT].halted );
+    _CHECK( !fake__setup(_IN_ENDPOINT, USB__GET_STATUS, 0, _KB_IN, 2, NULL) );
+    _CHECK( d[0] == 0 );
+
+    // the control endpoint can't be halted this way
+    _CHECK( fake__setup( _OUT_ENDPOINT, USB__SET_FEATURE,
+                         USB__FEATURE__ENDPOINT_HALT, 0, 0, NULL ) );
+
+    // interfaces (no alternate settings)
+    _CHECK( !fake__setup( _IN_INTERFACE, USB__GET_INTERFACE,
+                          0, USB___KB__INTERFACE, 1, NULL ) );
+    _CHECK( fake__control.length == 1 && d[0] == 0 );
+    _CHECK( fake__setup( _OUT_INTERFACE, USB__SET_INTERFACE,
+                         1, USB___KB__INTERFACE, 0, NULL ) );
+
+    _CHECK( fake__error == NULL );
+}
+
+/**                                            functions/_test__hid/description
+ * Check the HID class requests
+ */
+static void _test__hid(void) {
+    const uint8_t * d = fake__control.data;
+    _start(true, 0);
+
+    // LEDs
+    uint8_t leds = 0x02;  // caps lock
+    _CHECK( !fake__setup( _OUT_HID, USB__HID__SET_REPORT, 0x0200,
+                          USB___KB__INTERFACE, 1, &leds ) );
+    _CHECK( fake__control.status );
+    _CHECK( usb__kb__read_led('C') && !usb__kb__read_led('N') );
+    _CHECK( fake__setup( _OUT_HID, USB__HID__SET_REPORT, 0x0200,
+                         USB___KB__INTERFACE, 1, NULL ) );
+
+    // report
+    usb__kb__set_key(true, KEYBOARD__LeftShift);
+    usb__kb__set_key(true, KEYBOARD__a_A);
+    _CHECK( !fake__setup( _IN_HID, USB__HID__GET_REPORT, 0x0100,
+                          USB___KB__INTERFACE, 8, NULL ) );
+    _CHECK( fake__control.length == 8 );
+    _CHECK( d[0] == 0x02 && d[2] == KEYBOARD__a_A && d[3] == 0 );
+    _CHECK( usb__kb__keys_free() == 5 );
+    for (uint8_t k = KEYBOARD__b_B; k < KEYBOARD__b_B + 5; k++)
+        _CHECK( !usb__kb__set_key(true, k) );
+    _CHECK( usb__kb__keys_free() == 0 );
+    _CHECK( usb__kb__set_key(true, KEYBOARD__z_Z) );
+    _CHECK( !usb__kb__set_key(true, KEYBOARD__LeftControl) );
+    _release();
+    _CHECK( usb__kb__keys_free() == 6 );
+
+    // protocol
+    _CHECK( !fake__setup( _IN_HID, USB__HID__GET_PROTOCOL, 0,
+                          USB___KB__INTERFACE, 1, NULL ) );
+    _CHECK( d[0] == 1 );
+    _CHECK( !fake__setup( _OUT_HID, USB__HID__SET_PROTOCOL, 0,
+                          USB___KB__INTERFACE, 0, NULL ) );
+    _CHECK( !fake__setup( _IN_HID, USB__HID__GET_PROTOCOL, 0,
+                          USB___KB__INTERFACE, 1, NULL ) );
+    _CHECK( d[0] == 0 );
+
+    // idle: with a rate of 8 ms, the report is resent every 8 frames once
+    // nothing else is being sent
+    _CHECK( !fake__setup( _OUT_HID, USB__HID__SET_IDLE, 2<<8,
+                          USB___KB__INTERFACE, 0, NULL ) );
+    _CHECK( !fake__setup( _IN_HID, USB__HID__GET_IDLE, 0,
+                          USB___KB__INTERFACE, 1, NULL ) );
+    _CHECK( d[0] == 2 );
+
+    fake__ep[USB___KB__ENDPOINT].interval = 1;
+    for (uint8_t i = 0; i < 64; i++)
+        fake__frame();
+    _CHECK( _received_count >= 7 && _received_count <= 8 );
+    for (uint8_t i = 1; i < _received_count; i++)
+        _CHECK( _received_frame[i] - _received_frame[i-1] == 8 );
+
+    // class requests to some other interface aren't ours
+    _CHECK( fake__setup(_IN_HID, USB__HID__GET_IDLE, 0, 1, 1, NULL) );
+
+    _CHECK( fake__error == NULL );
+}
+
+/**                                   functions/_test__report_queue/description
+ * Check that queued reports come out in order, one per frame, and that the
+ * queue reports when it's full
+ */
+static void _test__report_queue(void) {
+    _start(true, 0);
+    fake__setup( _OUT_HID, USB__HID__SET_IDLE, 0,
+                 USB___KB__INTERFACE, 0, NULL );
+
+    // fill the queue, each report with a different key pressed
+    for (uint8_t i = 0; i < OPT__USB__REPORT_QUEUE_SIZE; i++) {
+        _CHECK( !usb__kb__queue_full() );
+        usb__kb__set_key(true, KEYBOARD__a_A + i);
+        _CHECK( !usb__kb__queue_report() );
+        usb__kb__set_key(false, KEYBOARD__a_A + i);
+    }
+    _CHECK( usb__kb__queue_full() );
+    _CHECK( usb__kb__queue_report() );
+
+    // nothing's sent until frames start going by, then the head goes into a
+    // bank every frame
+    _CHECK( fake__ep[USB___KB__ENDPOINT].full == 0 );
+    fake__frame();
+    fake__frame();
+    _CHECK( fake__ep[USB___KB__ENDPOINT].full == 2 );
+    _CHECK( !usb__kb__queue_full() );
+    fake__frame();  // (no bank free)
+    _CHECK( fake__ep[USB___KB__ENDPOINT].full == 2 );
+
+    // once the host starts polling, one report per frame
+    fake__ep[USB___KB__ENDPOINT].interval = 1;
+    uint16_t start = fake__frame_number;
+    for (uint8_t i = 0; i < OPT__USB__REPORT_QUEUE_SIZE + 4; i++)
+        fake__frame();
+
+    _CHECK( _received_count == OPT__USB__REPORT_QUEUE_SIZE );
+    for (uint8_t i = 0; i < _received_count; i++) {
+        _CHECK( _received[i][2] == KEYBOARD__a_A + i );
+        _CHECK( _received_frame[i] == start + 1 + i );
+    }
+
+    _CHECK( fake__error == NULL );
+}
+
+/**                                    functions/_test__send_report/description
+ * Check `usb__kb__send_report()`: that it doesn't wait while a bank is free,
+ * that it keeps its place behind queued reports, and that it gives up
+ */
+static void _test__send_report(void) {
+    _start(true, 0);
+    fake__setup( _OUT_HID, USB__HID__SET_IDLE, 0,
+                 USB___KB__INTERFACE, 0, NULL );
+
+    // straight to the hardware, without waiting, while there's a free bank
+    uint16_t start = fake__frame_number;
+    usb__kb__set_key(true, KEYBOARD__a_A);
+    _CHECK( usb__kb__send_report() == 0 );
+    usb__kb__set_key(true, KEYBOARD__b_B);
+    _CHECK( usb__kb__send_report() == 0 );
+    _CHECK( fake__frame_number == start );
+
+    // both banks full, and nobody polling: give up after a while
+    _CHECK( usb__kb__send_report() == 2 );
+    _CHECK( fake__frame_number - start >= 50 );
+
+    // behind the queue
+    _start(true, 1);
+    fake__setup( _OUT_HID, USB__HID__SET_IDLE, 0,
+                 USB___KB__INTERFACE, 0, NULL );
+    usb__kb__set_key(true, KEYBOARD__a_A);
+    usb__kb__queue_report();
+    usb__kb__set_key(true, KEYBOARD__b_B);
+    _CHECK( usb__kb__send_report() == 0 );
+    for (uint8_t i = 0; i < 4; i++)
+        fake__frame();
+    _CHECK( _received_count == 2 );
+    _CHECK( _received[0][2] == KEYBOARD__a_A && _received[0][3] == 0 );
+    _CHECK( _received[1][2] == KEYBOARD__a_A
+            && _received[1][3] == KEYBOARD__b_B );
+
+    _CHECK( fake__error == NULL );
+}
+
+/**                                        functions/_test__suspend/description
+ * Check suspend, resume, and remote wakeup
+ */
+static void _test__suspend(void) {
+    _start(true, 1);
+
+    fake__suspend();
+    _CHECK( usb__is_suspended() );
+    _CHECK( usb__kb__send_report() == 3 );
+    _CHECK( usb__wakeup() != 0 );  // not allowed by the host
+    _CHECK( fake__wakeups == 0 );
+    fake__resume();
+    _CHECK( !usb__is_suspended() );
+
+    fake__setup( _OUT_DEVICE, USB__SET_FEATURE,
+                 USB__FEATURE__DEVICE_REMOTE_WAKEUP, 0, 0, NULL );
+    _CHECK( usb__wakeup() != 0 );  // not suspended
+    fake__suspend();
+    _CHECK( usb__wakeup() == 0 );
+    _CHECK( fake__wakeups == 1 );
+    fake__resume();
+    _CHECK( !usb__is_suspended() && usb__is_configured() );
+
+    _CHECK( fake__error == NULL );
+}
+
+// ----------------------------------------------------------------------------
+
+int main(void) {
+    usb__init();
+    if (!fake__attached) {
+        printf("usb__init() did not initialize the hardware\n");
+        return 1;
+    }
+
+    _test__enumeration();
+    _test__features();
+    _test__hid();
+    _test__report_queue();
+    _test__send_report();
+    _test__suspend();
+
+    printf( "usb: %u checks, %u failures\n", _checks, _failures );
+    return (_failures > 255) ? 255 : _failures;
+}
@@ -33,6 +33,43 @@
     #error "OPT__DEBOUNCE_TIME not defined"
 #endif
 
+/**                               macros/OPT__SUSPEND_SCAN_INTERVAL/description
+ * The amount of time to wait between scans while the host is suspended, in
+ * milliseconds
+ *
+ * Notes:
+ * - While suspended we turn off the LEDs, and sleep between scans.  A longer
+ *   interval means more time asleep, at the cost of a slower response to the
+ *   keypress that wakes the host.  Keys pressed and released within a single
+ *   interval may be missed.
+ * - Must be at least `OPT__DEBOUNCE_TIME`, and (since it's compared against
+ *   an 8-bit timestamp) no more than 255.
+ */
+#ifndef OPT__SUSPEND_SCAN_INTERVAL
+    #error "OPT__SUSPEND_SCAN_INTERVAL not defined"
+#endif
+#if OPT__SUSPEND_SCAN_INTERVAL < OPT__DEBOUNCE_TIME \
+        || OPT__SUSPEND_SCAN_INTERVAL > 255
+    #error "OPT__SUSPEND_SCAN_INTERVAL out of range"
+#endif
+
+/**                               macros/OPT__USB__POLLING_INTERVAL/description
+ * See the documentation in the USB implementation
+ *
+ * Notes:
+ * - We send one report per scan, so the scan interval (which is at least
+ *   `OPT__DEBOUNCE_TIME` milliseconds) should be a whole number of polling
+ *   intervals.  That way each scan's report lines up with a poll, instead of
+ *   drifting against it and occasionally waiting an extra interval (or having
+ *   two reports land in the same one).
+ */
+#ifndef OPT__USB__POLLING_INTERVAL
+    #error "OPT__USB__POLLING_INTERVAL not defined"
+#endif
+#if OPT__DEBOUNCE_TIME % OPT__USB__POLLING_INTERVAL
+    #error "OPT__DEBOUNCE_TIME must be a multiple of OPT__USB__POLLING_INTERVAL"
+#endif
+
 // ----------------------------------------------------------------------------
 
 #define  main__is_pressed   is_pressed
@@ -69,6 +106,7 @@ int main(void) {
     static bool key_was_pressed;
 
     static uint8_t time_scan_started;
+    static bool    suspended;
 
     kb__init();  // initialize hardware (besides USB and timer)
 
@@ -90,9 +128,30 @@ int main(void) {
         is_pressed = was_pressed;
         was_pressed = temp;
 
-        // delay if necessary, then rescan
-        while( (uint8_t)(timer__get_milliseconds()-time_scan_started)
-               < OPT__DEBOUNCE_TIME );
+        // turn off the LEDs while the host is suspended, and restore the
+        // normal state when it resumes
+        if (usb__is_suspended() != suspended) {
+            suspended = !suspended;
+            if (suspended)
+                kb__led__all_off();
+            else
+                kb__led__state__ready();
+        }
+
+        // delay if necessary (sleeping, if suspended), then rescan
+        // - run events scheduled in milliseconds while we wait, so they're
+        //   on time regardless of how long scans take
+        if (suspended) {
+            while( (uint8_t)(timer__get_milliseconds()-time_scan_started)
+                   < OPT__SUSPEND_SCAN_INTERVAL ) {
+                kb__sleep();
+                timer___tick_milliseconds();
+            }
+        } else {
+            while( (uint8_t)(timer__get_milliseconds()-time_scan_started)
+                   < OPT__DEBOUNCE_TIME )
+                timer___tick_milliseconds();
+        }
         time_scan_started = timer__get_milliseconds();
         kb__update_matrix(*is_pressed);
 
@@ -102,8 +161,13 @@ int main(void) {
                 key_is_pressed = (*is_pressed)[row][col];
                 key_was_pressed = (*was_pressed)[row][col];
 
-                if (key_is_pressed != key_was_pressed)
+                if (key_is_pressed != key_was_pressed) {
+                    // a keypress while suspended should wake the host (if
+                    // it has allowed us to)
+                    if (key_is_pressed && suspended)
+                        usb__wakeup();
                     kb__layout__exec_key(key_is_pressed, row, col);
+                }
             }
         }
 
@@ -111,7 +175,7 @@ int main(void) {
 
         // note: only use the `kb__led__logical...` functions here, since the
         // meaning of the physical LEDs should be controlled by the layout
-        if (flags.update_leds) {
+        if (flags.update_leds && !suspended) {
             #define  read  usb__kb__read_led
             #define  on    kb__led__logical_on
             #define  off   kb__led__logical_off
@@ -126,6 +190,7 @@ int main(void) {
         }
 
         timer___tick_cycles();
+        timer___tick_milliseconds();
     }
 
     return 0;